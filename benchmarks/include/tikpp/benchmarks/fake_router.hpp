@@ -0,0 +1,330 @@
+#ifndef TIKPP_BENCHMARKS_FAKE_ROUTER_HPP
+#define TIKPP_BENCHMARKS_FAKE_ROUTER_HPP
+
+#include "tikpp/request.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tikpp::benchmarks {
+
+/*!
+ * \brief A minimal local RouterOS API server which accepts any login, and
+ *        answers every request with an empty `!done' (plus an optional
+ *        number of `!re' rows), either at once or after a service time.
+ *        Connections are either plain or SSL ones
+ */
+struct fake_router {
+    /*!
+     * \brief A function which is called for each received request, and
+     *        appends the encoded response sentences to the passed buffer
+     */
+    using responder = std::function<void(const std::vector<std::string> &,
+                                         const std::string &,
+                                         std::vector<std::uint8_t> &)>;
+
+    /*!
+     * \brief A function which gets the time a request takes to be answered,
+     *        given the number of requests of its session which are being
+     *        served (including itself). Requests are served concurrently
+     */
+    using service_time =
+        std::function<std::chrono::microseconds(std::size_t)>;
+
+    /*!
+     * \brief Starts the router
+     *
+     * \param [in] threads The number of threads which serve the connections
+     * \param [in] respond Appends the rows of each response
+     * \param [in] delay   Gets the service time of each request
+     * \param [in] tls     The TLS server context to serve SSL API connections
+     *                     with (\see tests::util::make_tls_server_context),
+     *                     or null to serve plain ones
+     */
+    explicit fake_router(
+        std::size_t                                threads = 1,
+        responder                                  respond = {},
+        service_time                               delay   = {},
+        std::shared_ptr<boost::asio::ssl::context> tls     = {})
+        : acceptor_ {io_, {boost::asio::ip::make_address("127.0.0.1"), 0}},
+          work_ {io_.get_executor()},
+          respond_ {std::move(respond)},
+          delay_ {std::move(delay)},
+          tls_ {std::move(tls)} {
+        accept();
+
+        for (std::size_t i {0}; i < threads; ++i) {
+            threads_.emplace_back([this] { io_.run(); });
+        }
+    }
+
+    fake_router(const fake_router &) = delete;
+    auto operator=(const fake_router &) -> fake_router & = delete;
+
+    ~fake_router() {
+        work_.reset();
+        io_.stop();
+
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    [[nodiscard]] inline auto port() const -> std::uint16_t {
+        return acceptor_.local_endpoint().port();
+    }
+
+  private:
+    /*
+     * A connection to the router, which decodes the received words a chunk
+     * at a time rather than by reading each of them, so that the router adds
+     * as little as possible to the measured times
+     */
+    template <typename Stream>
+    struct session : std::enable_shared_from_this<session<Stream>> {
+        template <typename... Arg>
+        session(const responder &   respond,
+                const service_time &delay,
+                Arg &&... args)
+            : sock_ {std::forward<Arg>(args)...},
+              respond_ {respond},
+              delay_ {delay} {
+            sock_.lowest_layer().set_option(
+                boost::asio::ip::tcp::no_delay {true});
+        }
+
+        inline void start() {
+            if constexpr (std::is_same_v<Stream,
+                                         boost::asio::ip::tcp::socket>) {
+                read_next_chunk();
+            } else {
+                sock_.async_handshake(
+                    boost::asio::ssl::stream_base::server,
+                    [self = this->shared_from_this()](const auto &err) {
+                        if (!err) {
+                            self->read_next_chunk();
+                        }
+                    });
+            }
+        }
+
+      private:
+        inline void read_next_chunk() {
+            sock_.async_read_some(
+                boost::asio::buffer(chunk_),
+                [self = this->shared_from_this()](const auto &err,
+                                                  auto        len) {
+                    if (err) {
+                        return;
+                    }
+
+                    self->received_.insert(self->received_.end(),
+                                           self->chunk_.begin(),
+                                           self->chunk_.begin() + len);
+                    self->on_received();
+                    self->read_next_chunk();
+                });
+        }
+
+        inline void on_received() {
+            std::size_t pos {0};
+
+            for (std::uint32_t len {0}; decode_length(pos, len);) {
+                if (len == 0) {
+                    ++pos;
+
+                    if (!words_.empty()) {
+                        on_request();
+                    }
+
+                    continue;
+                }
+
+                auto start = pos + length_size(received_[pos]);
+
+                if (received_.size() - start < len) {
+                    break;
+                }
+
+                words_.emplace_back(received_.begin() + start,
+                                    received_.begin() + start + len);
+                pos = start + len;
+            }
+
+            received_.erase(received_.begin(), received_.begin() + pos);
+        }
+
+        static inline auto length_size(std::uint8_t first) -> std::size_t {
+            if ((first & 0x80) == 0x00) {
+                return 1;
+            }
+
+            if ((first & 0xC0) == 0x80) {
+                return 2;
+            }
+
+            if ((first & 0xE0) == 0xC0) {
+                return 3;
+            }
+
+            return (first & 0xF0) == 0xE0 ? 4 : 5;
+        }
+
+        /*
+         * Decodes the length of the word at a position, if all of its bytes
+         * were received
+         */
+        inline auto decode_length(std::size_t pos, std::uint32_t &len) const
+            -> bool {
+            if (pos >= received_.size()) {
+                return false;
+            }
+
+            auto size = length_size(received_[pos]);
+
+            if (received_.size() - pos < size) {
+                return false;
+            }
+
+            static constexpr std::array<std::uint8_t, 5> masks {0x7F, 0x3F,
+                                                                0x1F, 0x0F,
+                                                                0x00};
+            len = received_[pos] & masks[size - 1];
+
+            for (std::size_t i {1}; i < size; ++i) {
+                len = (len << 8) | received_[pos + i];
+            }
+
+            return true;
+        }
+
+        inline void on_request() {
+            std::string tag {};
+
+            for (const auto &word : words_) {
+                if (word.rfind(".tag=", 0) == 0) {
+                    tag = word;
+                }
+            }
+
+            if (!delay_) {
+                answer(tag, pending_);
+                words_.clear();
+                write_pending();
+                return;
+            }
+
+            auto resp = std::make_shared<std::vector<std::uint8_t>>();
+            answer(tag, *resp);
+            words_.clear();
+
+            auto timer = std::make_shared<boost::asio::steady_timer>(
+                sock_.get_executor());
+            timer->expires_after(delay_(++serving_));
+            timer->async_wait([self = this->shared_from_this(), timer,
+                               resp](const auto &) {
+                --self->serving_;
+                self->pending_.insert(self->pending_.end(), resp->begin(),
+                                      resp->end());
+                self->write_pending();
+            });
+        }
+
+        inline void answer(const std::string &        tag,
+                           std::vector<std::uint8_t> &buf) {
+            if (respond_) {
+                respond_(words_, tag, buf);
+            }
+
+            tikpp::detail::encode_word("!done", buf);
+            tikpp::detail::encode_word(tag, buf);
+            tikpp::detail::encode_length(0, buf);
+        }
+
+        inline void write_pending() {
+            if (writing_ || pending_.empty()) {
+                return;
+            }
+
+            writing_ = true;
+            sending_.swap(pending_);
+            pending_.clear();
+
+            boost::asio::async_write(
+                sock_, boost::asio::buffer(sending_),
+                [self = this->shared_from_this()](const auto &err, auto) {
+                    self->writing_ = false;
+
+                    if (!err) {
+                        self->write_pending();
+                    }
+                });
+        }
+
+        Stream                         sock_;
+        const responder &              respond_;
+        const service_time &           delay_;
+        std::size_t                    serving_ {0};
+        std::array<std::uint8_t, 4096> chunk_ {};
+        std::vector<std::uint8_t>      received_;
+        std::vector<std::string>       words_;
+        std::vector<std::uint8_t>      pending_, sending_;
+        bool                           writing_ {false};
+    };
+
+    using ssl_stream = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
+    inline void accept() {
+        acceptor_.async_accept(
+            boost::asio::make_strand(io_),
+            [this](const auto &err, boost::asio::ip::tcp::socket sock) {
+                if (err) {
+                    return;
+                }
+
+                if (tls_ != nullptr) {
+                    std::make_shared<session<ssl_stream>>(
+                        respond_, delay_, std::move(sock), *tls_)
+                        ->start();
+                } else {
+                    std::make_shared<session<boost::asio::ip::tcp::socket>>(
+                        respond_, delay_, std::move(sock))
+                        ->start();
+                }
+
+                accept();
+            });
+    }
+
+    boost::asio::io_context        io_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+                             work_;
+    responder                respond_;
+    service_time             delay_;
+
+    std::shared_ptr<boost::asio::ssl::context> tls_;
+    std::vector<std::thread>                   threads_;
+};
+
+} // namespace tikpp::benchmarks
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef TIKPP_BENCHMARKS_INSTANT_STREAM_HPP
+#define TIKPP_BENCHMARKS_INSTANT_STREAM_HPP
+
+#include "tikpp/detail/async_result.hpp"
+#include "tikpp/io_context.hpp"
+#include "tikpp/request.hpp"
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tikpp::benchmarks {
+
+/*!
+ * \brief An in-memory stream which answers every written request with an
+ *        empty `!done' instantly, so that benchmarks measure the client side
+ *        overhead only. Only supports words shorter than 128 bytes
+ */
+struct instant_stream final {
+    using executor_type = tikpp::io_context::executor_type;
+    using work_guard    = boost::asio::executor_work_guard<executor_type>;
+
+    explicit instant_stream(tikpp::io_context &io) : io_ {io} {
+    }
+
+    inline auto get_executor() -> executor_type {
+        return io_.get_executor();
+    }
+
+    template <typename CompletionToken>
+    inline decltype(auto)
+    async_connect([[maybe_unused]] const boost::asio::ip::tcp::endpoint &ep,
+                  CompletionToken &&token) {
+        GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
+                                    token, handler, result);
+
+        open_ = true;
+
+        auto ex =
+            boost::asio::get_associated_executor(handler, get_executor());
+        boost::asio::post(ex, [handler {std::move(handler)}]() mutable {
+            handler(boost::system::error_code {});
+        });
+
+        return result.get();
+    }
+
+    inline void close() {
+        open_ = false;
+
+        if (pending_read_) {
+            boost::asio::post(pending_ex_, [cb = std::move(pending_read_)]() {
+                cb(boost::asio::error::operation_aborted, 0);
+            });
+            pending_read_ = nullptr;
+            pending_work_.reset();
+        }
+    }
+
+    [[nodiscard]] inline auto is_open() const noexcept -> bool {
+        return open_;
+    }
+
+    template <typename CompletionToken>
+    inline void async_read_some(boost::asio::mutable_buffer buf,
+                                CompletionToken &&          token) {
+        GENERATE_COMPLETION_HANDLER(
+            void(const boost::system::error_code &, std::size_t), token,
+            handler, result);
+
+        auto shared = std::make_shared<handler_type>(std::move(handler));
+
+        pending_ex_ =
+            boost::asio::get_associated_executor(*shared, get_executor());
+        pending_buf_  = buf;
+        pending_work_ = std::make_shared<work_guard>(get_executor());
+        pending_read_ = [shared](const auto &err, auto rx) {
+            (*shared)(err, rx);
+        };
+
+        complete_read();
+        return result.get();
+    }
+
+    template <typename CompletionToken>
+    inline void async_write_some(boost::asio::const_buffer buf,
+                                 CompletionToken &&        token) {
+        GENERATE_COMPLETION_HANDLER(
+            void(const boost::system::error_code &, std::size_t), token,
+            handler, result);
+
+        const auto *data = static_cast<const std::uint8_t *>(buf.data());
+        written_.insert(written_.end(), data, data + buf.size());
+        answer();
+
+        auto ex =
+            boost::asio::get_associated_executor(handler, get_executor());
+        boost::asio::post(ex, [handler {std::move(handler)},
+                               size = buf.size()]() mutable {
+            handler(boost::system::error_code {}, size);
+        });
+
+        complete_read();
+        return result.get();
+    }
+
+  private:
+    // Parses the complete written sentences, and queues their answers
+    inline void answer() {
+        std::size_t pos {0}, start {0};
+        std::string tag {};
+
+        while (pos < written_.size()) {
+            auto len = written_[pos];
+
+            if (len == 0) {
+                tikpp::detail::encode_word("!done", readable_);
+                tikpp::detail::encode_word(tag, readable_);
+                tikpp::detail::encode_length(0, readable_);
+
+                start = ++pos;
+                tag.clear();
+                continue;
+            }
+
+            if (pos + 1 + len > written_.size()) {
+                break;
+            }
+
+            std::string word(reinterpret_cast<const char *>(&written_[pos + 1]),
+                             len);
+
+            if (word.rfind(".tag=", 0) == 0) {
+                tag = std::move(word);
+            }
+
+            pos += 1 + len;
+        }
+
+        written_.erase(written_.begin(), written_.begin() + start);
+    }
+
+    inline void complete_read() {
+        // Zero-sized reads complete immediately, as they do on sockets
+        if (!pending_read_ ||
+            (read_offset_ == readable_.size() && pending_buf_.size() > 0)) {
+            return;
+        }
+
+        auto rx = std::min(pending_buf_.size(),
+                           readable_.size() - read_offset_);
+        std::memcpy(pending_buf_.data(), readable_.data() + read_offset_, rx);
+        read_offset_ += rx;
+
+        if (read_offset_ == readable_.size()) {
+            readable_.clear();
+            read_offset_ = 0;
+        }
+
+        boost::asio::post(pending_ex_, [cb = std::move(pending_read_), rx]() {
+            cb(boost::system::error_code {}, rx);
+        });
+        pending_read_ = nullptr;
+        pending_work_.reset();
+    }
+
+    tikpp::io_context &io_;
+    bool               open_ {false};
+
+    std::vector<std::uint8_t> written_, readable_;
+    std::size_t               read_offset_ {0};
+
+    // Keeps the IO context running while a read is pending, like a socket
+    boost::asio::mutable_buffer  pending_buf_;
+    boost::asio::any_io_executor pending_ex_;
+    std::shared_ptr<work_guard>  pending_work_;
+    std::function<void(const boost::system::error_code &, std::size_t)>
+        pending_read_;
+};
+
+} // namespace tikpp::benchmarks
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef TIKPP_BENCHMARKS_UTIL_HPP
+#define TIKPP_BENCHMARKS_UTIL_HPP
+
+#include "tikpp/detail/convert.hpp"
+#include "tikpp/request.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace tikpp::benchmarks::util {
+
+/*!
+ * \brief Encodes the passed words into a single API sentence
+ */
+template <typename... Arg>
+inline auto make_sentence(Arg &&... args) -> std::vector<std::uint8_t> {
+    std::vector<std::uint8_t> buf {};
+
+    (tikpp::detail::encode_word(
+         tikpp::detail::convert_back(std::forward<Arg>(args)), buf),
+     ...);
+
+    tikpp::detail::encode_length(0, buf);
+    return buf;
+}
+
+/*!
+ * \brief Gets the peak resident set size of the calling process in KiB
+ */
+inline auto peak_rss_kb() -> long {
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*!
+ * \brief Runs a function in a forked child process, so that each run has its
+ *        own peak RSS measurement
+ *
+ * \return Whether the child exited successfully or not
+ */
+template <typename Function>
+inline auto run_isolated(Function &&fn) -> bool {
+    std::fflush(stdout);
+
+    if (auto pid = fork(); pid == 0) {
+        fn();
+        std::fflush(stdout);
+        std::_Exit(EXIT_SUCCESS);
+    } else if (pid > 0) {
+        int status {};
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    }
+
+    return false;
+}
+
+/*!
+ * \brief Gets the CPU time (user and system) used by the calling thread in
+ *        milliseconds
+ */
+inline auto thread_cpu_ms() -> double {
+    rusage usage {};
+    getrusage(RUSAGE_THREAD, &usage);
+
+    auto ms = [](const timeval &tv) {
+        return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+    };
+
+    return ms(usage.ru_utime) + ms(usage.ru_stime);
+}
+
+/*!
+ * \brief A simple wall-clock stopwatch
+ */
+struct stopwatch {
+    using clock = std::chrono::steady_clock;
+
+    [[nodiscard]] inline auto elapsed_ms() const -> double {
+        return std::chrono::duration<double, std::milli>(clock::now() - start_)
+            .count();
+    }
+
+  private:
+    clock::time_point start_ {clock::now()};
+};
+
+} // namespace tikpp::benchmarks::util
+
+#endif
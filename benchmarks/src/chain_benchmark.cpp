@@ -0,0 +1,112 @@
+#include "tikpp/api.hpp"
+#include "tikpp/benchmarks/fake_router.hpp"
+#include "tikpp/benchmarks/instant_stream.hpp"
+#include "tikpp/benchmarks/util.hpp"
+#include "tikpp/io_context.hpp"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Sends chains of dependent requests, where each request is only sent from
+ * the completion handler of the previous one (as chained repository
+ * operations do), and reports the median latency of a whole chain and of each
+ * request in it. Chains are run against an in-memory stream which answers
+ * instantly (which isolates the client side overhead), and against a local
+ * fake router over TCP.
+ *
+ * Usage: chain_benchmark [length] [runs]
+ */
+
+namespace {
+
+struct error_handler {
+    void operator()(const boost::system::error_code &err) const {
+        fmt::print(stderr, "[!] An error occured: {}\n", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+};
+
+template <typename AsyncStream>
+void run(const char *  name,
+         std::uint16_t port,
+         std::size_t   length,
+         std::size_t   runs) {
+    tikpp::io_context io {1};
+
+    auto api    = tikpp::make_api<AsyncStream>(io, error_handler {});
+    bool opened = false;
+
+    api->async_open("127.0.0.1", port, "admin", "",
+                    [&opened](const auto &err) {
+                        if (err) {
+                            error_handler {}(err);
+                        }
+
+                        opened = true;
+                    });
+
+    while (!opened) {
+        io.run_one();
+    }
+
+    std::vector<double> results {};
+
+    for (std::size_t i {0}; i < runs; ++i) {
+        std::size_t completed {0};
+
+        std::function<void()> send = [&]() {
+            api->async_send(api->make_request("/system/identity/print"),
+                            [&](const auto &err, auto &&) {
+                                if (err) {
+                                    error_handler {}(err);
+                                }
+
+                                if (++completed < length) {
+                                    send();
+                                }
+
+                                return false;
+                            });
+        };
+
+        tikpp::benchmarks::util::stopwatch sw {};
+
+        send();
+
+        while (completed < length) {
+            io.run_one();
+        }
+
+        results.push_back(sw.elapsed_ms());
+    }
+
+    std::sort(results.begin(), results.end());
+    auto median = results[results.size() / 2];
+
+    fmt::print("{:<10} {:>12.3f} {:>14.2f}\n", name, median,
+               median * 1000 / length);
+
+    api->close();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t length = argc > 1 ? std::stoul(argv[1]) : 1000;
+    std::size_t runs   = argc > 2 ? std::stoul(argv[2]) : 21;
+
+    tikpp::benchmarks::fake_router router {1};
+
+    fmt::print("median of {} chains of {} dependent requests\n", runs, length);
+    fmt::print("{:<10} {:>12} {:>14}\n", "stream", "chain (ms)",
+               "request (us)");
+
+    run<tikpp::benchmarks::instant_stream>("in-memory", 0, length, runs);
+    run<boost::asio::ip::tcp::socket>("tcp", router.port(), length, runs);
+}
@@ -0,0 +1,183 @@
+#include "tikpp/api.hpp"
+#include "tikpp/benchmarks/fake_router.hpp"
+#include "tikpp/benchmarks/util.hpp"
+#include "tikpp/io_context.hpp"
+#include "tikpp/read_budget.hpp"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/*
+ * Runs two connections on a single threaded IO context, to a local fake
+ * router: one reads a large `getall' result whose rows take a little work
+ * each to handle, while the other sends small requests one after another,
+ * and reports how long the large read took, the latency of the small
+ * requests sent meanwhile, and the longest read turn of the large read,
+ * without a read budget and with the default one.
+ *
+ * Usage: fairness_benchmark [rows] [row_work_us]
+ */
+
+namespace {
+
+struct error_handler {
+    void operator()(const boost::system::error_code &err) const {
+        fmt::print(stderr, "[!] An error occured: {}\n", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+};
+
+using clock = std::chrono::steady_clock;
+
+template <typename Api>
+void open(tikpp::io_context &io, Api &api, std::uint16_t port) {
+    bool opened = false;
+
+    api->async_open("127.0.0.1", port, "admin", "",
+                    [&opened](const auto &err) {
+                        if (err) {
+                            error_handler {}(err);
+                        }
+
+                        opened = true;
+                    });
+
+    while (!opened) {
+        io.run_one();
+    }
+}
+
+/*
+ * Stands for the work which an application does with each row, e.g. making
+ * a model of it
+ */
+void spin(std::chrono::microseconds duration) {
+    for (auto until = clock::now() + duration; clock::now() < until;) {
+    }
+}
+
+template <typename Api>
+void send_small(Api &api, std::vector<double> &latencies, const bool &done) {
+    api->async_send(api->make_request("/system/identity/print"),
+                    [&api, &latencies, &done,
+                     start = clock::now()](const auto &err, auto &&) {
+                        if (err) {
+                            error_handler {}(err);
+                        }
+
+                        latencies.push_back(
+                            std::chrono::duration<double, std::milli>(
+                                clock::now() - start)
+                                .count());
+
+                        if (!done) {
+                            send_small(api, latencies, done);
+                        }
+
+                        return false;
+                    });
+}
+
+void run(const char *              name,
+         std::uint16_t             port,
+         std::chrono::microseconds row_work,
+         tikpp::read_budget        budget) {
+    tikpp::io_context io {1};
+
+    auto large = tikpp::make_api(io, error_handler {});
+    auto small = tikpp::make_api(io, error_handler {});
+    open(io, large, port);
+    open(io, small, port);
+
+    large->read_budget(budget);
+
+    std::vector<double> latencies {};
+    bool                done {false};
+
+    tikpp::benchmarks::util::stopwatch sw {};
+
+    large->async_send(large->make_request("/ip/arp/getall"),
+                      [&done, row_work](const auto &err, auto &&resp) {
+                          if (err) {
+                              error_handler {}(err);
+                          }
+
+                          if (resp.type() == tikpp::response_type::normal) {
+                              done = true;
+                              return false;
+                          }
+
+                          spin(row_work);
+                          return true;
+                      });
+
+    send_small(small, latencies, done);
+
+    while (!done) {
+        io.run_one();
+    }
+
+    auto elapsed = sw.elapsed_ms();
+
+    // Lets the last small request complete
+    for (auto count = latencies.size(); latencies.size() == count;) {
+        io.run_one();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    const auto &stats = large->read_stats();
+
+    fmt::print("{:<10} {:>10.0f} {:>8} {:>9.2f} {:>9.2f} {:>9.2f} {:>10} "
+               "{:>8}\n",
+               name, elapsed, latencies.size(),
+               latencies[latencies.size() / 2],
+               latencies[latencies.size() * 99 / 100], latencies.back(),
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   stats.longest_turn())
+                   .count(),
+               stats.yields());
+
+    large->close();
+    small->close();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t rows        = argc > 1 ? std::stoul(argv[1]) : 200000;
+    std::size_t row_work_us = argc > 2 ? std::stoul(argv[2]) : 2;
+
+    tikpp::benchmarks::fake_router router {
+        1, [rows](const auto &words, const auto &tag, auto &buf) {
+            if (words.front() != "/ip/arp/getall") {
+                return;
+            }
+
+            for (std::size_t i {0}; i < rows; ++i) {
+                tikpp::detail::encode_word("!re", buf);
+                tikpp::detail::encode_word(fmt::format("=.id=*{:X}", i), buf);
+                tikpp::detail::encode_word("=address=10.0.0.1", buf);
+                tikpp::detail::encode_word(
+                    "=mac-address=00:11:22:33:44:55", buf);
+                tikpp::detail::encode_word("=interface=bridge", buf);
+                tikpp::detail::encode_word(tag, buf);
+                tikpp::detail::encode_length(0, buf);
+            }
+        }};
+
+    fmt::print("{} rows, {} us of work per row\n", rows, row_work_us);
+    fmt::print("{:<10} {:>10} {:>8} {:>9} {:>9} {:>9} {:>10} {:>8}\n",
+               "budget", "large (ms)", "small", "p50 (ms)", "p99 (ms)",
+               "max (ms)", "turn (us)", "yields");
+
+    std::chrono::microseconds row_work {row_work_us};
+
+    run("unlimited", router.port(), row_work, {0, 0});
+    run("default", router.port(), row_work, {});
+}
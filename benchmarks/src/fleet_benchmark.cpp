@@ -0,0 +1,136 @@
+#include "tikpp/benchmarks/fake_router.hpp"
+#include "tikpp/benchmarks/util.hpp"
+#include "tikpp/fleet.hpp"
+
+#include "fmt/format.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Opens a fleet of connections to a local fake router, then keeps a fixed
+ * number of requests in flight on each connection for a fixed duration, once
+ * for each shard count up to the number of cores. The requests/second should
+ * scale with the shard count, as long as the fake router (which runs on the
+ * same machine, with one thread per core) is not the bottleneck.
+ *
+ * Usage: fleet_benchmark [routers] [depth] [seconds]
+ */
+
+namespace {
+
+struct worker {
+    using api_ptr = tikpp::fleet::api_ptr;
+
+    inline void send() const {
+        if (stopped->load()) {
+            return;
+        }
+
+        api->async_send(api->make_request("/system/identity/print"),
+                        [self = *this](const auto &err, auto &&) {
+                            if (!err) {
+                                self.completed->fetch_add(1);
+                                self.send();
+                            }
+
+                            return false;
+                        });
+    }
+
+    api_ptr                                   api;
+    std::shared_ptr<std::atomic_bool>         stopped;
+    std::shared_ptr<std::atomic<std::size_t>> completed;
+};
+
+auto run(std::size_t shards,
+         std::size_t routers,
+         std::size_t depth,
+         double      seconds,
+         std::uint16_t port) -> double {
+    tikpp::fleet fleet {shards};
+
+    std::mutex              mutex {};
+    std::condition_variable cv {};
+    std::size_t             opened {0}, failed {0};
+
+    for (std::size_t i {0}; i < routers; ++i) {
+        fleet.async_open(fmt::format("router-{}", i), "127.0.0.1", port,
+                         "admin", "", [&](const auto &err) {
+                             std::lock_guard<std::mutex> lock {mutex};
+                             ++opened;
+                             failed += err ? 1 : 0;
+                             cv.notify_one();
+                         });
+    }
+
+    fleet.start();
+
+    {
+        std::unique_lock<std::mutex> lock {mutex};
+        cv.wait(lock, [&] { return opened == routers; });
+    }
+
+    if (failed > 0) {
+        fmt::print(stderr, "[!] {} connections failed\n", failed);
+        std::exit(EXIT_FAILURE);
+    }
+
+    auto stopped   = std::make_shared<std::atomic_bool>(false);
+    auto completed = std::make_shared<std::atomic<std::size_t>>(0);
+
+    tikpp::benchmarks::util::stopwatch sw {};
+
+    for (std::size_t i {0}; i < routers; ++i) {
+        worker w {fleet.get(fmt::format("router-{}", i)), stopped, completed};
+
+        for (std::size_t j {0}; j < depth; ++j) {
+            w.send();
+        }
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+
+    auto count   = completed->load();
+    auto elapsed = sw.elapsed_ms();
+
+    stopped->store(true);
+    fleet.stop();
+
+    return count / (elapsed / 1000.0);
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t routers = argc > 1 ? std::stoul(argv[1]) : 256;
+    std::size_t depth   = argc > 2 ? std::stoul(argv[2]) : 8;
+    double      seconds = argc > 3 ? std::stod(argv[3]) : 2.0;
+
+    auto cores = std::max(std::thread::hardware_concurrency(), 1U);
+
+    tikpp::benchmarks::fake_router router {cores};
+
+    fmt::print("{} routers, {} requests in flight per router, {} core(s)\n",
+               routers, depth, cores);
+    fmt::print("{:>8} {:>14} {:>9}\n", "shards", "requests/s", "speedup");
+
+    double base {0};
+
+    for (std::size_t shards {1}; shards <= cores; shards *= 2) {
+        auto rate = run(shards, routers, depth, seconds, router.port());
+
+        if (shards == 1) {
+            base = rate;
+        }
+
+        fmt::print("{:>8} {:>14.0f} {:>8.2f}x\n", shards, rate, rate / base);
+    }
+}
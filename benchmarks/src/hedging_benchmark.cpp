@@ -0,0 +1,142 @@
+#include "tikpp/benchmarks/fake_router.hpp"
+#include "tikpp/benchmarks/util.hpp"
+#include "tikpp/connection_pool.hpp"
+#include "tikpp/hedging_policy.hpp"
+#include "tikpp/io_context.hpp"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Keeps a fixed number of reads in flight over a pool of sessions to a local
+ * fake router, which answers most requests in a base service time, but
+ * stalls on a small share of them (as a router does when a session is stuck
+ * behind a slow command), and reports the latency percentiles of the reads
+ * (from being sent to completing), without and with hedging, along with how
+ * many reads were hedged, and how many of the hedges responded first.
+ *
+ * Usage: hedging_benchmark [requests] [depth] [slow_percent] [slow_ms]
+ */
+
+namespace {
+
+struct error_handler {
+    void operator()(const boost::system::error_code &err) const {
+        fmt::print(stderr, "[!] An error occured: {}\n", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+};
+
+using clock = std::chrono::steady_clock;
+
+template <typename Pool>
+void send(Pool &pool, std::vector<double> &latencies, std::size_t &sent) {
+    ++sent;
+    pool->async_send(pool->make_request("/interface/print"),
+                     [&pool, &latencies, &sent,
+                      start = clock::now()](const auto &err, auto &&) {
+                         if (err) {
+                             error_handler {}(err);
+                         }
+
+                         latencies.push_back(
+                             std::chrono::duration<double, std::milli>(
+                                 clock::now() - start)
+                                 .count());
+
+                         if (sent < latencies.capacity()) {
+                             send(pool, latencies, sent);
+                         }
+
+                         return false;
+                     });
+}
+
+void run(const char *                         name,
+         std::uint16_t                        port,
+         std::size_t                          requests,
+         std::size_t                          depth,
+         std::optional<tikpp::hedging_policy> policy) {
+    tikpp::io_context io {1};
+
+    auto pool = tikpp::make_connection_pool(io, 3, 0, error_handler {});
+    pool->hedging(policy);
+
+    bool opened = false;
+    pool->async_open("127.0.0.1", port, "admin", "",
+                     [&opened](const auto &err) {
+                         if (err) {
+                             error_handler {}(err);
+                         }
+
+                         opened = true;
+                     });
+
+    while (!opened) {
+        io.run_one();
+    }
+
+    std::vector<double> latencies {};
+    latencies.reserve(requests);
+    std::size_t sent {0};
+
+    for (std::size_t i {0}; i < depth; ++i) {
+        send(pool, latencies, sent);
+    }
+
+    while (latencies.size() < requests) {
+        io.run_one();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto at = [&latencies](double q) {
+        return latencies[static_cast<std::size_t>(
+            q * static_cast<double>(latencies.size() - 1))];
+    };
+
+    auto stats = pool->hedging_stats();
+
+    fmt::print("{:<10} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f} {:>8} {:>6}\n",
+               name, at(0.5), at(0.95), at(0.99), at(0.999), stats.hedged,
+               stats.won);
+
+    pool->close();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t requests     = argc > 1 ? std::stoul(argv[1]) : 5000;
+    std::size_t depth        = argc > 2 ? std::stoul(argv[2]) : 8;
+    std::size_t slow_percent = argc > 3 ? std::stoul(argv[3]) : 2;
+    std::size_t slow_ms      = argc > 4 ? std::stoul(argv[4]) : 20;
+
+    auto rng = std::make_shared<std::minstd_rand>(42);
+
+    tikpp::benchmarks::fake_router router {
+        1, {}, [rng, slow_percent, slow_ms](std::size_t) {
+            std::uniform_int_distribution<std::size_t> dist {0, 99};
+
+            return dist(*rng) < slow_percent
+                       ? std::chrono::microseconds {slow_ms * 1000}
+                       : std::chrono::microseconds {500};
+        }};
+
+    fmt::print("{} reads, {} in flight, {}% of them taking {} ms\n", requests,
+               depth, slow_percent, slow_ms);
+    fmt::print("{:<10} {:>9} {:>9} {:>9} {:>9} {:>8} {:>6}\n", "mode",
+               "p50 (ms)", "p95 (ms)", "p99 (ms)", "p999 (ms)", "hedged",
+               "won");
+
+    run("plain", router.port(), requests, depth, std::nullopt);
+    run("hedged", router.port(), requests, depth, tikpp::hedging_policy {});
+}
@@ -0,0 +1,145 @@
+#include "tikpp/api.hpp"
+#include "tikpp/benchmarks/fake_router.hpp"
+#include "tikpp/benchmarks/util.hpp"
+#include "tikpp/io_context.hpp"
+#include "tikpp/request.hpp"
+
+#include "fmt/format.h"
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Queues a bulk job of independent requests on a connection to a local fake
+ * router, and meanwhile sends an interactive request every millisecond, then
+ * reports the median and the 99th percentile latency of the interactive
+ * requests, for the priority classes which the bulk and the interactive
+ * requests are sent with.
+ *
+ * Priority classes only reorder the requests which are still queued on the
+ * client side, so the connection keeps a bounded in-flight window (without
+ * one, the bulk job is written to the socket buffers at once).
+ *
+ * Usage: priority_benchmark [bulk] [interactive] [window]
+ */
+
+namespace {
+
+struct error_handler {
+    void operator()(const boost::system::error_code &err) const {
+        fmt::print(stderr, "[!] An error occured: {}\n", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+};
+
+void run(const char *            name,
+         std::uint16_t           port,
+         std::size_t             bulk,
+         std::size_t             interactive,
+         std::size_t             window,
+         tikpp::request_priority bulk_priority,
+         tikpp::request_priority interactive_priority) {
+    tikpp::io_context io {1};
+
+    auto api    = tikpp::make_api(io, error_handler {});
+    bool opened = false;
+
+    api->async_open("127.0.0.1", port, "admin", "",
+                    [&opened](const auto &err) {
+                        if (err) {
+                            error_handler {}(err);
+                        }
+
+                        opened = true;
+                    });
+
+    while (!opened) {
+        io.run_one();
+    }
+
+    api->max_in_flight(window);
+
+    using clock = std::chrono::steady_clock;
+
+    std::size_t         bulk_completed {0};
+    std::vector<double> latencies {};
+
+    for (std::size_t i {0}; i < bulk; ++i) {
+        api->async_send(api->make_request("/interface/set"), bulk_priority,
+                        [&bulk_completed](const auto &err, auto &&) {
+                            if (err) {
+                                error_handler {}(err);
+                            }
+
+                            ++bulk_completed;
+                            return false;
+                        });
+    }
+
+    boost::asio::steady_timer timer {io};
+    std::size_t               sent {0};
+
+    std::function<void()> send = [&]() {
+        api->async_send(
+            api->make_request("/system/resource/print"), interactive_priority,
+            [&latencies, start = clock::now()](const auto &err, auto &&) {
+                if (err) {
+                    error_handler {}(err);
+                }
+
+                latencies.push_back(std::chrono::duration<double, std::milli>(
+                                        clock::now() - start)
+                                        .count());
+                return false;
+            });
+
+        if (++sent < interactive) {
+            timer.expires_after(std::chrono::milliseconds {1});
+            timer.async_wait([&send](const auto &) { send(); });
+        }
+    };
+
+    send();
+
+    while (latencies.size() < interactive || bulk_completed < bulk) {
+        io.run_one();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    fmt::print("{:<18} {:>10.3f} {:>10.3f}\n", name,
+               latencies[latencies.size() / 2],
+               latencies[latencies.size() * 99 / 100]);
+
+    api->close();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t bulk        = argc > 1 ? std::stoul(argv[1]) : 20000;
+    std::size_t interactive = argc > 2 ? std::stoul(argv[2]) : 100;
+    std::size_t window      = argc > 3 ? std::stoul(argv[3]) : 32;
+
+    tikpp::benchmarks::fake_router router {1};
+
+    fmt::print("{} interactive requests during a bulk job of {} requests, "
+               "{} requests in flight\n",
+               interactive, bulk, window);
+    fmt::print("{:<18} {:>10} {:>10}\n", "bulk/interactive", "p50 (ms)",
+               "p99 (ms)");
+
+    using tikpp::request_priority;
+
+    run("normal/normal", router.port(), bulk, interactive, window,
+        request_priority::normal, request_priority::normal);
+    run("bulk/normal", router.port(), bulk, interactive, window,
+        request_priority::bulk, request_priority::normal);
+    run("bulk/high", router.port(), bulk, interactive, window,
+        request_priority::bulk, request_priority::high);
+}
@@ -0,0 +1,168 @@
+#include "tikpp/detail/ssl_wrapper.hpp"
+#include "tikpp/io_context.hpp"
+#include "tikpp/ssl_context.hpp"
+#include "tikpp/tests/util/tls.hpp"
+#include "tikpp/tls_session_cache.hpp"
+
+#include "fmt/format.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/ssl/stream.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+/*
+ * Opens SSL connections to a local TLS server one after another, the way a
+ * connection reconnects after a failover, and reports how many handshakes
+ * per second are done, and how many of them resumed a session, when:
+ *  - each connection creates its own SSL context, without session
+ *    resumption (as every connection used to)
+ *  - the connections share an SSL context, without session resumption
+ *  - the connections share an SSL context and a TLS session cache
+ *
+ * The server uses a 2048-bit RSA certificate, and runs on the same thread,
+ * so the reported rate includes the handshake work of both sides.
+ *
+ * Usage: tls_handshake_benchmark [connections]
+ */
+
+namespace {
+
+/*
+ * A TLS server, which writes a byte to each accepted connection after the
+ * handshake (so the client also reads the session tickets which follow it)
+ */
+struct tls_server {
+    explicit tls_server(tikpp::io_context &io)
+        : ctx_ {tikpp::tests::util::make_tls_server_context()},
+          acceptor_ {io, {boost::asio::ip::make_address("127.0.0.1"), 0}} {
+        accept();
+    }
+
+    [[nodiscard]] inline auto port() const -> std::uint16_t {
+        return acceptor_.local_endpoint().port();
+    }
+
+  private:
+    using stream_type =
+        boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
+    void accept() {
+        acceptor_.async_accept([this](const auto &               err,
+                                      boost::asio::ip::tcp::socket sock) {
+            if (err) {
+                return;
+            }
+
+            sock.set_option(boost::asio::ip::tcp::no_delay {true});
+
+            auto stream =
+                std::make_shared<stream_type>(std::move(sock), *ctx_);
+            stream->async_handshake(
+                boost::asio::ssl::stream_base::server,
+                [stream](const auto &err) {
+                    if (err) {
+                        return;
+                    }
+
+                    static const std::array<char, 1> byte {'x'};
+                    stream->async_write_some(
+                        boost::asio::buffer(byte),
+                        [stream](const auto &, auto) { drain(stream); });
+                });
+
+            accept();
+        });
+    }
+
+    static void drain(const std::shared_ptr<stream_type> &stream) {
+        static std::array<char, 64> buf {};
+
+        stream->async_read_some(
+            boost::asio::buffer(buf), [stream](const auto &err, auto) {
+                if (!err) {
+                    drain(stream);
+                }
+            });
+    }
+
+    std::shared_ptr<boost::asio::ssl::context> ctx_;
+    boost::asio::ip::tcp::acceptor             acceptor_;
+};
+
+using wrapper =
+    tikpp::detail::ssl_wrapper<boost::asio::ip::tcp::socket, false>;
+
+void run(const char *        name,
+         tikpp::io_context & io,
+         std::uint16_t       port,
+         std::size_t         connections,
+         bool                shared_context,
+         bool                resumption) {
+    using clock = std::chrono::steady_clock;
+
+    wrapper sock {io};
+    sock.session_cache(resumption ? tikpp::make_tls_session_cache()
+                                  : nullptr);
+
+    std::size_t resumed {0};
+    auto        start = clock::now();
+
+    for (std::size_t i {0}; i < connections; ++i) {
+        if (!shared_context) {
+            sock.context(tikpp::make_ssl_context());
+        }
+
+        bool done {false};
+        sock.async_connect(
+            {boost::asio::ip::make_address("127.0.0.1"), port},
+            [&](const boost::system::error_code &err, auto &&...) {
+                if (err) {
+                    fmt::print(stderr, "[!] Could not connect: {}\n",
+                               err.message());
+                    std::exit(EXIT_FAILURE);
+                }
+
+                resumed += sock.session_reused() ? 1 : 0;
+
+                static std::array<char, 1> byte {};
+                sock.async_read_some(boost::asio::buffer(byte),
+                                     [&done](const auto &, auto) {
+                                         done = true;
+                                     });
+            });
+
+        while (!done) {
+            io.run_one();
+        }
+
+        sock.close();
+    }
+
+    auto elapsed = std::chrono::duration<double>(clock::now() - start);
+
+    fmt::print("{:<26} {:>12.1f} {:>10}\n", name,
+               connections / elapsed.count(), resumed);
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t connections = argc > 1 ? std::stoul(argv[1]) : 500;
+
+    tikpp::io_context io {1};
+    tls_server        server {io};
+
+    fmt::print("{} sequential connections\n", connections);
+    fmt::print("{:<26} {:>12} {:>10}\n", "mode", "handshakes/s", "resumed");
+
+    run("context per connection", io, server.port(), connections, false,
+        false);
+    run("shared context", io, server.port(), connections, true, false);
+    run("shared context + sessions", io, server.port(), connections, true,
+        true);
+}
@@ -0,0 +1,141 @@
+#include "tikpp/api.hpp"
+#include "tikpp/benchmarks/util.hpp"
+#include "tikpp/data/aggregates.hpp"
+#include "tikpp/data/repository.hpp"
+#include "tikpp/io_context.hpp"
+#include "tikpp/models/ip/hotspot/host.hpp"
+#include "tikpp/tests/fakes/socket.hpp"
+
+#include "fmt/format.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*
+ * Streams a fake `/ip/hotspot/host' table of different sizes and selects the
+ * top 50 hosts by `bytes-out', once with a bounded top-K aggregate and once by
+ * loading the whole table. Each run is done in a separate process, so the
+ * reported peak RSS of the top-K runs should stay flat as the table grows.
+ */
+
+namespace {
+
+using host_type = tikpp::models::ip::hotspot::host;
+
+constexpr auto top_count = 50;
+
+/*!
+ * \brief Aborts the run (i.e. its process) if the table was not read whole,
+ *        so that no partial result is reported
+ */
+void check(const boost::system::error_code &err) {
+    if (err) {
+        fmt::print(stderr, "[!] Failed to read the table: {}\n",
+                   err.message());
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+void feed_rows(tikpp::tests::fakes::socket &sock, std::size_t rows) {
+    for (std::size_t i {0}; i < rows; ++i) {
+        auto buf = tikpp::benchmarks::util::make_sentence(
+            "!re", fmt::format("=.id=*{:X}", i),
+            fmt::format("=mac-address=00:11:22:{:02X}:{:02X}:{:02X}",
+                        (i >> 16) & 0xFF, (i >> 8) & 0xFF, i & 0xFF),
+            fmt::format("=address=10.{}.{}.{}", (i >> 16) & 0xFF,
+                        (i >> 8) & 0xFF, i & 0xFF),
+            fmt::format("=to-address=10.{}.{}.{}", (i >> 16) & 0xFF,
+                        (i >> 8) & 0xFF, i & 0xFF),
+            "=server=hs1", "=bridge-port=ether2", "=uptime=1h2m3s",
+            "=idle-time=5s", "=idle-timeout=5m", "=keepalive-timeout=2m",
+            fmt::format("=bytes-in={}", (i * 7919) % 1000003),
+            fmt::format("=packets-in={}", i),
+            fmt::format("=bytes-out={}", (i * 104729) % 1000003),
+            fmt::format("=packets-out={}", i), "=.tag=0");
+        boost::asio::write(sock.input_pipe(), boost::asio::buffer(buf));
+    }
+
+    auto done = tikpp::benchmarks::util::make_sentence("!done", "=.tag=0");
+    boost::asio::write(sock.input_pipe(), boost::asio::buffer(done));
+}
+
+template <typename Run>
+void run_benchmark(const char *name, std::size_t rows, Run &&run) {
+    tikpp::io_context io {};
+
+    auto api = tikpp::make_api_te<tikpp::tests::fakes::socket>(
+        io, [](const auto &err) {
+            fmt::print(stderr, "[!] An error occured: {}\n", err.message());
+        });
+
+    api->async_open("127.0.0.1", 8728, [](const auto &) {});
+    io.poll();
+
+    std::thread feeder {[&api, rows]() { feed_rows(api->socket(), rows); }};
+
+    auto repo = tikpp::data::make_repository<host_type>(api);
+
+    tikpp::benchmarks::util::stopwatch sw {};
+    std::size_t                        selected {0};
+
+    run(repo, [&](std::size_t count) {
+        selected = count;
+        api->close();
+    });
+
+    io.run();
+    feeder.join();
+
+    fmt::print("{:<8} rows={:<8} selected={:<4} time={:>9.2f}ms "
+               "peak_rss={:>8}KiB\n",
+               name, rows, selected, sw.elapsed_ms(),
+               tikpp::benchmarks::util::peak_rss_kb());
+}
+
+} // namespace
+
+auto main() -> int {
+    constexpr std::array table_sizes {10'000UL, 40'000UL, 80'000UL};
+
+    for (auto rows : table_sizes) {
+        tikpp::benchmarks::util::run_isolated([rows] {
+            run_benchmark("top-k", rows, [](auto &repo, auto &&done) {
+                repo.async_aggregate(
+                    tikpp::data::aggregates::make_top_k<host_type>(
+                        top_count, &host_type::bytes_out),
+                    [done](const auto &err, auto &&top) {
+                        ::check(err);
+                        done(top.size());
+                    });
+            });
+        });
+    }
+
+    for (auto rows : table_sizes) {
+        tikpp::benchmarks::util::run_isolated([rows] {
+            run_benchmark("load", rows, [](auto &repo, auto &&done) {
+                repo.async_load([done](const auto &err, auto &&hosts) {
+                    ::check(err);
+
+                    auto count = std::min<std::size_t>(top_count, hosts.size());
+                    std::partial_sort(
+                        hosts.begin(), hosts.begin() + count, hosts.end(),
+                        [](const auto &lhs, const auto &rhs) {
+                            return lhs.bytes_out.value().value() >
+                                   rhs.bytes_out.value().value();
+                        });
+                    done(count);
+                });
+            });
+        });
+    }
+
+    return 0;
+}
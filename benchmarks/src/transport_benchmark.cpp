@@ -0,0 +1,152 @@
+#include "tikpp/api.hpp"
+#include "tikpp/benchmarks/fake_router.hpp"
+#include "tikpp/benchmarks/util.hpp"
+#include "tikpp/io_context.hpp"
+#include "tikpp/ssl_api.hpp"
+#include "tikpp/tests/util/tls.hpp"
+
+#include "fmt/format.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Sends bursts of requests over plain and SSL API connections to local fake
+ * routers (one of them serving TLS), which answer each request with a number
+ * of `!re' rows, and reports the request throughput, the rate which response
+ * data is received at, and the CPU time the connection thread takes per MB of
+ * it. SSL connections are run with record encryption in OpenSSL, and with it
+ * offloaded to the kernel (kTLS) if it can be, otherwise the latter are marked
+ * with `(fallback)'.
+ *
+ * Usage: transport_benchmark [requests] [rows] [row_size]
+ */
+
+namespace {
+
+struct error_handler {
+    void operator()(const boost::system::error_code &err) const {
+        fmt::print(stderr, "[!] An error occured: {}\n", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+};
+
+template <typename Api>
+void connect(Api &api, tikpp::io_context &io, std::uint16_t port) {
+    bool opened = false;
+
+    api->async_open("127.0.0.1", port, "admin", "",
+                    [&opened](const auto &err) {
+                        if (err) {
+                            error_handler {}(err);
+                        }
+
+                        opened = true;
+                    });
+
+    while (!opened) {
+        io.run_one();
+    }
+}
+
+template <typename Api>
+void run(const std::string & name,
+         Api &               api,
+         tikpp::io_context & io,
+         std::size_t         requests) {
+    std::size_t completed {0}, rows {0}, bytes {0};
+
+    tikpp::benchmarks::util::stopwatch sw {};
+    auto cpu = tikpp::benchmarks::util::thread_cpu_ms();
+
+    for (std::size_t i {0}; i < requests; ++i) {
+        api->async_send(api->make_request("/interface/print"),
+                        [&](const auto &err, auto &&resp) {
+                            if (err) {
+                                error_handler {}(err);
+                            }
+
+                            if (resp.type() == tikpp::response_type::data) {
+                                ++rows;
+
+                                for (const auto &[key, value] : resp) {
+                                    bytes += key.size() + value.size();
+                                }
+
+                                return true;
+                            }
+
+                            ++completed;
+                            return false;
+                        });
+    }
+
+    while (completed < requests) {
+        io.run_one();
+    }
+
+    auto elapsed = sw.elapsed_ms();
+    cpu          = tikpp::benchmarks::util::thread_cpu_ms() - cpu;
+
+    fmt::print("{:<20} {:>10.0f} {:>10.0f} {:>8.2f} {:>12.1f}\n", name,
+               requests * 1000 / elapsed, rows * 1000 / elapsed,
+               bytes / elapsed / 1000, cpu / (bytes / 1e6));
+
+    api->close();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t requests = argc > 1 ? std::stoul(argv[1]) : 20000;
+    std::size_t rows     = argc > 2 ? std::stoul(argv[2]) : 4;
+    std::size_t row_size = argc > 3 ? std::stoul(argv[3]) : 64;
+
+    auto respond = [rows, value = std::string(row_size, 'x')](
+                       const auto &, const auto &tag, auto &buf) {
+        for (std::size_t i {0}; i < rows; ++i) {
+            tikpp::detail::encode_word("!re", buf);
+            tikpp::detail::encode_word("=name=" + value, buf);
+            tikpp::detail::encode_word(tag, buf);
+            tikpp::detail::encode_length(0, buf);
+        }
+    };
+
+    tikpp::benchmarks::fake_router plain {1, respond};
+    tikpp::benchmarks::fake_router tls {
+        1, respond, {}, tikpp::tests::util::make_tls_server_context()};
+
+    fmt::print("{} requests, {} rows of {} bytes each\n", requests, rows,
+               row_size);
+    fmt::print("{:<20} {:>10} {:>10} {:>8} {:>12}\n", "stream", "req/s",
+               "rows/s", "MB/s", "CPU ms/MB");
+
+    {
+        tikpp::io_context io {1};
+        auto              api = tikpp::make_api(io, error_handler {});
+
+        connect(api, io, plain.port());
+        run("plain", api, io, requests);
+    }
+
+    {
+        tikpp::io_context io {1};
+        auto              api = tikpp::make_ssl_api(io, error_handler {});
+
+        connect(api, io, tls.port());
+        run("ssl", api, io, requests);
+    }
+
+    {
+        tikpp::io_context io {1};
+        auto              api = tikpp::make_ssl_api(io, error_handler {});
+        api->socket().kernel_tls(true);
+
+        connect(api, io, tls.port());
+        run(api->socket().kernel_tls_send() ? "ssl, ktls"
+                                            : "ssl, ktls (fallback)",
+            api, io, requests);
+    }
+}
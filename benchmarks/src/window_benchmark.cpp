@@ -0,0 +1,132 @@
+#include "tikpp/api.hpp"
+#include "tikpp/benchmarks/fake_router.hpp"
+#include "tikpp/benchmarks/util.hpp"
+#include "tikpp/concurrency_limiter.hpp"
+#include "tikpp/io_context.hpp"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Sends bursts of independent requests to a local fake router whose service
+ * time degrades with the number of requests it is serving at once (i.e. it
+ * thrashes when overloaded), and reports the throughput and the latency of
+ * each request (from being sent to completing), without an in-flight window,
+ * with a fixed one, and with an adaptive one.
+ *
+ * The router serves `knee' concurrent requests in the base service time, and
+ * takes quadratically longer as the concurrency grows past it.
+ *
+ * Usage: window_benchmark [requests] [knee] [base_us]
+ */
+
+namespace {
+
+struct error_handler {
+    void operator()(const boost::system::error_code &err) const {
+        fmt::print(stderr, "[!] An error occured: {}\n", err.message());
+        std::exit(EXIT_FAILURE);
+    }
+};
+
+template <typename Configure>
+void run(const char *  name,
+         std::uint16_t port,
+         std::size_t   requests,
+         Configure &&  configure) {
+    tikpp::io_context io {1};
+
+    auto api    = tikpp::make_api(io, error_handler {});
+    bool opened = false;
+
+    api->async_open("127.0.0.1", port, "admin", "",
+                    [&opened](const auto &err) {
+                        if (err) {
+                            error_handler {}(err);
+                        }
+
+                        opened = true;
+                    });
+
+    while (!opened) {
+        io.run_one();
+    }
+
+    configure(*api);
+
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> latencies {};
+    latencies.reserve(requests);
+
+    tikpp::benchmarks::util::stopwatch sw {};
+
+    for (std::size_t i {0}; i < requests; ++i) {
+        api->async_send(api->make_request("/system/identity/print"),
+                        [&latencies, sent = clock::now()](const auto &err,
+                                                          auto &&) {
+                            if (err) {
+                                error_handler {}(err);
+                            }
+
+                            latencies.push_back(
+                                std::chrono::duration<double, std::milli>(
+                                    clock::now() - sent)
+                                    .count());
+                            return false;
+                        });
+    }
+
+    while (latencies.size() < requests) {
+        io.run_one();
+    }
+
+    auto elapsed = sw.elapsed_ms();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto limit = api->concurrency_limiter() != nullptr
+                     ? fmt::format("{}", api->concurrency_limiter()->limit())
+                     : std::string {"-"};
+
+    fmt::print("{:<12} {:>12.0f} {:>10.2f} {:>10.2f} {:>8}\n", name,
+               requests * 1000 / elapsed, latencies[latencies.size() / 2],
+               latencies[latencies.size() * 99 / 100], limit);
+
+    api->close();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t requests = argc > 1 ? std::stoul(argv[1]) : 1000;
+    std::size_t knee     = argc > 2 ? std::stoul(argv[2]) : 16;
+    std::size_t base_us  = argc > 3 ? std::stoul(argv[3]) : 2000;
+
+    tikpp::benchmarks::fake_router router {
+        1, {}, [knee, base_us](std::size_t serving) {
+            auto load = static_cast<double>(serving) / knee;
+            auto us   = base_us * std::max(1.0, load * load);
+            return std::chrono::microseconds {static_cast<long>(us)};
+        }};
+
+    fmt::print("{} requests, knee of {} requests, {} us base service time\n",
+               requests, knee, base_us);
+    fmt::print("{:<12} {:>12} {:>10} {:>10} {:>8}\n", "window", "req/s",
+               "p50 (ms)", "p99 (ms)", "limit");
+
+    run("unlimited", router.port(), requests, [](auto &) {});
+
+    run("fixed", router.port(), requests,
+        [knee](auto &api) { api.max_in_flight(knee); });
+
+    run("adaptive", router.port(), requests, [](auto &api) {
+        api.concurrency_limiter(tikpp::make_concurrency_limiter());
+    });
+}
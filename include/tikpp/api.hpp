@@ -2,7 +2,7 @@
 #define TIKPP_API_HPP
 
 #include "tikpp/basic_api.hpp"
-#include "tikpp/io_context.hpp"
+#include "tikpp/connection_options.hpp"
 
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/system/error_code.hpp>
@@ -10,6 +10,7 @@
 #include <functional>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace tikpp {
 
@@ -29,52 +30,67 @@ using api_te = tikpp::basic_api_te<boost::asio::ip::tcp::socket>;
 /*!
  * \brief Creates a new instance of \see api
  *
- * \param [in] io      The IO object to be used by the API connection
+ * \param [in] ctx     The execution context or the executor to be used by
+ *                     the API connection
  * \param [in] handler A callable object to be called on fatal errors
+ * \param [in] options The TCP options of the connection socket
  *
  * \return The create \see basic_api instance
  */
 template <typename AsyncStream = boost::asio::ip::tcp::socket,
-          typename ErrorHandler>
-[[nodiscard]] inline decltype(auto) make_api(tikpp::io_context &io,
-                                             ErrorHandler &&    handler) {
+          typename ErrorHandler,
+          typename Context>
+[[nodiscard]] inline decltype(auto)
+make_api(Context &&                ctx,
+         ErrorHandler &&           handler,
+         tikpp::connection_options options = {}) {
     return tikpp::make_basic_api<AsyncStream, ErrorHandler>(
-        io, std::forward<ErrorHandler>(handler));
+        std::forward<Context>(ctx), std::forward<ErrorHandler>(handler),
+        std::move(options));
 }
 
 /*!
  * \brief Creates a new instance of \see api
  *
- * \param [in] io      The IO object to be used by the API connection
+ * \param [in] ctx     The execution context or the executor to be used by
+ *                     the API connection
  * \param [in] handler A reference to a callable object to be called on fatal
  *                     errors
+ * \param [in] options The TCP options of the connection socket
  *
  * \return The create \see basic_api instance
  */
 template <typename AsyncStream = boost::asio::ip::tcp::socket,
-          typename ErrorHandler>
-[[nodiscard]] inline decltype(auto) make_api(tikpp::io_context &io,
-                                             ErrorHandler &     handler) {
+          typename ErrorHandler,
+          typename Context>
+[[nodiscard]] inline decltype(auto)
+make_api(Context &&                ctx,
+         ErrorHandler &            handler,
+         tikpp::connection_options options = {}) {
     using wrapper_type = std::reference_wrapper<std::decay_t<ErrorHandler>>;
     return tikpp::make_basic_api<AsyncStream, wrapper_type>(
-        io, wrapper_type {handler});
+        std::forward<Context>(ctx), wrapper_type {handler}, std::move(options));
 }
 
 /*!
  * \brief Creates a new instance of \see basic_api_te
  *
- * \param [in] io      The IO object to be used by the API connection
+ * \param [in] ctx     The execution context or the executor to be used by
+ *                     the API connection
  * \param [in] handler A callable object to be called on fatal errors
+ * \param [in] options The TCP options of the connection socket
  *
  * \return The create \see basic_api instance
  */
-template <typename AsyncStream = boost::asio::ip::tcp::socket>
+template <typename AsyncStream = boost::asio::ip::tcp::socket,
+          typename Context>
 [[nodiscard]] inline auto
-make_api_te(tikpp::io_context &                                    io,
-            std::function<void(const boost::system::error_code &)> handler)
+make_api_te(Context &&                                             ctx,
+            std::function<void(const boost::system::error_code &)> handler,
+            tikpp::connection_options                              options = {})
     -> std::shared_ptr<basic_api_te<AsyncStream>> {
     return tikpp::make_basic_api<AsyncStream, std::decay_t<decltype(handler)>>(
-        io, std::move(handler));
+        std::forward<Context>(ctx), std::move(handler), std::move(options));
 }
 
 } // namespace tikpp
@@ -2,28 +2,58 @@
 #define TIKPP_BASIC_API_HPP
 
 #include "tikpp/detail/async_result.hpp"
+#include "tikpp/detail/cancellation.hpp"
+#include "tikpp/detail/lane_scheduler.hpp"
+#include "tikpp/detail/mpsc_queue.hpp"
 #include "tikpp/detail/operations/async_connect.hpp"
-#include "tikpp/detail/operations/async_read_response.hpp"
+#include "tikpp/detail/sentence_reader.hpp"
+#include "tikpp/detail/timer_wheel.hpp"
 #include "tikpp/detail/type_traits/error_handler.hpp"
 #include "tikpp/detail/type_traits/stream.hpp"
 
+#include "tikpp/commands/cancel.hpp"
 #include "tikpp/commands/login.hpp"
+#include "tikpp/concurrency_limiter.hpp"
+#include "tikpp/connection_options.hpp"
+#include "tikpp/dns_cache.hpp"
+#include "tikpp/error_code.hpp"
+#include "tikpp/health_check.hpp"
 #include "tikpp/io_context.hpp"
+#include "tikpp/login_cache.hpp"
+#include "tikpp/read_budget.hpp"
+#include "tikpp/reconnect_policy.hpp"
 #include "tikpp/request.hpp"
+#include "tikpp/resolver.hpp"
 #include "tikpp/response.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/ip/address.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/wait_traits.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/system/error_code.hpp>
 
 #include <type_traits>
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
-#include <deque>
+#include <chrono>
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
+#include <optional>
+#include <random>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace tikpp {
 
@@ -31,6 +61,15 @@ enum class api_state { closed, connecting, connected };
 
 /*!
  * \brief A struct to manage RouterOS API connections
+ *
+ * All the connection state is only accessed from a strand, so the IO context
+ * may be run by multiple threads, and requests may be sent from any thread.
+ * Sent requests are pushed to a lock-free queue, which the strand drains in
+ * batches.
+ *
+ * The connection runs on the executor of its stream, so any Asio executor can
+ * be used by choosing a stream type which is bound to it (e.g.
+ * `boost::asio::basic_stream_socket<boost::asio::ip::tcp, Executor>`).
  */
 template <typename AsyncStream,
           typename ErrorHandler,
@@ -47,8 +86,53 @@ struct basic_api
                                             tikpp::response &&)>;
 
     /*!
-     * \brief Asynchronously opens an API connection to the router, then logs
-     *        in to the router
+     * \brief The executor of the connection stream
+     */
+    using inner_executor_type = std::decay_t<
+        decltype(std::declval<AsyncStream &>().get_executor())>;
+
+    /*!
+     * \brief The executor which all the connection handlers are run on
+     */
+    using executor_type = boost::asio::strand<inner_executor_type>;
+
+    /*!
+     * \brief The maximum number of queued requests which are moved to the
+     *        send queue in one strand turn
+     */
+    static constexpr std::size_t submit_batch_size = 64;
+
+    /*!
+     * \brief The number of bytes after which no more queued sentences are
+     *        added to a write, which is the largest TLS record payload, so
+     *        that an SSL connection writes full records
+     */
+    static constexpr std::size_t write_batch_size = 16 * 1024;
+
+    /*!
+     * \brief The size of the socket reads, which may hold many small
+     *        sentences, or part of a large one
+     */
+    static constexpr std::size_t read_buffer_size = 16 * 1024;
+
+    /*!
+     * \brief The tick length of the request deadlines timer wheel, which is
+     *        how late a request may time out
+     */
+    static constexpr std::chrono::milliseconds timer_resolution {10};
+
+    /*!
+     * \brief How many requests of each priority class may be written in a row
+     *        while a less urgent class is waiting, indexed by
+     *        \ref tikpp::request_priority. Zero lets high priority requests
+     *        always go first
+     */
+    static constexpr std::array<std::size_t, 3> priority_weights {0, 8, 1};
+
+    /*!
+     * \brief Asynchronously opens an API connection to the router. Requests
+     *        sent while it is being opened are held, and written as soon as
+     *        it is opened (or failed if it cannot be)
      *
      * \param [in]     host     The router host address
      * \param [in]     port     The API listening port
@@ -64,39 +148,24 @@ struct basic_api
                                     token, handler, result);
 
         if (state_.load() == api_state::connecting) {
-            io_.post([handler {std::move(handler)}]() mutable {
-                handler(boost::asio::error::make_error_code(
-                    boost::asio::error::in_progress));
-            });
+            reject_open(std::move(handler));
             return result.get();
         }
 
-        assert(state_.load() == api_state::closed);
-        state_.store(api_state::connecting);
-
-        tikpp::detail::operations::async_connect(
-            sock_, host, port,
-            [self = this->shared_from_this(),
-             handler {std::move(handler)}](const auto &err) mutable {
-                assert(self->state_.load() == api_state::connecting);
-
-                if (err) {
-                    self->state_.store(api_state::closed);
-                    return handler(err);
-                }
-
-                self->state_.store(api_state::connected);
-                handler(err);
-
-                self->read_next_response();
-            });
+        open_socket(host, port,
+                    [this, handler {std::move(handler)}](
+                        const auto &err) mutable {
+                        release_held(err);
+                        complete(std::move(handler), err);
+                    });
 
         return result.get();
     }
 
     /*!
      * \brief Asynchronously opens an API connection to the router, then logs
-     *        in to the router
+     *        in to the router. Requests sent meanwhile are held, and written
+     *        right behind the login once it succeeds
      *
      * \param [in]     host     The router host address
      * \param [in]     port     The API listening port
@@ -117,38 +186,61 @@ struct basic_api
         GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
                                     token, handler, result);
 
-        async_open(host, port,
-                   [this, handler {std::move(handler)}, name,
-                    password](const auto &err) mutable {
-                       if (err) {
-                           return handler(err);
-                       }
+        if (state_.load() == api_state::connecting) {
+            reject_open(std::move(handler));
+            return result.get();
+        }
 
-                       async_login(name, password,
-                                   [this, handler {std::move(handler)}](
-                                       const auto &err) mutable {
-                                       if (err) {
-                                           if (is_open()) {
-                                               close();
-                                           }
-
-                                           handler(err);
-                                       } else {
-                                           handler(
-                                               boost::system::error_code {});
-                                       }
-                                   });
-                   });
+        // Kept to log in again after reconnecting
+        if (reconnect_policy_.has_value()) {
+            credentials_.emplace(name, password);
+        }
+
+        open_socket(
+            host, port,
+            [this, handler {std::move(handler)}, name,
+             password](const auto &err) mutable {
+                if (err) {
+                    release_held(err);
+                    return complete(std::move(handler), err);
+                }
+
+                async_login(name, password,
+                            [this, handler {std::move(handler)}](
+                                const auto &err) mutable {
+                                if (err && is_open()) {
+                                    close();
+                                }
+
+                                // The held requests are written right
+                                // behind the login, before the handler runs
+                                release_held(err);
+                                complete(std::move(handler), err);
+                            });
+            });
 
         return result.get();
     }
 
-    //! \brief Closes an already-opened connection to the router
+    /*!
+     * \brief Closes an already-opened connection to the router, or stops
+     *        reconnecting it, in which case the requests waiting for it fail
+     *        with `operation_aborted'. Must be called from a connection
+     *        handler, or while the IO context is not running
+     */
     inline void close() {
+        if (reconnecting_) {
+            if (is_open()) {
+                close_socket();
+            }
+
+            drop_written_deadlines();
+            return give_up(boost::asio::error::operation_aborted, false);
+        }
+
         assert(is_open());
-        sock_.close();
-        state_.store(api_state::closed);
-        logged_in_.store(false);
+        close_socket();
+        drop_written_deadlines();
     }
 
     /*!
@@ -183,7 +275,8 @@ struct basic_api
     }
 
     /*!
-     * \brief Asynchronously sends a request to the router
+     * \brief Asynchronously sends a request to the router. Safe to be called
+     *        from any thread
      *
      * \param [in]      req   The request to the best
      * \param [in, out] token The asynchronous operation completion token
@@ -198,18 +291,77 @@ struct basic_api
             void(const boost::system::error_code &, tikpp::response &&), token,
             handler, result);
 
-        io_.post([self = this->shared_from_this(), req {std::move(req)},
-                  handler {std::move(handler)}]() mutable {
-            self->send_queue_.emplace_back(
-                std::make_pair(std::move(req), std::move(handler)));
-            self->send_next();
-        });
+        auto cb = make_read_handler(req->tag(), std::move(handler));
+
+        // Fast path for requests sent from a connection handler (e.g. chained
+        // requests): no scheduler round trip is needed to reach the strand
+        if (strand_.running_in_this_thread() && is_open()) {
+            move_submitted(std::numeric_limits<std::size_t>::max());
+            enqueue(std::make_pair(std::move(req), std::move(cb)));
+
+            if (!writing_ && !send_queue_.empty()) {
+                send_next();
+            }
+
+            return result.get();
+        }
+
+        submit_queue_.push(std::make_pair(std::move(req), std::move(cb)));
+
+        if (!drain_scheduled_.exchange(true)) {
+            boost::asio::post(strand_,
+                              [self = this->shared_from_this()]() mutable {
+                                  self->drain_submit_queue();
+                              });
+        }
 
         return result.get();
     }
 
     /*!
-     * \brief Asynchronously logs in to the router
+     * \brief Asynchronously sends a request to the router with a priority
+     *        class, ahead of the queued requests of less urgent classes. Safe
+     *        to be called from any thread
+     *
+     * \param [in]      req      The request to the sent
+     * \param [in]      priority The priority class of the request
+     * \param [in, out] token    The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    void async_send(std::shared_ptr<request> req,
+                    request_priority         priority,
+                    CompletionToken &&       token) {
+        assert(req != nullptr);
+
+        req->priority(priority);
+        return async_send(std::move(req),
+                          std::forward<CompletionToken>(token));
+    }
+
+    /*!
+     * \brief Cancels a request, which completes with `operation_aborted'. A
+     *        request which was already written to the router is also
+     *        cancelled on the router, so it stops producing responses. Safe
+     *        to be called from any thread
+     *
+     * Requests are also cancelled when the cancellation slot associated with
+     * their completion handler is emitted (Boost 1.77 and newer).
+     *
+     * \param [in] tag The tag of the request to be cancelled
+     */
+    inline void cancel(std::uint32_t tag) {
+        boost::asio::dispatch(
+            strand_, [self = this->shared_from_this(), tag]() {
+                self->abort_request(tag, boost::asio::error::operation_aborted,
+                                    true);
+            });
+    }
+
+    /*!
+     * \brief Asynchronously logs in to the router, with the protocol which
+     *        it was last logged in with (\see tikpp::login_cache)
      *
      * \param [in]      name     The user name which to be used to login to the
      *                           router
@@ -227,49 +379,72 @@ struct basic_api
         GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
                                     token, handler, result);
 
+        auto key = login_key();
+
+        if (login_cache_->lookup(key) != tikpp::login_protocol::v1) {
+            login_v2(name, password, std::move(handler));
+            return result.get();
+        }
+
+        using tikpp::commands::v1::login;
+
         async_send(
-            make_request<tikpp::commands::v2::login>(name, password),
-            [this, name, password, handler {std::move(handler)}](
+            make_request<tikpp::commands::v1::challenge>(),
+            [this, key, name, password, handler {std::move(handler)}](
                 const auto &err, auto &&resp) mutable {
                 if (err) {
-                    handler(err);
-                } else if (resp.error()) {
-                    handler(resp.error());
-                } else if (resp.contains(
-                               tikpp::commands::v1::login::challenge_param)) {
-                    auto req = make_request<tikpp::commands::v1::login>(
-                        name, password,
-                        resp[tikpp::commands::v1::login::challenge_param]);
-                    async_send(std::move(req),
-                               [this, handler {std::move(handler)}](
-                                   const auto &err, auto &&resp) mutable {
-                                   if (err) {
-                                       handler(err);
-                                   } else if (resp.error()) {
-                                       handler(resp.error());
-                                   } else {
-                                       logged_in_.store(true);
-                                       handler(boost::system::error_code {});
-                                   }
-
-                                   return false;
-                               });
+                    complete(std::move(handler), err);
+                } else if (!resp.error() &&
+                           resp.contains(login::challenge_param)) {
+                    login_v1(name, password, resp[login::challenge_param],
+                             std::move(handler));
                 } else {
-                    handler(boost::system::error_code {});
+                    // The router does not use the old protocol anymore
+                    login_cache_->erase(key);
+                    login_v2(name, password, std::move(handler));
                 }
+
                 return false;
             });
 
         return result.get();
     }
 
+    /*!
+     * \brief Asynchronously asks the router to stop executing a request
+     *
+     * The router completes the cancelled request with an `interrupted' trap
+     * followed by `!done'.
+     *
+     * \param [in]      tag   The tag of the request to be cancelled
+     * \param [in, out] token The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    decltype(auto) async_cancel(std::uint32_t tag, CompletionToken &&token) {
+        GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
+                                    token, handler, result);
+
+        async_send(make_request<tikpp::commands::cancel>(tag),
+                   [self = this->shared_from_this(),
+                    handler {std::move(handler)}](const auto &err,
+                                                  auto &&resp) mutable {
+                       self->complete(std::move(handler),
+                                      err ? err : resp.error());
+                       return false;
+                   });
+
+        return result.get();
+    }
+
     /*!
      * \brief Gets the current request tag that the next request will have
      *
      * \return The next request tag
      */
     [[nodiscard]] inline auto current_tag() const noexcept -> std::uint32_t {
-        return current_tag_.load();
+        return current_tag_->load();
     }
 
     /*!
@@ -278,170 +453,1496 @@ struct basic_api
      * \return A unique request tag
      */
     [[nodiscard]] inline auto aquire_unique_tag() noexcept -> std::uint32_t {
-        return current_tag_.fetch_add(1);
+        return current_tag_->fetch_add(1);
     }
 
     /*!
-     * \brief Gets the API connection socket
+     * \brief Gets the counter which the request tags are aquired from
      *
-     * \return The connection socket
+     * \return The tag counter
      */
-    [[nodiscard]] inline auto socket() noexcept -> AsyncStream & {
-        return sock_;
+    [[nodiscard]] inline auto tag_counter() const noexcept
+        -> const std::shared_ptr<std::atomic_uint32_t> & {
+        return current_tag_;
     }
 
     /*!
-     * \brief Gets whether the API connection is open or not
+     * \brief Sets the counter which the request tags are aquired from, which
+     *        allows multiple connections to share the same tag space (e.g.
+     *        when pooled). Must be set before sending any requests
      *
-     * \return The connection open status
+     * \param [in] counter The tag counter to be used
      */
-    [[nodiscard]] inline auto is_open() const noexcept -> bool {
-        return state_.load() == api_state::connected && sock_.is_open();
+    inline void tag_counter(std::shared_ptr<std::atomic_uint32_t> counter) {
+        assert(counter != nullptr);
+        current_tag_ = std::move(counter);
     }
 
     /*!
-     * \brief Gets whether the API connection is authenticated or not
+     * \brief Gets the time which requests have to complete within, unless
+     *        they set their own timeout (\see tikpp::request::timeout)
      *
-     * \return The connection authentication status
+     * \return The default request timeout, or zero if disabled
      */
-    [[nodiscard]] inline auto is_logged_in() const noexcept -> bool {
-        return logged_in_.load();
+    [[nodiscard]] inline auto default_timeout() const noexcept
+        -> std::chrono::milliseconds {
+        return default_timeout_;
     }
 
-  protected:
-    explicit basic_api(tikpp::io_context &io, ErrorHandler &&handler)
-        : io_ {io},
-          sock_ {io},
-          error_handler_ {std::move(handler)},
-          state_ {api_state::closed},
-          current_tag_ {0},
-          logged_in_ {false} {
+    /*!
+     * \brief Sets the time which requests have to complete within, before
+     *        they fail with `timed_out' and are cancelled on the router. Must
+     *        be set before sending any requests, or from a connection handler
+     *
+     * \param [in] value The default request timeout, or zero to disable it
+     */
+    inline void default_timeout(std::chrono::milliseconds value) noexcept {
+        default_timeout_ = value;
     }
 
-  private:
-    inline void send_next() {
-        assert(!send_queue_.empty());
+    /*!
+     * \brief Gets the number of requests which have a pending deadline
+     */
+    [[nodiscard]] inline auto pending_deadlines() const noexcept
+        -> std::size_t {
+        return deadlines_.size();
+    }
 
-        auto [req, cb] = std::move(send_queue_.front());
-        send_queue_.pop_front();
+    [[nodiscard]] inline auto reconnect_policy() const noexcept
+        -> const std::optional<tikpp::reconnect_policy> & {
+        return reconnect_policy_;
+    }
 
-        if (!is_open()) {
-            cb(boost::asio::error::not_connected, {});
-            return;
-        }
+    /*!
+     * \brief Enables reopening the connection when it is lost, instead of
+     *        calling the error handler, which is only called once the policy
+     *        gives up. After reconnecting, the connection logs in again,
+     *        long-lived requests (i.e. `listen' commands) are sent again with
+     *        the same tags, and the other written requests are either sent
+     *        again or failed, depending on whether they are idempotent.
+     *        Requests sent meanwhile wait until the connection is resumed.
+     *        Must be set before opening the connection
+     *
+     * \param [in] policy The reconnection policy, or none to disable it
+     */
+    inline void
+    reconnect_policy(std::optional<tikpp::reconnect_policy> policy) noexcept {
+        reconnect_policy_ = std::move(policy);
+    }
 
-        auto buf = std::make_shared<std::vector<std::uint8_t>>();
-        req->encode(*buf);
+    [[nodiscard]] inline auto resolver() const noexcept
+        -> const tikpp::resolver & {
+        return resolver_;
+    }
 
-        boost::asio::async_write(
-            sock_, boost::asio::buffer(*buf),
-            [self = this->shared_from_this(), buf, req {std::move(req)},
-             cb {std::move(cb)}](const auto &err, const auto &sent) mutable {
-                if (!self->is_open()) {
-                    cb(boost::asio::error::not_connected, {});
-                    return;
-                }
+    /*!
+     * \brief Sets the resolver used to resolve host names when opening the
+     *        connection (e.g. a stub in tests)
+     *
+     * \param [in] resolve The resolver, or an empty function to use the
+     *                     system resolver
+     */
+    inline void resolver(tikpp::resolver resolve) noexcept {
+        resolver_ = std::move(resolve);
+    }
 
-                if (err) {
-                    self->close();
-                    cb(err, {});
-                } else {
-                    self->read_cbs_.emplace(
-                        std::make_pair(req->tag(), std::move(cb)));
-                }
+    [[nodiscard]] inline auto dns_cache() const noexcept
+        -> const std::shared_ptr<tikpp::dns_cache> & {
+        return dns_cache_;
+    }
 
-                if (!self->send_queue_.empty()) {
-                    self->send_next();
-                }
-            });
+    /*!
+     * \brief Sets the cache which resolved host names are kept in, which is
+     *        \see tikpp::default_dns_cache unless set otherwise
+     *
+     * \param [in] cache The DNS cache
+     */
+    inline void dns_cache(std::shared_ptr<tikpp::dns_cache> cache) noexcept {
+        assert(cache != nullptr);
+        dns_cache_ = std::move(cache);
     }
 
-    inline void read_next_response() {
-        if (!is_open()) {
-            return;
-        }
+    [[nodiscard]] inline auto login_cache() const noexcept
+        -> const std::shared_ptr<tikpp::login_cache> & {
+        return login_cache_;
+    }
 
-        tikpp::detail::operations::async_read_response(
-            sock_, [self = this->shared_from_this()](const auto &err,
-                                                     auto &&     resp) mutable {
-                if (!self->is_open()) {
-                    return;
-                }
+    /*!
+     * \brief Sets the cache which the login protocols of routers are kept in,
+     *        which is \see tikpp::default_login_cache unless set otherwise
+     *
+     * \param [in] cache The login protocol cache
+     */
+    inline void
+    login_cache(std::shared_ptr<tikpp::login_cache> cache) noexcept {
+        assert(cache != nullptr);
+        login_cache_ = std::move(cache);
+    }
 
-                if (err) {
-                    return self->on_error(err);
-                }
+    [[nodiscard]] inline auto connection_options() const noexcept
+        -> const tikpp::connection_options & {
+        return connection_options_;
+    }
 
-                self->on_response(std::move(resp));
-            });
+    /*!
+     * \brief Sets the TCP options of the connection socket, which are applied
+     *        each time it is connected (\see tikpp::connection_options).
+     *        Ignored if the lowest layer of the stream is not a TCP socket
+     *
+     * \param [in] options The connection options
+     */
+    inline void connection_options(tikpp::connection_options options) noexcept {
+        connection_options_ = std::move(options);
     }
 
-    inline void on_response(tikpp::response &&resp) {
-        if (auto itr = read_cbs_.find(resp.tag().value());
-            itr != read_cbs_.end()) {
-            if (!itr->second({}, std::move(resp))) {
-                read_cbs_.erase(itr);
-            }
+    [[nodiscard]] inline auto health_check() const noexcept
+        -> const std::optional<tikpp::health_check_policy> & {
+        return health_check_;
+    }
+
+    /*!
+     * \brief Enables checking the health of the connection: it is probed while
+     *        it is idle, its round trip time is tracked, and requests fail at
+     *        once with `router_unhealthy' while its circuit breaker is open
+     *        (\see tikpp::health_check_policy). The probes keep the IO context
+     *        busy while the connection is open. Must be set before opening
+     *        the connection
+     *
+     * \param [in] policy The health check policy, or none to disable it
+     */
+    inline void
+    health_check(std::optional<tikpp::health_check_policy> policy) {
+        health_check_ = std::move(policy);
+        breaker_.reset();
+
+        if (health_check_.has_value()) {
+            breaker_.emplace(health_check_->failure_threshold,
+                             health_check_->open_duration);
         }
+    }
 
-        read_next_response();
+    /*!
+     * \brief Gets the round trip time estimate of the connection, which is
+     *        measured by the health check probes. Safe to be called from any
+     *        thread
+     */
+    [[nodiscard]] inline auto rtt() const noexcept
+        -> const tikpp::rtt_estimator & {
+        return rtt_;
     }
 
-    inline void on_error(const boost::system::error_code &err) {
-        close();
-        error_handler_(err);
+    /*!
+     * \brief Gets the circuit breaker of the connection, which is only set
+     *        while the health check is enabled
+     */
+    [[nodiscard]] inline auto circuit_breaker() const noexcept
+        -> const std::optional<tikpp::circuit_breaker> & {
+        return breaker_;
+    }
+
+    /*!
+     * \brief Gets whether requests are accepted, i.e. the health check is
+     *        disabled or the circuit breaker is closed. Safe to be called
+     *        from any thread
+     */
+    [[nodiscard]] inline auto is_healthy() const noexcept -> bool {
+        return !breaker_.has_value() ||
+               breaker_->state() == tikpp::circuit_state::closed;
     }
 
-    tikpp ::io_context &io_;
-    AsyncStream         sock_;
-    ErrorHandler        error_handler_;
+    [[nodiscard]] inline auto read_budget() const noexcept
+        -> const tikpp::read_budget & {
+        return read_budget_;
+    }
 
-    std::atomic<api_state> state_;
-    std::atomic_uint32_t   current_tag_;
-    std::atomic_bool       logged_in_;
+    /*!
+     * \brief Sets how much read data the connection decodes in one turn
+     *        before yielding to the other handlers of the IO context (\see
+     *        tikpp::read_budget). Must be set before opening the connection,
+     *        or from a connection handler
+     *
+     * \param [in] budget The read budget
+     */
+    inline void read_budget(tikpp::read_budget budget) noexcept {
+        read_budget_ = budget;
+    }
 
-    std::deque<std::pair<std::shared_ptr<request>, read_handler>> send_queue_;
-    std::map<std::uint32_t, read_handler>                         read_cbs_;
-};
+    /*!
+     * \brief Gets the read turns statistics of the connection. Safe to be
+     *        called from any thread
+     */
+    [[nodiscard]] inline auto read_stats() const noexcept
+        -> const tikpp::read_stats & {
+        return read_stats_;
+    }
 
-//! A type-erased alias for \see basic_api struct
-template <typename AsyncStream>
-using basic_api_te =
-    basic_api<AsyncStream,
-              std::function<void(const boost::system::error_code &)>>;
+    /*!
+     * \brief Gets whether the connection was lost, and is being reopened
+     */
+    [[nodiscard]] inline auto is_reconnecting() const noexcept -> bool {
+        return reconnecting_;
+    }
 
-namespace detail {
+    /*!
+     * \brief Gets the maximum number of requests which are written to the
+     *        router without having completed yet
+     *
+     * \return The in-flight window size, or zero if unlimited
+     */
+    [[nodiscard]] inline auto max_in_flight() const noexcept -> std::size_t {
+        return max_in_flight_;
+    }
 
-/*!
- * \brief A wrapper class to enable the use of \see std::make_shared function
- *        on \see basic_api struct
- */
-template <typename AsyncStream, typename ErrorHandler>
-struct basic_api_creator : tikpp::basic_api<AsyncStream, ErrorHandler> {
-    template <typename... Arg>
-    basic_api_creator(Arg &&... args)
-        : tikpp::basic_api<AsyncStream, ErrorHandler> {
-              std::forward<Arg>(args)...} {
+    /*!
+     * \brief Sets the maximum number of requests which are written to the
+     *        router without having completed yet. Further requests wait in
+     *        the send queue until earlier ones complete. Long-lived requests
+     *        (i.e. `listen' commands) and `/cancel' requests are never held
+     *        back, nor counted. Must be set before sending any requests, or
+     *        from a connection handler
+     *
+     * \param [in] value The in-flight window size, or zero to disable it
+     */
+    inline void max_in_flight(std::size_t value) noexcept {
+        max_in_flight_ = value;
     }
-};
 
-} // namespace detail
+    [[nodiscard]] inline auto concurrency_limiter() const noexcept
+        -> const std::shared_ptr<tikpp::concurrency_limiter> & {
+        return limiter_;
+    }
 
-/*!
- * \brief Creates a new instance of \see basic_api struct
- *
- * \param [in] io      The IO object to be used by the API connection
- * \param [in] handler A callable object to be called on fatal errors
- *
- * \return The create \see basic_api instance
- */
-template <typename AsyncStream, typename ErrorHandler>
-[[nodiscard]] inline auto make_basic_api(tikpp::io_context &io,
-                                         ErrorHandler &&    handler)
-    -> std::shared_ptr<tikpp::basic_api<AsyncStream, ErrorHandler>> {
-    return std::make_shared<
-        tikpp::detail::basic_api_creator<AsyncStream, ErrorHandler>>(
-        io, std::forward<ErrorHandler>(handler));
+    /*!
+     * \brief Sets a limiter which adapts the in-flight window to the observed
+     *        response latency, within \ref max_in_flight if set. Must be set
+     *        before sending any requests, or from a connection handler
+     *
+     * \param [in] limiter The concurrency limiter, or null to disable it
+     */
+    inline void
+    concurrency_limiter(std::shared_ptr<tikpp::concurrency_limiter> limiter) {
+        limiter_ = std::move(limiter);
+    }
+
+    /*!
+     * \brief Gets the number of requests which count towards the in-flight
+     *        window, and were written without having completed yet
+     */
+    [[nodiscard]] inline auto in_flight() const noexcept -> std::size_t {
+        return window_.size();
+    }
+
+    /*!
+     * \brief Gets the API connection socket
+     *
+     * \return The connection socket
+     */
+    [[nodiscard]] inline auto socket() noexcept -> AsyncStream & {
+        return sock_;
+    }
+
+    /*!
+     * \brief Gets the strand which all the connection handlers are run on
+     *
+     * \return The connection executor
+     */
+    [[nodiscard]] inline auto get_executor() const noexcept -> executor_type {
+        return strand_;
+    }
+
+    /*!
+     * \brief Gets whether the API connection is open or not
+     *
+     * \return The connection open status
+     */
+    [[nodiscard]] inline auto is_open() const noexcept -> bool {
+        return state_.load() == api_state::connected && sock_.is_open();
+    }
+
+    /*!
+     * \brief Gets whether reading from the connection is paused because a
+     *        flow ran out of credit (\see tikpp::flow_control)
+     *
+     * \return The reading pause status
+     */
+    [[nodiscard]] inline auto is_reading_paused() const noexcept -> bool {
+        return paused_work_.has_value();
+    }
+
+    /*!
+     * \brief Gets whether the API connection is authenticated or not
+     *
+     * \return The connection authentication status
+     */
+    [[nodiscard]] inline auto is_logged_in() const noexcept -> bool {
+        return logged_in_.load();
+    }
+
+  protected:
+    template <typename Context>
+    explicit basic_api(Context &&ctx, ErrorHandler &&handler)
+        : sock_ {std::forward<Context>(ctx)},
+          strand_ {sock_.get_executor()},
+          timer_ {sock_.get_executor()},
+          epoch_ {std::chrono::steady_clock::now()},
+          error_handler_ {std::move(handler)},
+          state_ {api_state::closed},
+          current_tag_ {std::make_shared<std::atomic_uint32_t>(0)},
+          logged_in_ {false},
+          send_queue_ {priority_weights},
+          reconnect_timer_ {sock_.get_executor()},
+          rng_ {std::random_device {}()},
+          probe_timer_ {sock_.get_executor()} {
+    }
+
+  private:
+    using queued_request = std::pair<std::shared_ptr<request>, read_handler>;
+
+    struct deadline {
+        std::uint32_t tag;
+        bool          cancel;
+    };
+
+    /*
+     * The encoded sentences of a write, and the tags of their requests
+     */
+    struct write_batch {
+        std::vector<std::uint8_t>  buf;
+        std::vector<std::uint32_t> tags;
+    };
+
+    using timer_type = boost::asio::basic_waitable_timer<
+        std::chrono::steady_clock,
+        boost::asio::wait_traits<std::chrono::steady_clock>,
+        inner_executor_type>;
+
+    /*
+     * Calls a completion handler on its associated executor, which is the
+     * connection strand unless the handler was bound to another one
+     */
+    template <typename Handler>
+    inline void complete(Handler &&                       handler,
+                         const boost::system::error_code &err) {
+        auto ex = boost::asio::get_associated_executor(handler, strand_);
+        boost::asio::dispatch(ex, [handler {std::forward<Handler>(handler)},
+                                   err]() mutable { handler(err); });
+    }
+
+    inline auto login_key() const -> std::string {
+        return host_ + ':' + std::to_string(port_);
+    }
+
+    /*
+     * Logs in with the plain protocol, or with the challenge-response one if
+     * the router answers with a challenge (i.e. it is older than 6.43)
+     */
+    template <typename Handler>
+    inline void login_v2(const std::string &name,
+                         const std::string &password,
+                         Handler &&         handler) {
+        using tikpp::commands::v1::login;
+
+        async_send(make_request<tikpp::commands::v2::login>(name, password),
+                   [this, name, password,
+                    handler {std::forward<Handler>(handler)}](
+                       const auto &err, auto &&resp) mutable {
+                       if (err || resp.error()) {
+                           complete(std::move(handler),
+                                    err ? err : resp.error());
+                       } else if (resp.contains(login::challenge_param)) {
+                           login_v1(name, password,
+                                    resp[login::challenge_param],
+                                    std::move(handler));
+                       } else {
+                           on_logged_in(tikpp::login_protocol::v2);
+                           complete(std::move(handler), {});
+                       }
+
+                       return false;
+                   });
+    }
+
+    template <typename Handler>
+    inline void login_v1(const std::string &name,
+                         const std::string &password,
+                         const std::string &challenge,
+                         Handler &&         handler) {
+        async_send(make_request<tikpp::commands::v1::login>(name, password,
+                                                            challenge),
+                   [this, handler {std::forward<Handler>(handler)}](
+                       const auto &err, auto &&resp) mutable {
+                       if (!err && !resp.error()) {
+                           on_logged_in(tikpp::login_protocol::v1);
+                       }
+
+                       complete(std::move(handler), err ? err : resp.error());
+                       return false;
+                   });
+    }
+
+    inline void on_logged_in(tikpp::login_protocol protocol) {
+        logged_in_.store(true);
+        login_cache_->store(login_key(), protocol);
+    }
+
+    template <typename Handler>
+    inline void reject_open(Handler &&handler) {
+        auto ex = boost::asio::get_associated_executor(handler, strand_);
+        boost::asio::post(ex,
+                          [handler {std::forward<Handler>(handler)}]() mutable {
+                              handler(boost::asio::error::make_error_code(
+                                  boost::asio::error::in_progress));
+                          });
+    }
+
+    /*
+     * Connects the socket, and starts holding the requests which are sent
+     * until \ref release_held is called. The handler is called on the strand
+     */
+    template <typename Handler>
+    inline void open_socket(const std::string &host,
+                            std::uint16_t      port,
+                            Handler &&         handler) {
+        assert(state_.load() == api_state::closed);
+        state_.store(api_state::connecting);
+        opening_.store(true);
+
+        host_ = host;
+        port_ = port;
+
+        tikpp::detail::operations::async_connect(
+            sock_, host, port, resolver_, dns_cache_,
+            boost::asio::bind_executor(
+                strand_,
+                [self = this->shared_from_this(),
+                 handler {std::forward<Handler>(handler)}](
+                    const auto &err) mutable {
+                    assert(self->state_.load() == api_state::connecting);
+
+                    if (err) {
+                        self->state_.store(api_state::closed);
+                        return handler(err);
+                    }
+
+                    self->state_.store(api_state::connected);
+                    self->apply_connection_options();
+                    self->start_probing();
+                    self->read_next_response();
+                    handler(err);
+                }));
+    }
+
+    /*
+     * Stops holding the requests sent while the connection was being opened,
+     * and writes them, or fails them if it could not be opened
+     */
+    inline void release_held(const boost::system::error_code &err) {
+        opening_.store(false);
+
+        if (err) {
+            return fail_queued(err);
+        }
+
+        move_submitted(std::numeric_limits<std::size_t>::max());
+
+        if (!writing_ && !send_queue_.empty()) {
+            send_next();
+        }
+    }
+
+    inline void fail_queued(const boost::system::error_code &err) {
+        move_submitted(std::numeric_limits<std::size_t>::max());
+
+        while (!send_queue_.empty()) {
+            auto item = std::move(send_queue_.front());
+            send_queue_.pop();
+            fail_unsent(item, err);
+        }
+    }
+
+    /*
+     * Fails a request which was never written, along with its deadline
+     */
+    inline void fail_unsent(queued_request &                 item,
+                            const boost::system::error_code &err) {
+        remove_deadline(item.first->tag());
+        item.second(err, {});
+    }
+
+    template <typename Handler>
+    inline auto make_read_handler([[maybe_unused]] std::uint32_t tag,
+                                  Handler &&handler) -> read_handler {
+#ifdef TIKPP_HAS_CANCELLATION_SLOTS
+        if (auto slot = tikpp::detail::cancellation_slot_of(handler);
+            slot.is_connected()) {
+            slot.assign([weak = this->weak_from_this(),
+                         tag](boost::asio::cancellation_type) {
+                if (auto self = weak.lock()) {
+                    self->cancel(tag);
+                }
+            });
+
+            // The slot may be reused by another operation once this one is
+            // completed
+            return [slot, handler {std::forward<Handler>(handler)}](
+                       const boost::system::error_code &err,
+                       tikpp::response &&               resp) mutable {
+                auto keep = handler(err, std::move(resp));
+
+                if (err || !keep) {
+                    slot.clear();
+                }
+
+                return keep;
+            };
+        }
+#endif
+
+        return read_handler {std::forward<Handler>(handler)};
+    }
+
+    inline auto move_submitted(std::size_t max) -> std::size_t {
+        queued_request item {};
+        std::size_t    moved {0};
+
+        while (moved < max && submit_queue_.pop(item)) {
+            enqueue(std::move(item));
+            ++moved;
+        }
+
+        return moved;
+    }
+
+    inline void enqueue(queued_request item) {
+        if (is_shed(*item.first)) {
+            item.second(tikpp::error_code::router_unhealthy, {});
+            return;
+        }
+
+        // The deadline starts once the request is submitted, so it also
+        // bounds the time spent waiting to be written (e.g. behind a full
+        // window, or while the connection is being opened or reconnected)
+        if (auto timeout = item.first->timeout().value_or(default_timeout_);
+            timeout.count() > 0) {
+            add_deadline(item.first->tag(), timeout,
+                         item.first->command() !=
+                             tikpp::commands::cancel::command);
+        }
+
+        auto lane = static_cast<std::size_t>(item.first->priority());
+        send_queue_.push(lane, std::move(item));
+    }
+
+    inline void drain_submit_queue() {
+        drain_scheduled_.store(false);
+
+        auto drained = move_submitted(submit_batch_size);
+
+        // Yields to the other handlers before draining the rest
+        if (drained == submit_batch_size && !drain_scheduled_.exchange(true)) {
+            boost::asio::post(strand_,
+                              [self = this->shared_from_this()]() mutable {
+                                  self->drain_submit_queue();
+                              });
+        }
+
+        if (!writing_ && !send_queue_.empty()) {
+            send_next();
+        }
+    }
+
+    inline void send_next() {
+        assert(!send_queue_.empty());
+
+        auto batch = std::make_shared<write_batch>();
+
+        // Only the login requests are written while the connection is being
+        // opened or reconnected, the rest wait until it is ready (\see
+        // release_held and \see resume)
+        if (reconnecting_ || opening_.load()) {
+            if (is_open()) {
+                if (auto item = send_queue_.extract_if([](const auto &item) {
+                        return is_login(*item.first);
+                    })) {
+                    add_to_batch(*batch, std::move(item->first),
+                                 std::move(item->second));
+                    flush_batch(std::move(batch));
+                }
+            }
+
+            return;
+        }
+
+        // The queued sentences are written together, up to the payload of a
+        // full TLS record, rather than each by its own (small) write
+        while (!send_queue_.empty() && batch->buf.size() < write_batch_size) {
+            // Resumed once an earlier request completes (\see release_window)
+            if (is_open() && is_window_full() &&
+                counts_in_window(*send_queue_.front().first)) {
+                break;
+            }
+
+            auto item = std::move(send_queue_.front());
+            send_queue_.pop();
+
+            if (!is_open()) {
+                fail_unsent(item, boost::asio::error::not_connected);
+                continue;
+            }
+
+            add_to_batch(*batch, std::move(item.first), std::move(item.second));
+        }
+
+        if (!batch->tags.empty()) {
+            flush_batch(std::move(batch));
+        }
+    }
+
+    /*
+     * Encodes a request to the end of a write batch, and registers it to be
+     * responded to
+     */
+    inline void add_to_batch(write_batch &            batch,
+                             std::shared_ptr<request> req,
+                             read_handler             cb) {
+        req->encode(batch.buf);
+
+        // The handler is registered before writing, so that a response which
+        // is read before the write completion is handled can never be missed
+        auto tag = req->tag();
+        read_cbs_.emplace(std::make_pair(tag, std::move(cb)));
+        batch.tags.push_back(tag);
+
+        if (const auto &flow = req->flow_control()) {
+            add_flow(tag, flow);
+        }
+
+        if (counts_in_window(*req)) {
+            window_.emplace(tag, std::chrono::steady_clock::now());
+        } else if (probe_tag_ == tag) {
+            probe_sent_at_ = std::chrono::steady_clock::now();
+        }
+
+        // Kept to be sent again if the connection is lost
+        if (reconnect_policy_.has_value()) {
+            sent_.emplace(tag, std::move(req));
+        }
+    }
+
+    inline void flush_batch(std::shared_ptr<write_batch> batch) {
+        writing_ = true;
+
+        boost::asio::async_write(
+            sock_, boost::asio::buffer(batch->buf),
+            boost::asio::bind_executor(
+                strand_,
+                [self = this->shared_from_this(), batch,
+                 generation = generation_](const auto &err,
+                                           const auto &sent) mutable {
+                    // The connection was closed while writing, and possibly
+                    // reopened since
+                    if (generation != self->generation_) {
+                        if (!self->is_open() && !self->reconnecting_) {
+                            self->fail_batch(*batch,
+                                             boost::asio::error::not_connected);
+                        }
+
+                        return;
+                    }
+
+                    self->writing_ = false;
+
+                    if (!self->is_open()) {
+                        self->fail_batch(*batch,
+                                         boost::asio::error::not_connected);
+                        return;
+                    }
+
+                    if (err) {
+                        if (self->reconnect_policy_.has_value()) {
+                            return self->on_error(err);
+                        }
+
+                        self->close();
+                        self->fail_batch(*batch, err);
+                    }
+
+                    if (!self->send_queue_.empty()) {
+                        self->send_next();
+                    }
+                }));
+    }
+
+    inline void fail_batch(const write_batch &               batch,
+                           const boost::system::error_code &err) {
+        for (auto tag : batch.tags) {
+            fail_request(tag, err);
+        }
+    }
+
+    inline void fail_request(std::uint32_t                    tag,
+                             const boost::system::error_code &err) {
+        if (auto itr = read_cbs_.find(tag); itr != read_cbs_.end()) {
+            auto cb = std::move(itr->second);
+            read_cbs_.erase(itr);
+            sent_.erase(tag);
+            remove_deadline(tag);
+            release_window(tag, err);
+
+            // Reading may have been paused by the flow of this very request,
+            // and is resumed once no other flow is exhausted
+            if (flows_.erase(tag) > 0 && paused_work_.has_value()) {
+                boost::asio::post(strand_, [self = this->shared_from_this()]() {
+                    self->resume_reading();
+                });
+            }
+
+            cb(err, {});
+        }
+    }
+
+    /*
+     * Hands the buffered sentences to their handlers, then reads more data
+     * once they are all handled. A turn which runs out of read budget posts
+     * the rest of its work to the strand instead, behind the handlers of the
+     * other connections which are ready by then
+     */
+    inline void read_next_response() {
+        if (!is_open()) {
+            return;
+        }
+
+        auto start      = std::chrono::steady_clock::now();
+        auto generation = generation_;
+
+        std::size_t sentences {0};
+        std::size_t bytes {0};
+
+        const auto end_turn = [&](bool yielded) {
+            if (sentences > 0) {
+                read_stats_.on_turn(sentences, bytes,
+                                    std::chrono::steady_clock::now() - start,
+                                    yielded);
+            }
+        };
+
+        while (true) {
+            if ((read_budget_.sentences > 0 &&
+                 sentences >= read_budget_.sentences) ||
+                (read_budget_.bytes > 0 && bytes >= read_budget_.bytes)) {
+                end_turn(true);
+                return boost::asio::post(
+                    strand_, [self = this->shared_from_this(), generation]() {
+                        if (generation == self->generation_) {
+                            self->read_next_response();
+                        }
+                    });
+            }
+
+            boost::system::error_code err {};
+            std::vector<std::string>  words {};
+
+            auto size = reader_.next(words, err);
+
+            if (!err && size > 0) {
+                auto resp = tikpp::detail::to_response(words, err);
+
+                if (!err) {
+                    ++sentences;
+                    bytes += size;
+
+                    if (!on_response(std::move(resp))) {
+                        return end_turn(false);
+                    }
+
+                    // A handler may have closed the connection
+                    if (generation != generation_ || !is_open()) {
+                        return end_turn(false);
+                    }
+
+                    continue;
+                }
+            }
+
+            end_turn(false);
+
+            if (err) {
+                return on_error(err);
+            }
+
+            break;
+        }
+
+        sock_.async_read_some(
+            reader_.prepare(),
+            boost::asio::bind_executor(
+                strand_, [self = this->shared_from_this(),
+                          generation](const auto &err, std::size_t size) {
+                    if (generation != self->generation_ || !self->is_open()) {
+                        return;
+                    }
+
+                    if (err) {
+                        return self->on_error(err);
+                    }
+
+                    self->reader_.commit(size);
+                    self->rearm_quick_ack();
+                    self->read_next_response();
+                }));
+    }
+
+    inline void apply_connection_options() {
+        if constexpr (tikpp::detail::has_tcp_lowest_layer_v<AsyncStream>) {
+            tikpp::apply_connection_options(sock_.lowest_layer(),
+                                            connection_options_);
+        }
+    }
+
+    /*
+     * The kernel leaves quick ACK mode on its own (e.g. when it sees the
+     * connection as interactive), so it is set again after each read
+     */
+    inline void rearm_quick_ack() {
+        if constexpr (tikpp::detail::has_tcp_lowest_layer_v<AsyncStream>) {
+            if (connection_options_.quick_ack) {
+                tikpp::detail::set_quick_ack(sock_.lowest_layer(), true);
+            }
+        }
+    }
+
+    /*
+     * Returns whether reading goes on, i.e. no flow ran out of credit
+     */
+    inline auto on_response(tikpp::response &&resp) -> bool {
+        auto tag = resp.tag().value();
+
+        if (health_check_.has_value()) {
+            last_read_ = std::chrono::steady_clock::now();
+
+            if (breaker_->state() == tikpp::circuit_state::closed) {
+                breaker_->on_success();
+            }
+        }
+
+        if (auto itr = read_cbs_.find(tag); itr != read_cbs_.end()) {
+            if (!itr->second({}, std::move(resp))) {
+                read_cbs_.erase(itr);
+                flows_.erase(tag);
+                sent_.erase(tag);
+                remove_deadline(tag);
+                release_window(tag, {});
+            } else if (auto flow = flows_.find(tag);
+                       flow != flows_.end() && !flow->second->consume()) {
+                // Keeps the IO context running while no read is pending
+                paused_work_.emplace(sock_.get_executor());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    inline void add_flow(std::uint32_t                        tag,
+                         std::shared_ptr<tikpp::flow_control> flow) {
+        flow->on_resume([weak = this->weak_from_this()]() {
+            if (auto self = weak.lock()) {
+                boost::asio::post(self->strand_,
+                                  [self]() { self->resume_reading(); });
+            }
+        });
+
+        flows_.emplace(tag, std::move(flow));
+    }
+
+    inline void resume_reading() {
+        if (!paused_work_.has_value() ||
+            std::any_of(flows_.begin(), flows_.end(), [](const auto &flow) {
+                return flow.second->is_exhausted();
+            })) {
+            return;
+        }
+
+        paused_work_.reset();
+        read_next_response();
+    }
+
+    static inline auto is_long_lived(const tikpp::request &req) -> bool {
+        return boost::algorithm::ends_with(req.command(), "/listen");
+    }
+
+    static inline auto is_login(const tikpp::request &req) -> bool {
+        return req.command() == tikpp::commands::v2::login::command;
+    }
+
+    inline auto counts_in_window(const tikpp::request &req) const -> bool {
+        return req.command() != tikpp::commands::cancel::command &&
+               !is_long_lived(req) && probe_tag_ != req.tag();
+    }
+
+    /*
+     * Whether a request is failed at once rather than queued, because the
+     * circuit breaker is not closed. The requests which keep the connection
+     * going (logins, cancellations and probes) are let through
+     */
+    inline auto is_shed(const tikpp::request &req) const -> bool {
+        return !is_healthy() && !is_login(req) &&
+               req.command() != tikpp::commands::cancel::command &&
+               probe_tag_ != req.tag();
+    }
+
+    inline auto is_window_full() const -> bool {
+        auto limit = max_in_flight_ != 0
+                         ? max_in_flight_
+                         : std::numeric_limits<std::size_t>::max();
+
+        if (limiter_ != nullptr) {
+            limit = std::min(limit, limiter_->limit());
+        }
+
+        return window_.size() >= limit;
+    }
+
+    /*
+     * Frees the window slot of a completed request, feeding its latency (or
+     * its timing out) to the concurrency limiter, and sends the next queued
+     * request if it was held back
+     */
+    inline void release_window(std::uint32_t                    tag,
+                               const boost::system::error_code &err) {
+        auto itr = window_.find(tag);
+
+        if (itr == window_.end()) {
+            return;
+        }
+
+        if (limiter_ != nullptr) {
+            if (err == boost::asio::error::timed_out) {
+                limiter_->on_drop();
+            } else if (!err) {
+                limiter_->on_sample(std::chrono::steady_clock::now() -
+                                    itr->second);
+            }
+        }
+
+        window_.erase(itr);
+
+        if (!writing_ && !send_queue_.empty()) {
+            send_next();
+        }
+    }
+
+    inline auto current_tick() const -> std::uint64_t {
+        return (std::chrono::steady_clock::now() - epoch_) / timer_resolution;
+    }
+
+    inline void add_deadline(std::uint32_t             tag,
+                             std::chrono::milliseconds timeout,
+                             bool                      cancel) {
+        // Rounded up, so a request never times out early
+        auto tick = (std::chrono::steady_clock::now() - epoch_ + timeout) /
+                        timer_resolution +
+                    1;
+
+        // The wheel is not advanced while it is empty (\see remove_deadline)
+        if (deadlines_.empty()) {
+            deadlines_.reset(current_tick());
+        }
+
+        deadline_handles_.emplace(
+            tag, deadlines_.schedule(tick, deadline {tag, cancel}));
+        arm_timer();
+    }
+
+    /*
+     * Drops the deadlines of the requests which were written to a closed
+     * connection, while those still waiting to be written keep theirs
+     */
+    inline void drop_written_deadlines() {
+        for (const auto &entry : read_cbs_) {
+            remove_deadline(entry.first);
+        }
+    }
+
+    inline void remove_deadline(std::uint32_t tag) {
+        if (auto itr = deadline_handles_.find(tag);
+            itr != deadline_handles_.end()) {
+            deadlines_.cancel(itr->second);
+            deadline_handles_.erase(itr);
+
+            // Lets the IO context run out of work once nothing can time out
+            if (deadlines_.empty()) {
+                timer_.cancel();
+            }
+        }
+    }
+
+    inline void arm_timer() {
+        if (timer_armed_ || deadlines_.empty()) {
+            return;
+        }
+
+        timer_armed_ = true;
+        timer_.expires_after(timer_resolution);
+        timer_.async_wait(boost::asio::bind_executor(
+            strand_, [self = this->shared_from_this()](const auto &err) {
+                self->on_tick(err);
+            }));
+    }
+
+    /*
+     * Also ticks while the connection is closed, since the requests waiting
+     * for it to be opened or reconnected may time out meanwhile
+     */
+    inline void on_tick(const boost::system::error_code &err) {
+        timer_armed_ = false;
+
+        if (!err) {
+            std::vector<deadline> expired {};
+            deadlines_.advance(current_tick(), [&expired](auto &&d) {
+                expired.emplace_back(std::move(d));
+            });
+
+            for (const auto &d : expired) {
+                on_timeout(d);
+            }
+        }
+
+        arm_timer();
+    }
+
+    inline void on_timeout(const deadline &d) {
+        deadline_handles_.erase(d.tag);
+
+        // A timed out probe is counted by its own handler
+        if (breaker_.has_value() && probe_tag_ != d.tag) {
+            on_health_failure();
+        }
+
+        abort_request(d.tag, boost::asio::error::timed_out, d.cancel);
+    }
+
+    inline void start_probing() {
+        if (!health_check_.has_value()) {
+            return;
+        }
+
+        last_read_ = std::chrono::steady_clock::now();
+        arm_probe_timer(health_check_->interval);
+    }
+
+    /*
+     * Rearming the timer aborts its pending wait, whose handler is then
+     * ignored
+     */
+    inline void arm_probe_timer(std::chrono::steady_clock::duration after) {
+        probe_timer_.expires_after(after);
+        probe_timer_.async_wait(boost::asio::bind_executor(
+            strand_, [self       = this->shared_from_this(),
+                      generation = generation_](const auto &err) {
+                if (!err && generation == self->generation_ &&
+                    self->is_open()) {
+                    self->on_probe_timer();
+                }
+            }));
+    }
+
+    /*
+     * Sends a probe once the connection has read nothing for a whole
+     * interval, or once the circuit breaker can go half open
+     */
+    inline void on_probe_timer() {
+        auto now   = std::chrono::steady_clock::now();
+        auto after = std::chrono::steady_clock::duration {
+            health_check_->interval};
+
+        if (probe_tag_.has_value()) {
+            return arm_probe_timer(after);
+        }
+
+        if (breaker_->state() == tikpp::circuit_state::open) {
+            if (breaker_->try_half_open(now)) {
+                send_probe();
+            } else {
+                after = breaker_->reopens_at() - now;
+            }
+        } else if (auto idle = now - last_read_;
+                   idle >= health_check_->interval) {
+            send_probe();
+        } else {
+            after -= idle;
+        }
+
+        arm_probe_timer(after);
+    }
+
+    inline void send_probe() {
+        auto req = make_request(health_check_->command);
+        req->timeout(health_check_->timeout);
+        req->priority(tikpp::request_priority::high);
+
+        // A probe written to a lost connection is not sent again
+        req->idempotent(false);
+
+        probe_tag_ = req->tag();
+
+        async_send(std::move(req),
+                   [self = this->shared_from_this(),
+                    generation = generation_](const auto &err, auto &&resp) {
+                       if (!err && resp.type() == tikpp::response_type::data) {
+                           return true;
+                       }
+
+                       if (generation == self->generation_) {
+                           self->on_probe_result(err ? err : resp.error());
+                       }
+
+                       return false;
+                   });
+    }
+
+    inline void on_probe_result(const boost::system::error_code &err) {
+        probe_tag_.reset();
+
+        if (err) {
+            return on_health_failure();
+        }
+
+        rtt_.on_sample(std::chrono::steady_clock::now() - probe_sent_at_);
+        breaker_->on_success();
+    }
+
+    /*
+     * Counts a failed probe or a timed out request, and fails the queued
+     * requests if it opened the circuit breaker
+     */
+    inline void on_health_failure() {
+        if (!breaker_->on_failure()) {
+            return;
+        }
+
+        move_submitted(std::numeric_limits<std::size_t>::max());
+
+        while (auto item = send_queue_.extract_if([this](const auto &item) {
+                   return is_shed(*item.first);
+               })) {
+            fail_unsent(*item, tikpp::error_code::router_unhealthy);
+        }
+
+        arm_probe_timer(breaker_->reopens_at() -
+                        std::chrono::steady_clock::now());
+    }
+
+    /*
+     * Fails a request which is either waiting to be written, or waiting for
+     * its responses, in which case it may also be cancelled on the router
+     */
+    inline void abort_request(std::uint32_t                    tag,
+                              const boost::system::error_code &err,
+                              bool                             notify_router) {
+        move_submitted(std::numeric_limits<std::size_t>::max());
+
+        if (auto item = send_queue_.extract_if(
+                [tag](const auto &item) { return item.first->tag() == tag; })) {
+            fail_unsent(*item, err);
+            return;
+        }
+
+        if (read_cbs_.find(tag) == read_cbs_.end()) {
+            return;
+        }
+
+        if (notify_router && is_open()) {
+            async_send(make_request<tikpp::commands::cancel>(tag),
+                       [](const auto &, auto &&) { return false; });
+        }
+
+        fail_request(tag, err);
+    }
+
+    inline void on_error(const boost::system::error_code &err) {
+        if (reconnect_policy_.has_value()) {
+            close_socket();
+            return begin_reconnect(err);
+        }
+
+        close();
+        error_handler_(err);
+    }
+
+    inline void close_socket() {
+        sock_.close();
+        state_.store(api_state::closed);
+        logged_in_.store(false);
+        writing_ = false;
+        paused_work_.reset();
+        reader_.clear();
+        ++generation_;
+
+        window_.clear();
+
+        probe_timer_.cancel();
+        probe_tag_.reset();
+    }
+
+    /*
+     * Sorts out the requests which were written to the lost connection, then
+     * (re)starts reopening it. Requests which are sent again are put back
+     * ahead of the queued ones, in the order they were written
+     */
+    inline void begin_reconnect(const boost::system::error_code &err) {
+        std::vector<queued_request> resent {};
+        std::vector<read_handler>   failed {};
+
+        for (auto &[tag, cb] : read_cbs_) {
+            auto itr = sent_.find(tag);
+
+            if (itr != sent_.end() &&
+                (is_long_lived(*itr->second) ||
+                 (reconnect_policy_->retry_idempotent &&
+                  itr->second->idempotent()))) {
+                resent.emplace_back(std::move(itr->second), std::move(cb));
+            } else {
+                remove_deadline(tag);
+                failed.emplace_back(std::move(cb));
+            }
+        }
+
+        read_cbs_.clear();
+        flows_.clear();
+        sent_.clear();
+
+        std::sort(resent.begin(), resent.end(),
+                  [](const auto &lhs, const auto &rhs) {
+                      return lhs.first->tag() > rhs.first->tag();
+                  });
+
+        for (auto &item : resent) {
+            auto lane = static_cast<std::size_t>(item.first->priority());
+            send_queue_.push_front(lane, std::move(item));
+        }
+
+        if (!reconnecting_) {
+            reconnecting_       = true;
+            reconnect_attempts_ = 0;
+        }
+
+        for (auto &cb : failed) {
+            cb(err, {});
+        }
+
+        schedule_reconnect(err);
+    }
+
+    inline void schedule_reconnect(const boost::system::error_code &err) {
+        if (!reconnecting_) {
+            return;
+        }
+
+        if (reconnect_policy_->max_attempts != 0 &&
+            reconnect_attempts_ >= reconnect_policy_->max_attempts) {
+            return give_up(err, true);
+        }
+
+        reconnect_timer_.expires_after(
+            reconnect_policy_->delay(reconnect_attempts_++, rng_));
+        reconnect_timer_.async_wait(boost::asio::bind_executor(
+            strand_, [self = this->shared_from_this()](const auto &err) {
+                if (!err && self->reconnecting_) {
+                    self->try_reconnect();
+                }
+            }));
+    }
+
+    inline void try_reconnect() {
+        state_.store(api_state::connecting);
+
+        tikpp::detail::operations::async_connect(
+            sock_, host_, port_, resolver_, dns_cache_,
+            boost::asio::bind_executor(
+                strand_, [self = this->shared_from_this()](const auto &err) {
+                    if (!self->reconnecting_) {
+                        return;
+                    }
+
+                    if (err) {
+                        self->state_.store(api_state::closed);
+
+                        if (self->sock_.is_open()) {
+                            self->sock_.close();
+                        }
+
+                        return self->schedule_reconnect(err);
+                    }
+
+                    self->state_.store(api_state::connected);
+                    self->apply_connection_options();
+                    self->start_probing();
+                    self->read_next_response();
+
+                    if (!self->credentials_.has_value()) {
+                        return self->resume();
+                    }
+
+                    // A login which fails because the connection is lost
+                    // again is handled by \ref on_error
+                    const auto &[name, password] = *self->credentials_;
+                    self->async_login(
+                        name, password,
+                        [self, generation = self->generation_](
+                            const auto &err) {
+                            if (!self->reconnecting_ ||
+                                generation != self->generation_) {
+                                return;
+                            }
+
+                            if (err) {
+                                self->close_socket();
+                                return self->schedule_reconnect(err);
+                            }
+
+                            self->resume();
+                        });
+                }));
+    }
+
+    inline void resume() {
+        reconnecting_       = false;
+        reconnect_attempts_ = 0;
+
+        if (!writing_ && !send_queue_.empty()) {
+            send_next();
+        }
+    }
+
+    /*
+     * Stops reconnecting, and fails the requests which were waiting for the
+     * connection to be resumed
+     */
+    inline void give_up(const boost::system::error_code &err,
+                        bool                             notify) {
+        reconnecting_ = false;
+        reconnect_timer_.cancel();
+        state_.store(api_state::closed);
+
+        fail_queued(err);
+
+        if (notify) {
+            error_handler_(err);
+        }
+    }
+
+    AsyncStream                           sock_;
+    executor_type                         strand_;
+    timer_type                            timer_;
+    std::chrono::steady_clock::time_point epoch_;
+    ErrorHandler                          error_handler_;
+
+    std::atomic<api_state>                state_;
+    std::shared_ptr<std::atomic_uint32_t> current_tag_;
+    std::atomic_bool                      logged_in_;
+    std::atomic_bool                      opening_ {false};
+
+    tikpp::detail::mpsc_queue<queued_request> submit_queue_;
+    std::atomic_bool                          drain_scheduled_ {false};
+    bool                                      writing_ {false};
+
+    tikpp::detail::lane_scheduler<queued_request, priority_weights.size()>
+                                                                  send_queue_;
+    std::map<std::uint32_t, read_handler>                         read_cbs_;
+    std::map<std::uint32_t, std::shared_ptr<tikpp::flow_control>> flows_;
+    std::optional<boost::asio::executor_work_guard<inner_executor_type>>
+        paused_work_;
+
+    std::chrono::milliseconds                  default_timeout_ {0};
+    tikpp::detail::timer_wheel<deadline>       deadlines_;
+    bool                                       timer_armed_ {false};
+    std::map<std::uint32_t,
+             typename tikpp::detail::timer_wheel<deadline>::handle>
+        deadline_handles_;
+
+    std::size_t                                 max_in_flight_ {0};
+    std::shared_ptr<tikpp::concurrency_limiter> limiter_;
+    std::map<std::uint32_t, std::chrono::steady_clock::time_point> window_;
+
+    std::optional<tikpp::reconnect_policy>             reconnect_policy_;
+    timer_type                                         reconnect_timer_;
+    std::minstd_rand                                   rng_;
+    std::size_t                                        reconnect_attempts_ {0};
+    bool                                               reconnecting_ {false};
+    std::size_t                                        generation_ {0};
+    std::string                                        host_;
+    std::uint16_t                                      port_ {0};
+    std::optional<std::pair<std::string, std::string>> credentials_;
+    std::map<std::uint32_t, std::shared_ptr<request>>  sent_;
+
+    tikpp::resolver                   resolver_;
+    std::shared_ptr<tikpp::dns_cache> dns_cache_ {tikpp::default_dns_cache()};
+
+    std::shared_ptr<tikpp::login_cache> login_cache_ {
+        tikpp::default_login_cache()};
+
+    tikpp::connection_options connection_options_ {};
+
+    std::optional<tikpp::health_check_policy> health_check_;
+    std::optional<tikpp::circuit_breaker>     breaker_;
+    tikpp::rtt_estimator                      rtt_;
+    timer_type                                probe_timer_;
+    std::optional<std::uint32_t>              probe_tag_;
+    std::chrono::steady_clock::time_point     probe_sent_at_;
+    std::chrono::steady_clock::time_point     last_read_;
+
+    tikpp::detail::sentence_reader reader_ {read_buffer_size};
+    tikpp::read_budget             read_budget_ {};
+    tikpp::read_stats              read_stats_ {};
+};
+
+//! A type-erased alias for \see basic_api struct
+template <typename AsyncStream>
+using basic_api_te =
+    basic_api<AsyncStream,
+              std::function<void(const boost::system::error_code &)>>;
+
+namespace detail {
+
+/*!
+ * \brief A wrapper class to enable the use of \see std::make_shared function
+ *        on \see basic_api struct
+ */
+template <typename AsyncStream, typename ErrorHandler>
+struct basic_api_creator : tikpp::basic_api<AsyncStream, ErrorHandler> {
+    template <typename... Arg>
+    basic_api_creator(Arg &&... args)
+        : tikpp::basic_api<AsyncStream, ErrorHandler> {
+              std::forward<Arg>(args)...} {
+    }
+};
+
+} // namespace detail
+
+/*!
+ * \brief Creates a new instance of \see basic_api struct
+ *
+ * \param [in] ctx     The execution context (e.g. \see tikpp::io_context) or
+ *                     the executor which the connection stream is created
+ *                     with
+ * \param [in] handler A callable object to be called on fatal errors
+ * \param [in] options The TCP options of the connection socket
+ *
+ * \return The create \see basic_api instance
+ */
+template <typename AsyncStream, typename ErrorHandler, typename Context>
+[[nodiscard]] inline auto
+make_basic_api(Context &&                ctx,
+               ErrorHandler &&           handler,
+               tikpp::connection_options options = {})
+    -> std::shared_ptr<tikpp::basic_api<AsyncStream, ErrorHandler>> {
+    auto api = std::make_shared<
+        tikpp::detail::basic_api_creator<AsyncStream, ErrorHandler>>(
+        std::forward<Context>(ctx), std::forward<ErrorHandler>(handler));
+
+    api->connection_options(std::move(options));
+    return api;
 }
 
 }; // namespace tikpp
@@ -0,0 +1,27 @@
+#ifndef TIKPP_COMMANDS_CANCEL_HPP
+#define TIKPP_COMMANDS_CANCEL_HPP
+
+#include "tikpp/request.hpp"
+
+#include <cstdint>
+
+namespace tikpp::commands {
+
+/*!
+ * \brief A request which makes the router stop executing another request. It
+ *        is sent ahead of the queued regular requests
+ */
+struct cancel : tikpp::request {
+    cancel(std::uint32_t tag, std::uint32_t cancelled_tag)
+        : request {command, tag} {
+        add_param(tag_param, cancelled_tag);
+        priority(tikpp::request_priority::high);
+    }
+
+    static constexpr auto command   = "/cancel";
+    static constexpr auto tag_param = "tag";
+};
+
+} // namespace tikpp::commands
+
+#endif
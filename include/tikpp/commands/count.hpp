@@ -0,0 +1,34 @@
+#ifndef TIKPP_COMMANDS_COUNT_HPP
+#define TIKPP_COMMANDS_COUNT_HPP
+
+#include "tikpp/request.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tikpp::commands {
+
+/*!
+ * \brief A `print' request which makes the router return only the number of
+ *        the matching items in the `ret' param of the `!done' response
+ */
+template <typename Model>
+struct count : tikpp::request {
+    count(std::uint32_t tag)
+        : request {std::string {Model::api_path} + command_suffix, tag} {
+        add_param(count_only_param, std::string {});
+    }
+
+    count(std::uint32_t tag, std::vector<std::string> q) : count(tag) {
+        query(std::move(q));
+    }
+
+    static constexpr auto command_suffix   = "/print";
+    static constexpr auto count_only_param = "count-only";
+    static constexpr auto result_param     = "ret";
+};
+
+} // namespace tikpp::commands
+
+#endif
@@ -30,6 +30,14 @@ struct getall : tikpp::request {
         query(std::move(q));
     }
 
+    getall(std::uint32_t                   tag,
+           std::vector<std::string>        q,
+           const std::vector<std::string> &proplist)
+        : request {std::string {Model::api_path} + command_suffix, tag} {
+        add_param(".proplist", boost::join(proplist, ","));
+        query(std::move(q));
+    }
+
     static constexpr auto command_suffix = "/getall";
 };
 
@@ -8,6 +8,17 @@ namespace tikpp::commands {
 
 namespace v1 {
 
+/*!
+ * \brief Asks the router for the challenge which \see login answers
+ */
+struct challenge final : tikpp::request {
+    explicit challenge(std::uint32_t tag) : request {command, tag} {
+        priority(tikpp::request_priority::high);
+    }
+
+    static constexpr auto command = "/login";
+};
+
 struct login final : tikpp::request {
     login(std::uint32_t      tag,
           const std::string &name,
@@ -18,6 +29,7 @@ struct login final : tikpp::request {
         add_param(
             password_param,
             fmt::format("00{}", tikpp::detail::hash_password(password, cha)));
+        priority(tikpp::request_priority::high);
     }
 
     static constexpr auto command         = "/login";
@@ -38,6 +50,7 @@ struct login : tikpp::request {
         : request {command, tag} {
         add_param(name_param, name);
         add_param(password_param, password);
+        priority(tikpp::request_priority::high);
     }
 
     static constexpr auto command        = "/login";
@@ -0,0 +1,151 @@
+#ifndef TIKPP_CONCURRENCY_LIMITER_HPP
+#define TIKPP_CONCURRENCY_LIMITER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+namespace tikpp {
+
+/*!
+ * \brief The options of \see concurrency_limiter
+ */
+struct concurrency_limiter_options {
+    //! The initial limit
+    std::size_t initial_limit {16};
+
+    //! The lowest limit which can be reached
+    std::size_t min_limit {1};
+
+    //! The highest limit which can be reached
+    std::size_t max_limit {1024};
+
+    //! The factor which the limit is scaled down by on congestion
+    double backoff {0.75};
+
+    //! How many times slower than the unloaded latency a response may be
+    //! before the router is considered congested
+    double tolerance {2.0};
+
+    //! The number of samples after which the unloaded latency is measured
+    //! again, so it follows changes in the network path
+    std::size_t min_latency_window {1000};
+};
+
+/*!
+ * \brief An adaptive limit of the requests which an API connection keeps in
+ *        flight, using additive-increase/multiplicative-decrease (AIMD)
+ *        driven by the observed response latency
+ *
+ * The lowest latency seen recently is taken as the latency of an unloaded
+ * router. While responses arrive within a tolerance of it, the limit grows
+ * by one request per window of completed requests. When they get slower (the
+ * router is queueing requests), or a request times out, the limit is scaled
+ * down, at most once per window so a single slow burst is not punished
+ * repeatedly.
+ *
+ * A limiter must only be used by a single connection, and is only updated
+ * from the connection strand. The current limit may be read from any thread.
+ */
+struct concurrency_limiter {
+    using options = tikpp::concurrency_limiter_options;
+
+    explicit concurrency_limiter(options opts = {}) : opts_ {opts} {
+        opts_.min_limit = std::max<std::size_t>(opts_.min_limit, 1);
+        opts_.max_limit = std::max(opts_.max_limit, opts_.min_limit);
+        limit_.store(std::clamp(opts_.initial_limit, opts_.min_limit,
+                                opts_.max_limit));
+    }
+
+    /*!
+     * \brief Gets the current limit. Safe to be called from any thread
+     */
+    [[nodiscard]] inline auto limit() const noexcept -> std::size_t {
+        return limit_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Updates the limit with the latency of a completed request
+     *
+     * \param [in] latency The time between sending the request and its
+     *                     completion
+     */
+    inline void on_sample(std::chrono::nanoseconds latency) {
+        period_min_ = std::min(period_min_, latency);
+
+        if (++period_samples_ >= opts_.min_latency_window ||
+            min_latency_ == std::chrono::nanoseconds::max()) {
+            min_latency_    = period_min_;
+            period_min_     = std::chrono::nanoseconds::max();
+            period_samples_ = 0;
+        }
+
+        ++since_change_;
+
+        if (latency.count() > min_latency_.count() * opts_.tolerance) {
+            decrease();
+            return;
+        }
+
+        // One more request per window of completed requests
+        auto current = limit();
+
+        if (++since_increase_ >= current && current < opts_.max_limit) {
+            since_increase_ = 0;
+            limit_.store(current + 1, std::memory_order_relaxed);
+        }
+    }
+
+    /*!
+     * \brief Updates the limit with a request which was dropped (i.e. timed
+     *        out), which is always taken as congestion
+     */
+    inline void on_drop() {
+        ++since_change_;
+        decrease();
+    }
+
+  private:
+    inline void decrease() {
+        auto current = limit();
+
+        if (since_change_ < current) {
+            return;
+        }
+
+        since_change_   = 0;
+        since_increase_ = 0;
+
+        auto scaled = static_cast<std::size_t>(static_cast<double>(current) *
+                                               opts_.backoff);
+        limit_.store(std::max(scaled, opts_.min_limit),
+                     std::memory_order_relaxed);
+    }
+
+    options                  opts_;
+    std::atomic_size_t       limit_ {0};
+    std::chrono::nanoseconds min_latency_ {std::chrono::nanoseconds::max()};
+    std::chrono::nanoseconds period_min_ {std::chrono::nanoseconds::max()};
+    std::size_t              period_samples_ {0};
+    std::size_t              since_change_ {0};
+    std::size_t              since_increase_ {0};
+};
+
+/*!
+ * \brief Creates a new concurrency limiter
+ *
+ * \param [in] opts The limiter options
+ *
+ * \return The created concurrency limiter
+ */
+[[nodiscard]] inline auto
+make_concurrency_limiter(concurrency_limiter::options opts = {})
+    -> std::shared_ptr<concurrency_limiter> {
+    return std::make_shared<concurrency_limiter>(opts);
+}
+
+} // namespace tikpp
+
+#endif
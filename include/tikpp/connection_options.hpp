@@ -0,0 +1,177 @@
+#ifndef TIKPP_CONNECTION_OPTIONS_HPP
+#define TIKPP_CONNECTION_OPTIONS_HPP
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/socket_base.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+
+namespace tikpp {
+
+/*!
+ * \brief The TCP options of API connections, which are set on their sockets
+ *        each time they are connected
+ *
+ * The defaults suit the small request and response sentences of the API:
+ * neither side waits for more data (Nagle's algorithm) or to acknowledge
+ * it (delayed ACKs) before sending, which would otherwise stall exchanges
+ * for up to 40 ms, and dead connections are found by TCP keepalive probes.
+ */
+struct connection_options {
+    //! Whether small writes are sent at once (`TCP_NODELAY')
+    bool no_delay {true};
+
+    //! Whether received data is acknowledged at once rather than with the
+    //! next write (`TCP_QUICKACK', Linux only). The kernel may turn it off
+    //! again, so it is set again after each read
+    bool quick_ack {true};
+
+    //! Whether idle connections are probed (`SO_KEEPALIVE')
+    bool keep_alive {true};
+
+    //! How long a connection is idle before being probed (`TCP_KEEPIDLE')
+    std::chrono::seconds keep_alive_idle {30};
+
+    //! The time between probes (`TCP_KEEPINTVL')
+    std::chrono::seconds keep_alive_interval {10};
+
+    //! The number of unanswered probes after which the connection is dropped
+    //! (`TCP_KEEPCNT')
+    int keep_alive_count {3};
+
+    //! The size of the socket receive buffer (`SO_RCVBUF'), or zero to keep
+    //! the system default (which lets Linux size it automatically)
+    int receive_buffer_size {0};
+
+    //! The size of the socket send buffer (`SO_SNDBUF'), or zero to keep the
+    //! system default
+    int send_buffer_size {0};
+};
+
+namespace detail {
+
+/*!
+ * \brief An integer socket option which Asio has no type for
+ */
+template <int Level, int Name>
+struct integer_option {
+    explicit integer_option(int value) noexcept : value_ {value} {
+    }
+
+    template <typename Protocol>
+    [[nodiscard]] inline auto level(const Protocol &) const noexcept -> int {
+        return Level;
+    }
+
+    template <typename Protocol>
+    [[nodiscard]] inline auto name(const Protocol &) const noexcept -> int {
+        return Name;
+    }
+
+    template <typename Protocol>
+    [[nodiscard]] inline auto data(const Protocol &) const noexcept
+        -> const int * {
+        return &value_;
+    }
+
+    template <typename Protocol>
+    [[nodiscard]] inline auto size(const Protocol &) const noexcept
+        -> std::size_t {
+        return sizeof(value_);
+    }
+
+  private:
+    int value_;
+};
+
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+#define TIKPP_HAS_KEEPALIVE_OPTIONS 1
+
+using tcp_keep_idle     = integer_option<IPPROTO_TCP, TCP_KEEPIDLE>;
+using tcp_keep_interval = integer_option<IPPROTO_TCP, TCP_KEEPINTVL>;
+using tcp_keep_count    = integer_option<IPPROTO_TCP, TCP_KEEPCNT>;
+#endif
+
+template <typename T, typename = void>
+struct has_tcp_lowest_layer : std::false_type {};
+
+template <typename T>
+struct has_tcp_lowest_layer<
+    T,
+    std::void_t<decltype(std::declval<T &>().lowest_layer().set_option(
+        boost::asio::ip::tcp::no_delay {}))>> : std::true_type {};
+
+//! Whether the lowest layer of a stream is a TCP socket, which connection
+//! options can be set on
+template <typename T>
+constexpr auto has_tcp_lowest_layer_v = has_tcp_lowest_layer<T>::value;
+
+/*!
+ * \brief Sets `TCP_QUICKACK' on a socket, if the platform has it
+ */
+template <typename Socket>
+inline void set_quick_ack(Socket &sock, bool enabled) {
+#ifdef TCP_QUICKACK
+    boost::system::error_code ec {};
+    sock.set_option(integer_option<IPPROTO_TCP, TCP_QUICKACK> {enabled}, ec);
+#else
+    (void)sock;
+    (void)enabled;
+#endif
+}
+
+} // namespace detail
+
+/*!
+ * \brief Sets connection options on a connected TCP socket. Each option is
+ *        set on a best effort basis, so one which the platform does not
+ *        support is skipped
+ *
+ * \param [in,out] sock    The socket
+ * \param [in]     options The connection options
+ */
+template <typename Socket>
+inline void apply_connection_options(Socket &                  sock,
+                                     const connection_options &options) {
+    using boost::asio::socket_base;
+
+    boost::system::error_code ec {};
+
+    sock.set_option(boost::asio::ip::tcp::no_delay {options.no_delay}, ec);
+    sock.set_option(socket_base::keep_alive {options.keep_alive}, ec);
+
+#ifdef TIKPP_HAS_KEEPALIVE_OPTIONS
+    if (options.keep_alive) {
+        auto idle     = static_cast<int>(options.keep_alive_idle.count());
+        auto interval = static_cast<int>(options.keep_alive_interval.count());
+        auto count    = options.keep_alive_count;
+
+        sock.set_option(tikpp::detail::tcp_keep_idle {idle}, ec);
+        sock.set_option(tikpp::detail::tcp_keep_interval {interval}, ec);
+        sock.set_option(tikpp::detail::tcp_keep_count {count}, ec);
+    }
+#endif
+
+    if (options.receive_buffer_size > 0) {
+        sock.set_option(
+            socket_base::receive_buffer_size {options.receive_buffer_size},
+            ec);
+    }
+
+    if (options.send_buffer_size > 0) {
+        sock.set_option(
+            socket_base::send_buffer_size {options.send_buffer_size}, ec);
+    }
+
+    tikpp::detail::set_quick_ack(sock, options.quick_ack);
+}
+
+} // namespace tikpp
+
+#endif
@@ -0,0 +1,807 @@
+#ifndef TIKPP_CONNECTION_POOL_HPP
+#define TIKPP_CONNECTION_POOL_HPP
+
+#include "tikpp/basic_api.hpp"
+#include "tikpp/connection_options.hpp"
+#include "tikpp/detail/async_result.hpp"
+#include "tikpp/detail/cancellation.hpp"
+#include "tikpp/detail/latency_window.hpp"
+#include "tikpp/hedging_policy.hpp"
+#include "tikpp/request.hpp"
+#include "tikpp/response.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tikpp {
+
+/*!
+ * \brief A pool of API connections (sessions) to the same router
+ *
+ * Since the router serves each API session on one thread, spreading the
+ * requests over multiple sessions allows heavy workloads to use more router
+ * CPU cores. Each request is sent over the session with the fewest in-flight
+ * requests, while long-lived requests (i.e. `listen' commands) are sent over
+ * a separate set of pinned sessions, so they never slow down short requests.
+ *
+ * All the sessions share the same tag space, so the pool can be used in place
+ * of a single API connection (e.g. by \see tikpp::data::repository).
+ *
+ * Idempotent reads may also be hedged (\see tikpp::hedging_policy).
+ *
+ * \tparam Api The type of the pooled API connections (\see basic_api)
+ */
+template <typename Api>
+struct connection_pool : std::enable_shared_from_this<connection_pool<Api>> {
+    using api_type = Api;
+    using api_ptr  = std::shared_ptr<Api>;
+
+    /*!
+     * \brief Creates a pool out of closed API connections
+     *
+     * \param [in] sessions The API connections to be pooled
+     * \param [in] pinned   The number of sessions reserved for long-lived
+     *                      requests. If zero, long-lived requests are sent
+     *                      over the shared sessions
+     */
+    connection_pool(std::vector<api_ptr> sessions, std::size_t pinned)
+        : sessions_ {std::move(sessions)},
+          pinned_ {pinned},
+          in_flight_(sessions_.size(), 0),
+          current_tag_ {std::make_shared<std::atomic_uint32_t>(0)} {
+        assert(!sessions_.empty());
+        assert(pinned_ < sessions_.size());
+
+        for (const auto &session : sessions_) {
+            session->tag_counter(current_tag_);
+        }
+    }
+
+    /*!
+     * \brief Asynchronously opens all the pooled connections
+     *
+     * \param [in]     host  The router host address
+     * \param [in]     port  The API listening port
+     * \param [in,out] token The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    decltype(auto) async_open(const std::string &host,
+                              std::uint16_t      port,
+                              CompletionToken && token) {
+        GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
+                                    token, handler, result);
+
+        open_sessions(std::move(handler),
+                      [&host, port](auto &session, auto &&cb) {
+                          session->async_open(host, port, std::move(cb));
+                      });
+
+        return result.get();
+    }
+
+    /*!
+     * \brief Asynchronously opens all the pooled connections, then logs in
+     *        to the router using each one of them
+     *
+     * If any of the connections fails, the first error is reported, and the
+     * remaining connections are kept open.
+     *
+     * \param [in]     host     The router host address
+     * \param [in]     port     The API listening port
+     * \param [in]     name     The name used to login
+     * \param [in]     password The password used to login
+     * \param [in,out] token    The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    decltype(auto) async_open(const std::string &host,
+                              std::uint16_t      port,
+                              const std::string &name,
+                              const std::string &password,
+                              CompletionToken && token) {
+        GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
+                                    token, handler, result);
+
+        open_sessions(std::move(handler), [&host, port, &name, &password](
+                                              auto &session, auto &&cb) {
+            session->async_open(host, port, name, password, std::move(cb));
+        });
+
+        return result.get();
+    }
+
+    //! \brief Closes all the opened pooled connections
+    inline void close() {
+        for (auto &session : sessions_) {
+            if (session->is_open()) {
+                session->close();
+            }
+        }
+    }
+
+    /*!
+     * \brief Creates a request from a command request type, with a tag which
+     *        is unique across all the pooled connections
+     *
+     * \param [in] args The arguments used to construct the command request
+     *
+     * \return The created command request
+     */
+    template <
+        typename Command,
+        typename... Args,
+        typename = std::enable_if_t<std::is_base_of_v<tikpp::request, Command>>>
+    [[nodiscard]] inline auto make_request(Args &&... args)
+        -> std::shared_ptr<tikpp::request> {
+        return std::make_shared<Command>(aquire_unique_tag(),
+                                         std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Creates a request from a command string, with a tag which is
+     *        unique across all the pooled connections
+     *
+     * \param [in] command The command string to be used to construct the
+     *                     request
+     *
+     * \return The created request
+     */
+    [[nodiscard]] inline auto make_request(std::string command)
+        -> std::shared_ptr<tikpp::request> {
+        return std::make_shared<tikpp::request>(std::move(command),
+                                                aquire_unique_tag());
+    }
+
+    /*!
+     * \brief Asynchronously sends a request to the router over the least
+     *        loaded session. Safe to be called from any thread
+     *
+     * \param [in]      req   The request to be sent
+     * \param [in, out] token The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    decltype(auto) async_send(std::shared_ptr<request> req,
+                              CompletionToken &&       token) {
+        assert(req != nullptr);
+
+        GENERATE_COMPLETION_HANDLER(
+            void(const boost::system::error_code &, tikpp::response &&), token,
+            handler, result);
+
+        auto slot = tikpp::detail::cancellation_slot_of(handler);
+
+        if (is_hedgeable(*req)) {
+            send_hedged(std::move(req), std::move(handler), slot);
+            return result.get();
+        }
+
+        auto tag     = req->tag();
+        auto session = dispatch(tag, is_long_lived(*req));
+
+        sessions_[session]->async_send(
+            std::move(req),
+            tikpp::detail::bind_cancellation_slot(
+                slot, [self = this->shared_from_this(), session, tag,
+                       handler {std::move(handler)}](const auto &err,
+                                                     auto &&resp) mutable {
+                    bool keep = handler(err, std::move(resp));
+
+                    if (err || !keep) {
+                        self->release(session, tag);
+                    }
+
+                    return keep;
+                }));
+
+        return result.get();
+    }
+
+    /*!
+     * \brief Cancels a request on the session which it was sent over
+     *        (\see basic_api::cancel), along with its hedge if it was hedged.
+     *        Safe to be called from any thread
+     *
+     * \param [in] tag The tag of the request to be cancelled
+     */
+    inline void cancel(std::uint32_t tag) {
+        if (auto session = owner(tag); session < sessions_.size()) {
+            sessions_[session]->cancel(tag);
+        }
+
+        if (auto hedge = hedge_of(tag); hedge.has_value()) {
+            if (auto session = owner(*hedge); session < sessions_.size()) {
+                sessions_[session]->cancel(*hedge);
+            }
+        }
+    }
+
+    /*!
+     * \brief Asynchronously asks the router to stop executing a request, using
+     *        the session which the request was sent over
+     *
+     * \param [in]      tag   The tag of the request to be cancelled
+     * \param [in, out] token The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    decltype(auto) async_cancel(std::uint32_t tag, CompletionToken &&token) {
+        GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
+                                    token, handler, result);
+
+        if (auto session = owner(tag); session < sessions_.size()) {
+            sessions_[session]->async_cancel(tag, std::move(handler));
+        } else {
+            auto ex = boost::asio::get_associated_executor(
+                handler, sessions_.front()->get_executor());
+            boost::asio::post(ex, [handler {std::move(handler)}]() mutable {
+                handler(boost::asio::error::make_error_code(
+                    boost::asio::error::not_found));
+            });
+        }
+
+        return result.get();
+    }
+
+    [[nodiscard]] inline auto hedging() const noexcept
+        -> const std::optional<tikpp::hedging_policy> & {
+        return hedging_;
+    }
+
+    /*!
+     * \brief Enables hedging the idempotent reads which are sent over the
+     *        shared sessions (\see tikpp::hedging_policy), which needs at
+     *        least two of them. Must be set before sending any requests
+     *
+     * \param [in] policy The hedging policy, or none to disable it
+     */
+    inline void hedging(std::optional<tikpp::hedging_policy> policy) {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        hedging_ = std::move(policy);
+        latencies_.reset();
+        hedge_delay_.store(0);
+        since_refresh_  = 0;
+        budgeted_reads_ = reads_.load();
+
+        if (hedging_.has_value()) {
+            latencies_.emplace(std::max<std::size_t>(hedging_->window, 1));
+            hedge_credit_ = hedging_->max_burst;
+        }
+    }
+
+    /*!
+     * \brief Gets how long a read waits for its first response before it is
+     *        hedged, which is zero until enough latencies were observed.
+     *        Safe to be called from any thread
+     */
+    [[nodiscard]] inline auto hedge_delay() const noexcept
+        -> std::chrono::nanoseconds {
+        return std::chrono::nanoseconds {hedge_delay_.load()};
+    }
+
+    /*!
+     * \brief Gets how many reads were hedged, and how many of the hedges
+     *        responded first. Safe to be called from any thread
+     */
+    [[nodiscard]] inline auto hedging_stats() const noexcept
+        -> tikpp::hedging_stats {
+        return {reads_.load(), hedged_.load(), won_.load()};
+    }
+
+    /*!
+     * \brief Gets whether a request is long-lived (i.e. a `listen' command),
+     *        and thus should be sent over a pinned session
+     */
+    [[nodiscard]] static inline auto is_long_lived(const tikpp::request &req)
+        -> bool {
+        return boost::algorithm::ends_with(req.command(), "/listen");
+    }
+
+    /*!
+     * \brief Gets the current request tag that the next request will have
+     *
+     * \return The next request tag
+     */
+    [[nodiscard]] inline auto current_tag() const noexcept -> std::uint32_t {
+        return current_tag_->load();
+    }
+
+    /*!
+     * \brief Gets a tag which is unique across all the pooled connections
+     *
+     * \return A unique request tag
+     */
+    [[nodiscard]] inline auto aquire_unique_tag() noexcept -> std::uint32_t {
+        return current_tag_->fetch_add(1);
+    }
+
+    /*!
+     * \brief Gets whether any of the pooled connections is open or not
+     */
+    [[nodiscard]] inline auto is_open() const noexcept -> bool {
+        for (const auto &session : sessions_) {
+            if (session->is_open()) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /*!
+     * \brief Gets the number of pooled connections
+     */
+    [[nodiscard]] inline auto size() const noexcept -> std::size_t {
+        return sessions_.size();
+    }
+
+    /*!
+     * \brief Gets the number of sessions reserved for long-lived requests
+     */
+    [[nodiscard]] inline auto pinned() const noexcept -> std::size_t {
+        return pinned_;
+    }
+
+    /*!
+     * \brief Gets a pooled connection
+     *
+     * \param [in] index The index of the connection, where the pinned
+     *                   sessions come first
+     */
+    [[nodiscard]] inline auto session(std::size_t index) const -> const
+        api_ptr & {
+        return sessions_.at(index);
+    }
+
+    /*!
+     * \brief Gets the number of requests which were sent over a pooled
+     *        connection, and did not complete yet
+     */
+    [[nodiscard]] inline auto in_flight(std::size_t index) const
+        -> std::size_t {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return in_flight_.at(index);
+    }
+
+  private:
+    using clock        = std::chrono::steady_clock;
+    using read_handler = typename Api::read_handler;
+
+    /*!
+     * \brief The number of observed latencies after which the hedge delay is
+     *        taken again
+     */
+    static constexpr std::size_t hedge_delay_refresh = 16;
+
+    /*
+     * The two attempts of a hedged read, which respond on the strands of
+     * their sessions
+     */
+    struct hedge_state {
+        template <typename Executor>
+        hedge_state(std::shared_ptr<request> r,
+                    read_handler             h,
+                    const Executor &         ex)
+            : req {std::move(r)}, handler {std::move(h)}, timer {ex} {
+        }
+
+        std::mutex                       mutex;
+        std::shared_ptr<request>         req;
+        read_handler                     handler;
+        boost::asio::steady_timer        timer;
+        std::array<std::size_t, 2>       sessions {};
+        std::array<std::uint32_t, 2>     tags {};
+        std::array<clock::time_point, 2> sent_at {};
+        std::size_t                      attempts {1};
+        std::size_t                      failures {0};
+        std::optional<std::size_t>       winner;
+    };
+
+    inline auto is_hedgeable(const tikpp::request &req) const -> bool {
+        return hedging_.has_value() && sessions_.size() - pinned_ >= 2 &&
+               req.idempotent() && !is_long_lived(req) &&
+               req.flow_control() == nullptr;
+    }
+
+    template <typename Handler, typename Slot>
+    inline void send_hedged(std::shared_ptr<request> req,
+                            Handler &&               handler,
+                            Slot                     slot) {
+        auto tag     = req->tag();
+        auto session = dispatch(tag, false);
+        auto state   = std::make_shared<hedge_state>(
+            req, read_handler {std::forward<Handler>(handler)},
+            sessions_[session]->get_executor());
+
+        state->sessions[0] = session;
+        state->tags[0]     = tag;
+        state->sent_at[0]  = clock::now();
+
+        ++reads_;
+
+        if (auto delay = hedge_delay(); delay.count() > 0) {
+            state->timer.expires_after(delay);
+            state->timer.async_wait(
+                [self = this->shared_from_this(), state](const auto &err) {
+                    if (!err) {
+                        self->hedge(state);
+                    }
+                });
+        }
+
+        sessions_[session]->async_send(
+            std::move(req), tikpp::detail::bind_cancellation_slot(
+                                slot, attempt_handler(state, 0)));
+    }
+
+    inline auto attempt_handler(const std::shared_ptr<hedge_state> &state,
+                                std::size_t                         attempt) {
+        return [self = this->shared_from_this(), state,
+                attempt](const auto &err, auto &&resp) {
+            return self->on_attempt(*state, attempt, err, std::move(resp));
+        };
+    }
+
+    /*
+     * Sends a read which has not responded yet over another session, if the
+     * hedging budget allows it
+     */
+    inline void hedge(const std::shared_ptr<hedge_state> &state) {
+        std::shared_ptr<request> req {};
+        std::size_t              session {0};
+
+        {
+            std::lock_guard<std::mutex> lock {state->mutex};
+
+            if (state->winner.has_value()) {
+                return;
+            }
+
+            auto tag = aquire_unique_tag();
+            auto ret = dispatch_hedge(state->tags[0], tag, state->sessions[0]);
+
+            if (!ret.has_value()) {
+                return;
+            }
+
+            session = *ret;
+            req     = state->req->clone(tag);
+
+            state->sessions[1] = session;
+            state->tags[1]     = tag;
+            state->sent_at[1]  = clock::now();
+            state->attempts    = 2;
+        }
+
+        // The first attempt may have won meanwhile, in which case cancelling
+        // the hedge could not reach it, since it was not sent yet
+        {
+            std::lock_guard<std::mutex> lock {state->mutex};
+
+            if (state->winner.has_value()) {
+                release(session, req->tag());
+                return;
+            }
+        }
+
+        ++hedged_;
+        sessions_[session]->async_send(std::move(req),
+                                       attempt_handler(state, 1));
+    }
+
+    /*
+     * Takes the first attempt of a hedged read which responds, and cancels
+     * the other one. An attempt which fails while the other one may still
+     * respond is ignored, unless it was cancelled
+     */
+    inline auto on_attempt(hedge_state &                    state,
+                           std::size_t                      attempt,
+                           const boost::system::error_code &err,
+                           tikpp::response &&               resp) -> bool {
+        std::optional<std::size_t> loser {};
+        bool                       won {false}, is_winner {false};
+
+        {
+            std::lock_guard<std::mutex> lock {state.mutex};
+
+            if (!state.winner.has_value()) {
+                if (!err || err == boost::asio::error::operation_aborted ||
+                    ++state.failures >= state.attempts) {
+                    state.winner = attempt;
+                    won          = !err;
+                    state.timer.cancel();
+
+                    if (state.attempts == 2) {
+                        loser = 1 - attempt;
+                    }
+                }
+            }
+
+            is_winner = state.winner == attempt;
+        }
+
+        auto session = state.sessions[attempt];
+        auto tag     = state.tags[attempt];
+
+        if (won) {
+            // The latency which the caller saw, as sampling only the winning
+            // attempt would leave out the slow first attempts, and drag the
+            // hedge delay down
+            on_latency(clock::now() - state.sent_at[0]);
+
+            if (attempt == 1) {
+                ++won_;
+            }
+        }
+
+        if (loser.has_value()) {
+            forget_hedge(state.tags[0]);
+            sessions_[state.sessions[*loser]]->cancel(state.tags[*loser]);
+        }
+
+        // A losing attempt which still responds was not reached by its
+        // cancellation (e.g. it was sent right after it), so it is still
+        // running on the router
+        if (!is_winner && !err &&
+            resp.type() == tikpp::response_type::data) {
+            sessions_[session]->async_cancel(tag, [](const auto &) {});
+        }
+
+        // Once chosen, the winner is only responded to on its own strand
+        bool keep = is_winner && state.handler(err, std::move(resp));
+
+        if (err || !keep) {
+            release(session, tag);
+        }
+
+        return keep;
+    }
+
+    inline void on_latency(clock::duration latency) {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        if (!latencies_.has_value()) {
+            return;
+        }
+
+        latencies_->add(latency);
+
+        if (++since_refresh_ >= hedge_delay_refresh &&
+            latencies_->size() >= hedging_->min_samples) {
+            since_refresh_ = 0;
+
+            auto delay = std::max<clock::duration>(
+                latencies_->quantile(hedging_->quantile), hedging_->min_delay);
+            hedge_delay_.store(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(delay)
+                    .count());
+        }
+    }
+
+    template <typename Handler, typename Open>
+    inline void open_sessions(Handler &&handler, Open &&open) {
+        // The sessions complete on their own strands, which may run on
+        // different threads
+        struct open_state {
+            std::atomic_size_t                   remaining;
+            std::once_flag                       error_flag;
+            boost::system::error_code            error;
+            std::optional<std::decay_t<Handler>> handler;
+        };
+
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            std::fill(in_flight_.begin(), in_flight_.end(), 0);
+            owners_.clear();
+            hedges_.clear();
+        }
+
+        auto state = std::make_shared<open_state>();
+        state->remaining.store(sessions_.size());
+        state->handler.emplace(std::forward<Handler>(handler));
+
+        for (auto &session : sessions_) {
+            open(session, [state](const auto &err) {
+                if (err) {
+                    std::call_once(state->error_flag,
+                                   [&state, &err] { state->error = err; });
+                }
+
+                // The last completion happens after all the error stores
+                if (state->remaining.fetch_sub(1) == 1) {
+                    (*state->handler)(state->error);
+                }
+            });
+        }
+    }
+
+    inline auto dispatch(std::uint32_t tag, bool long_lived) -> std::size_t {
+        std::size_t first = pinned_, last = sessions_.size();
+
+        if (long_lived && pinned_ > 0) {
+            first = 0;
+            last  = pinned_;
+        }
+
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        auto ret = first;
+        bool ret_open {false};
+
+        for (auto i = first; i < last; ++i) {
+            // A session whose circuit breaker is open would fail the request
+            bool open = sessions_[i]->is_open() && sessions_[i]->is_healthy();
+
+            if ((open && !ret_open) ||
+                (open == ret_open && in_flight_[i] < in_flight_[ret])) {
+                ret      = i;
+                ret_open = open;
+            }
+        }
+
+        ++in_flight_[ret];
+        owners_[tag] = ret;
+
+        return ret;
+    }
+
+    /*
+     * Picks the least loaded shared session other than the one which a read
+     * was sent over, if there is an open and healthy one, and takes a hedge
+     * out of the budget
+     */
+    inline auto dispatch_hedge(std::uint32_t tag,
+                               std::uint32_t hedge_tag,
+                               std::size_t   exclude)
+        -> std::optional<std::size_t> {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        hedge_credit_ =
+            std::min(hedge_credit_ + hedging_->max_ratio *
+                                         static_cast<double>(reads_.load() -
+                                                             budgeted_reads_),
+                     hedging_->max_burst);
+        budgeted_reads_ = reads_.load();
+
+        if (hedge_credit_ < 1.0) {
+            return std::nullopt;
+        }
+
+        std::optional<std::size_t> ret {};
+
+        for (auto i = pinned_; i < sessions_.size(); ++i) {
+            if (i != exclude && sessions_[i]->is_open() &&
+                sessions_[i]->is_healthy() &&
+                (!ret.has_value() || in_flight_[i] < in_flight_[*ret])) {
+                ret = i;
+            }
+        }
+
+        if (ret.has_value()) {
+            hedge_credit_ -= 1.0;
+            ++in_flight_[*ret];
+            owners_[hedge_tag] = *ret;
+            hedges_[tag]       = hedge_tag;
+        }
+
+        return ret;
+    }
+
+    inline auto hedge_of(std::uint32_t tag) const
+        -> std::optional<std::uint32_t> {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        auto itr = hedges_.find(tag);
+        return itr == hedges_.end() ? std::nullopt
+                                    : std::make_optional(itr->second);
+    }
+
+    inline void forget_hedge(std::uint32_t tag) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        hedges_.erase(tag);
+    }
+
+    inline void release(std::size_t session, std::uint32_t tag) {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        if (in_flight_[session] > 0) {
+            --in_flight_[session];
+        }
+
+        owners_.erase(tag);
+    }
+
+    inline auto owner(std::uint32_t tag) const -> std::size_t {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        auto itr = owners_.find(tag);
+        return itr == owners_.end() ? sessions_.size() : itr->second;
+    }
+
+    std::vector<api_ptr> sessions_;
+    std::size_t          pinned_;
+
+    mutable std::mutex                    mutex_;
+    std::vector<std::size_t>              in_flight_;
+    std::map<std::uint32_t, std::size_t>  owners_;
+    std::shared_ptr<std::atomic_uint32_t> current_tag_;
+
+    std::optional<tikpp::hedging_policy>         hedging_;
+    std::optional<tikpp::detail::latency_window> latencies_;
+    std::map<std::uint32_t, std::uint32_t>       hedges_;
+    std::atomic<std::int64_t>                    hedge_delay_ {0};
+    std::size_t                                  since_refresh_ {0};
+    double                                       hedge_credit_ {0.0};
+    std::size_t                                  budgeted_reads_ {0};
+    std::atomic_size_t                           reads_ {0};
+    std::atomic_size_t                           hedged_ {0};
+    std::atomic_size_t                           won_ {0};
+};
+
+/*!
+ * \brief Creates a new pool of API connections
+ *
+ * \param [in] ctx     The execution context or the executor to be used by
+ *                     the API connections
+ * \param [in] size    The number of connections to be pooled
+ * \param [in] pinned  The number of connections reserved for long-lived
+ *                     requests
+ * \param [in] handler A callable object to be called on fatal errors, which
+ *                     is copied to each connection
+ * \param [in] options The TCP options of the connection sockets
+ *
+ * \return The created pool
+ */
+template <typename AsyncStream = boost::asio::ip::tcp::socket,
+          typename ErrorHandler,
+          typename Context>
+[[nodiscard]] inline auto
+make_connection_pool(Context &&                       ctx,
+                     std::size_t                      size,
+                     std::size_t                      pinned,
+                     ErrorHandler &&                  handler,
+                     const tikpp::connection_options &options = {}) {
+    using handler_type = std::decay_t<ErrorHandler>;
+    using api_type     = tikpp::basic_api<AsyncStream, handler_type>;
+
+    std::vector<std::shared_ptr<api_type>> sessions {};
+    sessions.reserve(size);
+
+    for (std::size_t i {0}; i < size; ++i) {
+        sessions.emplace_back(tikpp::make_basic_api<AsyncStream, handler_type>(
+            ctx, handler_type {handler}, options));
+    }
+
+    return std::make_shared<tikpp::connection_pool<api_type>>(
+        std::move(sessions), pinned);
+}
+
+} // namespace tikpp
+
+#endif
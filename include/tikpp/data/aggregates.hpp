@@ -0,0 +1,333 @@
+#ifndef TIKPP_DATA_AGGREGATES_HPP
+#define TIKPP_DATA_AGGREGATES_HPP
+
+#include "tikpp/detail/type_traits/macros.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tikpp::data::aggregates {
+
+namespace detail {
+
+HAS_MEMBER_FUNCTION(value, ())
+HAS_MEMBER_FUNCTION(is_done, ())
+
+/*!
+ * \brief Unwraps model field wrappers (e.g. `read_only<bytes>') down to their
+ *        underlying value
+ */
+template <typename T>
+inline decltype(auto) unwrap(const T &value) {
+    if constexpr (has_value_v<const T &>) {
+        return unwrap(value.value());
+    } else {
+        return (value);
+    }
+}
+
+template <typename Selector, typename Model>
+inline decltype(auto) select(const Selector &selector, const Model &item) {
+    return unwrap(std::invoke(selector, item));
+}
+
+template <typename Selector, typename Model>
+using selected_type = std::decay_t<decltype(
+    select(std::declval<const Selector &>(), std::declval<const Model &>()))>;
+
+} // namespace detail
+
+/*!
+ * \brief An aggregate which counts the items
+ */
+struct count {
+    template <typename Model>
+    inline void operator()([[maybe_unused]] const Model &item) noexcept {
+        ++count_;
+    }
+
+    [[nodiscard]] inline auto result() const noexcept -> std::size_t {
+        return count_;
+    }
+
+  private:
+    std::size_t count_ {0};
+};
+
+/*!
+ * \brief An aggregate which sums a field of the items
+ *
+ * \tparam Selector A member pointer to the field, or a callable object which
+ *                  accepts `const Model &'
+ */
+template <typename Model, typename Selector>
+struct sum {
+    using value_type = detail::selected_type<Selector, Model>;
+
+    explicit sum(Selector selector) : selector_ {std::move(selector)} {
+    }
+
+    inline void operator()(const Model &item) {
+        sum_ = sum_ + detail::select(selector_, item);
+    }
+
+    [[nodiscard]] inline auto result() const -> value_type {
+        return sum_;
+    }
+
+  private:
+    Selector   selector_;
+    value_type sum_ {};
+};
+
+/*!
+ * \brief An aggregate which finds the minimum or the maximum value of a field
+ *        of the items
+ *
+ * \tparam Compare The comparison used to select the result; `std::less' to
+ *                 find the minimum, and `std::greater' to find the maximum
+ */
+template <typename Model, typename Selector, typename Compare>
+struct extremum {
+    using value_type = detail::selected_type<Selector, Model>;
+
+    explicit extremum(Selector selector) : selector_ {std::move(selector)} {
+    }
+
+    inline void operator()(const Model &item) {
+        decltype(auto) value = detail::select(selector_, item);
+
+        if (!result_.has_value() || Compare {}(value, *result_)) {
+            result_.emplace(value);
+        }
+    }
+
+    /*!
+     * \brief Gets the aggregate result, which is empty if no items were seen
+     */
+    [[nodiscard]] inline auto result() const -> std::optional<value_type> {
+        return result_;
+    }
+
+  private:
+    Selector                  selector_;
+    std::optional<value_type> result_;
+};
+
+template <typename Model, typename Selector>
+using min = extremum<Model, Selector, std::less<>>;
+
+template <typename Model, typename Selector>
+using max = extremum<Model, Selector, std::greater<>>;
+
+/*!
+ * \brief An aggregate which groups the items by a field, and runs a separate
+ *        copy of an aggregate for each group
+ */
+template <typename Model, typename Selector, typename Aggregate>
+struct group_by {
+    using key_type    = detail::selected_type<Selector, Model>;
+    using result_type = std::map<
+        key_type,
+        std::decay_t<decltype(std::declval<const Aggregate &>().result())>>;
+
+    group_by(Selector selector, Aggregate aggregate)
+        : selector_ {std::move(selector)}, prototype_ {std::move(aggregate)} {
+    }
+
+    inline void operator()(const Model &item) {
+        auto itr = groups_.find(detail::select(selector_, item));
+
+        if (itr == groups_.end()) {
+            itr = groups_
+                      .emplace(key_type {detail::select(selector_, item)},
+                               prototype_)
+                      .first;
+        }
+
+        itr->second(item);
+    }
+
+    [[nodiscard]] inline auto result() const -> result_type {
+        result_type ret {};
+
+        for (const auto &[key, aggregate] : groups_) {
+            ret.emplace(key, aggregate.result());
+        }
+
+        return ret;
+    }
+
+  private:
+    Selector                                   selector_;
+    Aggregate                                  prototype_;
+    std::map<key_type, Aggregate, std::less<>> groups_;
+};
+
+/*!
+ * \brief An aggregate which keeps the K items with the largest (or smallest)
+ *        values of a field, using a bounded heap
+ *
+ * \tparam Compare `std::greater' to keep the largest values, and `std::less'
+ *                 to keep the smallest ones
+ */
+template <typename Model, typename Selector, typename Compare = std::greater<>>
+struct top_k {
+    explicit top_k(std::size_t k, Selector selector)
+        : k_ {k}, selector_ {std::move(selector)} {
+        heap_.reserve(k_);
+    }
+
+    inline void operator()(const Model &item) {
+        if (k_ == 0) {
+            return;
+        }
+
+        if (heap_.size() < k_) {
+            heap_.push_back(item);
+            std::push_heap(heap_.begin(), heap_.end(), heap_compare());
+        } else if (Compare {}(detail::select(selector_, item),
+                              detail::select(selector_, heap_.front()))) {
+            std::pop_heap(heap_.begin(), heap_.end(), heap_compare());
+            heap_.back() = item;
+            std::push_heap(heap_.begin(), heap_.end(), heap_compare());
+        }
+    }
+
+    /*!
+     * \brief Gets the kept items, ordered by \p Compare (i.e. the largest
+     *        first when using `std::greater')
+     */
+    [[nodiscard]] inline auto result() const -> std::vector<Model> {
+        auto ret = heap_;
+        std::sort_heap(ret.begin(), ret.end(), heap_compare());
+        return ret;
+    }
+
+  private:
+    // The heap front is the kept item which is the first to be replaced
+    inline auto heap_compare() const {
+        return [this](const Model &lhs, const Model &rhs) {
+            return Compare {}(detail::select(selector_, lhs),
+                              detail::select(selector_, rhs));
+        };
+    }
+
+    std::size_t        k_;
+    Selector           selector_;
+    std::vector<Model> heap_;
+};
+
+/*!
+ * \brief An aggregate which keeps a uniform random sample of the items, using
+ *        reservoir sampling
+ */
+template <typename Model>
+struct sample {
+    explicit sample(std::size_t   size,
+                    std::uint32_t seed = std::random_device {}())
+        : size_ {size}, rng_ {seed} {
+        reservoir_.reserve(size_);
+    }
+
+    inline void operator()(const Model &item) {
+        if (reservoir_.size() < size_) {
+            reservoir_.push_back(item);
+        } else if (auto idx = std::uniform_int_distribution<std::size_t> {
+                       0, seen_}(rng_);
+                   idx < size_) {
+            reservoir_[idx] = item;
+        }
+
+        ++seen_;
+    }
+
+    [[nodiscard]] inline auto result() const -> std::vector<Model> {
+        return reservoir_;
+    }
+
+  private:
+    std::size_t        size_;
+    std::size_t        seen_ {0};
+    std::mt19937       rng_;
+    std::vector<Model> reservoir_;
+};
+
+/*!
+ * \brief An aggregate which keeps the first N items, then stops the stream
+ */
+template <typename Model>
+struct take {
+    explicit take(std::size_t count) : count_ {count} {
+        items_.reserve(count_);
+    }
+
+    inline void operator()(const Model &item) {
+        if (!is_done()) {
+            items_.push_back(item);
+        }
+    }
+
+    /*!
+     * \brief Gets whether enough items were seen. The repository cancels the
+     *        stream on the router once this returns true
+     */
+    [[nodiscard]] inline auto is_done() const noexcept -> bool {
+        return items_.size() >= count_;
+    }
+
+    [[nodiscard]] inline auto result() const -> std::vector<Model> {
+        return items_;
+    }
+
+  private:
+    std::size_t        count_;
+    std::vector<Model> items_;
+};
+
+template <typename Model, typename Selector>
+[[nodiscard]] inline auto make_sum(Selector selector) -> sum<Model, Selector> {
+    return sum<Model, Selector> {std::move(selector)};
+}
+
+template <typename Model, typename Selector>
+[[nodiscard]] inline auto make_min(Selector selector) -> min<Model, Selector> {
+    return min<Model, Selector> {std::move(selector)};
+}
+
+template <typename Model, typename Selector>
+[[nodiscard]] inline auto make_max(Selector selector) -> max<Model, Selector> {
+    return max<Model, Selector> {std::move(selector)};
+}
+
+template <typename Model, typename Selector, typename Aggregate = count>
+[[nodiscard]] inline auto make_group_by(Selector  selector,
+                                        Aggregate aggregate = {})
+    -> group_by<Model, Selector, Aggregate> {
+    return group_by<Model, Selector, Aggregate> {std::move(selector),
+                                                 std::move(aggregate)};
+}
+
+template <typename Model, typename Selector>
+[[nodiscard]] inline auto make_top_k(std::size_t k, Selector selector)
+    -> top_k<Model, Selector> {
+    return top_k<Model, Selector> {k, std::move(selector)};
+}
+
+template <typename Model, typename Selector>
+[[nodiscard]] inline auto make_bottom_k(std::size_t k, Selector selector)
+    -> top_k<Model, Selector, std::less<>> {
+    return top_k<Model, Selector, std::less<>> {k, std::move(selector)};
+}
+
+} // namespace tikpp::data::aggregates
+
+#endif
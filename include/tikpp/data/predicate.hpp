@@ -0,0 +1,225 @@
+#ifndef TIKPP_DATA_PREDICATE_HPP
+#define TIKPP_DATA_PREDICATE_HPP
+
+#include "tikpp/data/query.hpp"
+#include "tikpp/detail/query_evaluator.hpp"
+#include "tikpp/sentence.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tikpp::data {
+
+/*!
+ * \brief A filter over a model list which is split into a part that is pushed
+ *        to the router as query words, and a remainder that is evaluated
+ *        locally on each received item
+ *
+ * A predicate always means `pushed && local', so an item is accepted only if
+ * the router returned it and the local remainder (if any) accepts it.
+ */
+template <typename Model>
+struct predicate {
+    /*!
+     * \brief The locally evaluated remainder. It receives the raw sentence of
+     *        the item as well as the created model
+     */
+    using local_type =
+        std::function<bool(const tikpp::sentence &, const Model &)>;
+
+    predicate() = default;
+
+    predicate(query q) : pushed {std::move(q.words)} {
+    }
+
+    predicate(query_token t) : pushed {query {t}.words} {
+    }
+
+    /*!
+     * \brief Gets whether the whole predicate can be evaluated by the router
+     */
+    [[nodiscard]] inline auto is_pushable() const noexcept -> bool {
+        return !static_cast<bool>(local);
+    }
+
+    /*!
+     * \brief Evaluates the local remainder of the predicate
+     */
+    [[nodiscard]] inline auto
+    operator()(const tikpp::sentence &data, const Model &item) const -> bool {
+        return !local || local(data, item);
+    }
+
+    /*!
+     * \brief Evaluates the whole predicate locally, including the part which
+     *        would otherwise be pushed to the router
+     */
+    [[nodiscard]] inline auto evaluate(const tikpp::sentence &data,
+                                       const Model &item) const -> bool {
+        return tikpp::detail::evaluate_query(pushed, data) &&
+               (*this)(data, item);
+    }
+
+    inline auto operator!() const -> predicate {
+        // An empty predicate matches every item, so its negation matches
+        // none, which no query words can express
+        if (is_pushable() && pushed.empty()) {
+            predicate ret {};
+            ret.local = [](const auto &, const auto &) { return false; };
+            return ret;
+        }
+
+        if (is_pushable()) {
+            return predicate {!query {folded(pushed)}};
+        }
+
+        predicate ret {};
+        ret.fields = all_fields();
+        ret.local  = [self = *this](const auto &data, const auto &item) {
+            return !self.evaluate(data, item);
+        };
+
+        return ret;
+    }
+
+    inline auto operator&&(const predicate &rhs) const -> predicate {
+        predicate ret {};
+
+        if (pushed.empty() || rhs.pushed.empty()) {
+            ret.pushed = pushed.empty() ? rhs.pushed : pushed;
+        } else {
+            ret.pushed = (query {pushed} && query {rhs.pushed}).words;
+        }
+
+        ret.fields = fields;
+        merge_fields(ret.fields, rhs.fields);
+
+        if (!is_pushable() && !rhs.is_pushable()) {
+            ret.local = [lhs = local, rhs = rhs.local](const auto &data,
+                                                       const auto &item) {
+                return lhs(data, item) && rhs(data, item);
+            };
+        } else {
+            ret.local = is_pushable() ? rhs.local : local;
+        }
+
+        return ret;
+    }
+
+    inline auto operator||(const predicate &rhs) const -> predicate {
+        if (is_pushable() && rhs.is_pushable()) {
+            if (pushed.empty() || rhs.pushed.empty()) {
+                return predicate {};
+            }
+
+            return predicate {query {folded(pushed)} ||
+                              query {folded(rhs.pushed)}};
+        }
+
+        predicate ret {};
+
+        // `(a && x) || (b && y)' implies `a || b', so the router can still
+        // drop the items that can never match
+        if (!pushed.empty() && !rhs.pushed.empty()) {
+            ret.pushed =
+                (query {folded(pushed)} || query {folded(rhs.pushed)}).words;
+        }
+
+        ret.fields = all_fields();
+        merge_fields(ret.fields, rhs.all_fields());
+        ret.local = [lhs = *this, rhs](const auto &data, const auto &item) {
+            return lhs.evaluate(data, item) || rhs.evaluate(data, item);
+        };
+
+        return ret;
+    }
+
+    /*!
+     * \brief The query words that are sent to the router
+     */
+    std::vector<std::string> pushed;
+
+    /*!
+     * \brief The fields that the local remainder needs to be evaluated
+     */
+    std::vector<std::string> fields;
+
+    /*!
+     * \brief The locally evaluated remainder, empty when the whole predicate
+     *        is pushed to the router
+     */
+    local_type local;
+
+  private:
+    [[nodiscard]] inline auto all_fields() const -> std::vector<std::string> {
+        auto ret = tikpp::detail::query_fields(pushed);
+        merge_fields(ret, fields);
+        return ret;
+    }
+
+    /*!
+     * \brief Folds the values which \p words leave on the stack into one with
+     *        explicit `?#&' words, since `?#!' and `?#|' only operate on the
+     *        top values of the stack
+     */
+    [[nodiscard]] static inline auto folded(std::vector<std::string> words)
+        -> std::vector<std::string> {
+        for (auto depth = tikpp::detail::query_depth(words); depth > 1;
+             --depth) {
+            words.emplace_back("?#&");
+        }
+
+        return words;
+    }
+
+    static inline void merge_fields(std::vector<std::string> &      lhs,
+                                    const std::vector<std::string> &rhs) {
+        for (const auto &field : rhs) {
+            if (std::find(lhs.begin(), lhs.end(), field) == lhs.end()) {
+                lhs.push_back(field);
+            }
+        }
+    }
+};
+
+template <typename Model>
+inline auto operator&&(query lhs, const predicate<Model> &rhs)
+    -> predicate<Model> {
+    return predicate<Model> {std::move(lhs)} && rhs;
+}
+
+template <typename Model>
+inline auto operator||(query lhs, const predicate<Model> &rhs)
+    -> predicate<Model> {
+    return predicate<Model> {std::move(lhs)} || rhs;
+}
+
+/*!
+ * \brief Creates a predicate which can only be evaluated locally
+ *
+ * \param [in] fields The fields which \p fn reads, which are added to the
+ *                    requested proplist
+ * \param [in] fn     A callable object which accepts `const Model &' and
+ *                    returns bool
+ *
+ * \return The created predicate
+ */
+template <typename Model, typename Predicate>
+[[nodiscard]] inline auto make_predicate(std::vector<std::string> fields,
+                                         Predicate &&             fn)
+    -> predicate<Model> {
+    predicate<Model> ret {};
+    ret.fields = std::move(fields);
+    ret.local  = [fn {std::forward<Predicate>(fn)}](
+                    [[maybe_unused]] const tikpp::sentence &data,
+                    const Model &item) { return fn(item); };
+
+    return ret;
+}
+
+} // namespace tikpp::data
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TIKPP_DATA_PROJECTION_HPP
+#define TIKPP_DATA_PROJECTION_HPP
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tikpp::data {
+
+/*!
+ * \brief A set of model fields to be requested from the router
+ *
+ * An empty projection means all the fields the model declares.
+ */
+struct projection {
+    projection() = default;
+
+    projection(std::vector<std::string> f) : fields {std::move(f)} {
+    }
+
+    [[nodiscard]] inline auto empty() const noexcept -> bool {
+        return fields.empty();
+    }
+
+    [[nodiscard]] inline auto contains(const std::string &field) const noexcept
+        -> bool {
+        return std::find(fields.begin(), fields.end(), field) != fields.end();
+    }
+
+    /*!
+     * \brief Adds the passed fields to the projection, skipping the ones which
+     *        are already projected
+     *
+     * \param [in] other The fields to be added
+     */
+    inline void merge(const std::vector<std::string> &other) {
+        for (const auto &field : other) {
+            if (!contains(field)) {
+                fields.push_back(field);
+            }
+        }
+    }
+
+    std::vector<std::string> fields;
+};
+
+template <typename... Field>
+[[nodiscard]] inline auto make_projection(Field &&... fields) -> projection {
+    return projection {
+        std::vector<std::string> {std::string {std::forward<Field>(fields)}...}};
+}
+
+} // namespace tikpp::data
+
+#endif
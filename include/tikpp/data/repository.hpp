@@ -4,17 +4,25 @@
 #include "tikpp/basic_api.hpp"
 #include "tikpp/detail/async_result.hpp"
 
+#include "tikpp/data/aggregates.hpp"
 #include "tikpp/data/converters/creator.hpp"
+#include "tikpp/data/converters/proplist_collector.hpp"
+#include "tikpp/data/predicate.hpp"
+#include "tikpp/data/projection.hpp"
 #include "tikpp/data/query.hpp"
 #include "tikpp/data/types/identity.hpp"
 
 #include "tikpp/commands/add.hpp"
+#include "tikpp/commands/count.hpp"
 #include "tikpp/commands/getall.hpp"
 #include "tikpp/commands/remove.hpp"
 #include "tikpp/commands/set.hpp"
+#include "tikpp/flow_control.hpp"
 
 #include <boost/system/error_code.hpp>
 
+#include <cassert>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -40,6 +48,17 @@ struct repository {
     explicit repository(ApiPtr api) : api_ {std::move(api)} {
     }
 
+    /*!
+     * \brief Sets the flow control object to be used by the streams started
+     *        after this call (`async_stream' and `async_stream_batches')
+     *
+     * \param [in] flow  The flow control object, or nullptr to disable flow
+     *                   control for the next streams
+     */
+    inline void flow_control(std::shared_ptr<tikpp::flow_control> flow) {
+        flow_control_ = std::move(flow);
+    }
+
     /*!
      * \brief Asynchronously loads all items from the router
      *
@@ -72,6 +91,32 @@ struct repository {
                              std::forward<CompletionToken>(token));
     }
 
+    /*!
+     * \brief Asynchronously loads filtered and projected items from the router
+     *
+     * The part of \p pred which can be expressed as RouterOS query words is
+     * evaluated by the router, and the remainder is evaluated locally. Only
+     * the fields in \p proj (plus the ones the local remainder needs) are
+     * requested from the router, and the other fields are left with their
+     * default values.
+     *
+     * \param [in]     pred   The predicate to be used to filter the result
+     * \param [in]     proj   The fields to be loaded, or an empty projection
+     *                        to load all the model fields
+     * \param [in,out] token  The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    inline decltype(auto) async_load(tikpp::data::predicate<Model> pred,
+                                     tikpp::data::projection       proj,
+                                     CompletionToken &&            token) {
+        auto req = make_getall_request(pred, std::move(proj));
+        return do_async_load(std::move(req),
+                             std::forward<CompletionToken>(token),
+                             std::move(pred));
+    }
+
     /*!
      * \brief Asynchronously loads all items from the router as a stream
      *
@@ -83,6 +128,7 @@ struct repository {
     inline decltype(auto) async_stream(CompletionToken &&token) {
         auto req =
             api_->template make_request<tikpp::commands::getall<Model>>();
+        req->flow_control(flow_control_);
         return do_async_stream(std::move(req),
                                std::forward<CompletionToken>(token));
     }
@@ -100,10 +146,207 @@ struct repository {
                                        CompletionToken &&token) {
         auto req = api_->template make_request<tikpp::commands::getall<Model>>(
             std::move(query));
+        req->flow_control(flow_control_);
         return do_async_stream(std::move(req),
                                std::forward<CompletionToken>(token));
     }
 
+    /*!
+     * \brief Asynchronously loads filtered and projected items from the router
+     *        as a stream
+     *
+     * \see async_load(tikpp::data::predicate<Model>, tikpp::data::projection,
+     *                 CompletionToken&&)
+     *
+     * \param [in]     pred   The predicate to be used to filter the result
+     * \param [in]     proj   The fields to be loaded, or an empty projection
+     *                        to load all the model fields
+     * \param [in,out] token  The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    inline decltype(auto) async_stream(tikpp::data::predicate<Model> pred,
+                                       tikpp::data::projection       proj,
+                                       CompletionToken &&            token) {
+        auto req = make_getall_request(pred, std::move(proj));
+        req->flow_control(flow_control_);
+        return do_async_stream(std::move(req),
+                               std::forward<CompletionToken>(token),
+                               std::move(pred));
+    }
+
+    /*!
+     * \brief Asynchronously loads all items from the router as a stream of
+     *        batches
+     *
+     * The handler is invoked with up to \p batch_size items at a time, and a
+     * final time with `tikpp::error_code::list_end' (or the error which ended
+     * the stream) and an empty batch. The items which were received before
+     * an error are passed in a batch of their own first, so none is lost. The
+     * batch storage is reused between invocations, so the passed vector is
+     * only valid until the handler returns (its items may be moved from).
+     *
+     * \param [in]     batch_size  The maximum number of items in a batch
+     * \param [in,out] token       The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    inline decltype(auto) async_stream_batches(std::size_t        batch_size,
+                                               CompletionToken && token) {
+        auto req =
+            api_->template make_request<tikpp::commands::getall<Model>>();
+        return do_async_stream_batches(std::move(req), batch_size,
+                                       std::forward<CompletionToken>(token));
+    }
+
+    /*!
+     * \brief Asynchronously loads filtered items from the router as a stream
+     *        of batches
+     *
+     * \see async_stream_batches(std::size_t, CompletionToken&&)
+     *
+     * \param [in]     query       The query to be used to filter the result
+     * \param [in]     batch_size  The maximum number of items in a batch
+     * \param [in,out] token       The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    inline decltype(auto) async_stream_batches(query_type         query,
+                                               std::size_t        batch_size,
+                                               CompletionToken && token) {
+        auto req = api_->template make_request<tikpp::commands::getall<Model>>(
+            std::move(query));
+        return do_async_stream_batches(std::move(req), batch_size,
+                                       std::forward<CompletionToken>(token));
+    }
+
+    /*!
+     * \brief Asynchronously loads filtered and projected items from the router
+     *        as a stream of batches
+     *
+     * \see async_stream_batches(std::size_t, CompletionToken&&)
+     *
+     * \param [in]     pred        The predicate to be used to filter the result
+     * \param [in]     proj        The fields to be loaded, or an empty
+     *                             projection to load all the model fields
+     * \param [in]     batch_size  The maximum number of items in a batch
+     * \param [in,out] token       The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    inline decltype(auto)
+    async_stream_batches(tikpp::data::predicate<Model> pred,
+                         tikpp::data::projection       proj,
+                         std::size_t                   batch_size,
+                         CompletionToken &&            token) {
+        auto req = make_getall_request(pred, std::move(proj));
+        return do_async_stream_batches(std::move(req), batch_size,
+                                       std::forward<CompletionToken>(token),
+                                       std::move(pred));
+    }
+
+    /*!
+     * \brief Asynchronously counts the items in the router without loading
+     *        them, using the `count-only' print option
+     *
+     * \param [in,out] token  The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    inline decltype(auto) async_count(CompletionToken &&token) {
+        auto req = api_->template make_request<tikpp::commands::count<Model>>();
+        return do_async_count(std::move(req),
+                              std::forward<CompletionToken>(token));
+    }
+
+    /*!
+     * \brief Asynchronously counts the filtered items in the router without
+     *        loading them, using the `count-only' print option
+     *
+     * \param [in]     query  The query to be used to filter the items
+     * \param [in,out] token  The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    inline decltype(auto) async_count(query_type        query,
+                                      CompletionToken &&token) {
+        auto req = api_->template make_request<tikpp::commands::count<Model>>(
+            std::move(query));
+        return do_async_count(std::move(req),
+                              std::forward<CompletionToken>(token));
+    }
+
+    /*!
+     * \brief Asynchronously runs an aggregate over all the items as they are
+     *        streamed from the router, without keeping the items in memory
+     *
+     * If the aggregate has an `is_done()' member function which returns true,
+     * the request is cancelled on the router and the handler is invoked right
+     * away with the aggregate result.
+     *
+     * \param [in]     aggregate  The aggregate to be run (\see
+     *                            tikpp::data::aggregates)
+     * \param [in,out] token      The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename Aggregate, typename CompletionToken>
+    inline decltype(auto) async_aggregate(Aggregate          aggregate,
+                                          CompletionToken && token) {
+        auto req =
+            api_->template make_request<tikpp::commands::getall<Model>>();
+        return do_async_aggregate(std::move(req), std::move(aggregate),
+                                  std::forward<CompletionToken>(token));
+    }
+
+    /*!
+     * \brief Asynchronously runs an aggregate over the filtered items as they
+     *        are streamed from the router
+     *
+     * \param [in]     query      The query to be used to filter the items
+     * \param [in]     aggregate  The aggregate to be run
+     * \param [in,out] token      The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename Aggregate, typename CompletionToken>
+    inline decltype(auto) async_aggregate(query_type         query,
+                                          Aggregate          aggregate,
+                                          CompletionToken && token) {
+        auto req = api_->template make_request<tikpp::commands::getall<Model>>(
+            std::move(query));
+        return do_async_aggregate(std::move(req), std::move(aggregate),
+                                  std::forward<CompletionToken>(token));
+    }
+
+    /*!
+     * \brief Asynchronously runs an aggregate over the filtered and projected
+     *        items as they are streamed from the router
+     *
+     * \param [in]     pred       The predicate to be used to filter the items
+     * \param [in]     proj       The fields which the aggregate needs
+     * \param [in]     aggregate  The aggregate to be run
+     * \param [in,out] token      The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename Aggregate, typename CompletionToken>
+    inline decltype(auto) async_aggregate(tikpp::data::predicate<Model> pred,
+                                          tikpp::data::projection       proj,
+                                          Aggregate          aggregate,
+                                          CompletionToken && token) {
+        auto req = make_getall_request(pred, std::move(proj));
+        return do_async_aggregate(std::move(req), std::move(aggregate),
+                                  std::forward<CompletionToken>(token),
+                                  std::move(pred));
+    }
+
     /*!
      * \brief Asynchronously adds an item to the router
      *
@@ -221,32 +464,166 @@ struct repository {
     }
 
   private:
+    inline auto make_getall_request(const tikpp::data::predicate<Model> &pred,
+                                    tikpp::data::projection              proj)
+        -> std::shared_ptr<tikpp::request> {
+        if (proj.empty()) {
+            tikpp::data::converters::proplist_collector<
+                std::vector<std::string>>
+                collector {};
+
+            Model m {};
+            m.convert(collector);
+            proj.fields = std::move(collector.proplist);
+        } else if (!pred.is_pushable()) {
+            proj.merge(pred.fields);
+        }
+
+        return api_->template make_request<tikpp::commands::getall<Model>>(
+            pred.pushed, proj.fields);
+    }
+
     template <typename CompletionToken>
-    decltype(auto) do_async_load(std::shared_ptr<tikpp::request> req,
-                                 CompletionToken &&              token) {
+    decltype(auto)
+    do_async_load(std::shared_ptr<tikpp::request> req,
+                  CompletionToken &&              token,
+                  tikpp::data::predicate<Model>   filter = {}) {
         GENERATE_COMPLETION_HANDLER(
             void(const boost::system::error_code &, std::vector<Model> &&),
             token, handler, result)
 
+        auto slot = tikpp::detail::cancellation_slot_of(handler);
+
         api_->async_send(
-            std::move(req), [handler {std::move(handler)},
-                             ret = std::make_shared<std::vector<Model>>()](
-                                const auto &err, auto &&resp) mutable {
+            std::move(req),
+            tikpp::detail::bind_cancellation_slot(
+                slot, [handler {std::move(handler)},
+                       filter {std::move(filter)},
+                       ret = std::make_shared<std::vector<Model>>()](
+                          const auto &err, auto &&resp) mutable {
+                    if (err) {
+                        handler(err, std::vector<Model> {});
+                    } else if (resp.error()) {
+                        handler(resp.error(), std::vector<Model> {});
+                    } else if (resp.type() == tikpp::response_type::normal &&
+                               resp.empty()) {
+                        handler(boost::system::error_code {}, std::move(*ret));
+                    } else if (resp.type() != tikpp::response_type::data) {
+                        handler(tikpp::make_error_code(
+                                    tikpp::error_code::invalid_response),
+                                std::vector<Model> {});
+                    } else {
+                        tikpp::data::converters::creator<tikpp::response> c {
+                            resp};
+                        auto item = c.create<Model>();
+
+                        if (filter(resp, item)) {
+                            ret->emplace_back(std::move(item));
+                        }
+
+                        return true;
+                    }
+
+                    return false;
+                }));
+
+        return result.get();
+    }
+
+    template <typename CompletionToken>
+    decltype(auto)
+    do_async_stream_batches(std::shared_ptr<tikpp::request> req,
+                            std::size_t                     batch_size,
+                            CompletionToken &&              token,
+                            tikpp::data::predicate<Model>   filter = {}) {
+        assert(batch_size > 0);
+
+        GENERATE_COMPLETION_HANDLER(
+            void(const boost::system::error_code &, std::vector<Model> &),
+            token, handler, result)
+
+        req->flow_control(flow_control_);
+
+        auto batch = std::make_shared<std::vector<Model>>();
+        batch->reserve(batch_size);
+
+        auto slot = tikpp::detail::cancellation_slot_of(handler);
+
+        api_->async_send(
+            std::move(req),
+            tikpp::detail::bind_cancellation_slot(
+                slot, [handler {std::move(handler)},
+                       filter {std::move(filter)}, batch,
+                       batch_size](const auto &err, auto &&resp) mutable {
+                // The items of a partial batch were received and accepted, so
+                // they are passed on before the end (or the failure)
+                const auto finish = [&](const boost::system::error_code &ec) {
+                    if (!batch->empty()) {
+                        handler(boost::system::error_code {}, *batch);
+                        batch->clear();
+                    }
+
+                    handler(ec, *batch);
+                };
+
                 if (err) {
-                    handler(err, std::vector<Model> {});
+                    finish(err);
                 } else if (resp.error()) {
-                    handler(resp.error(), std::vector<Model> {});
+                    finish(resp.error());
                 } else if (resp.type() == tikpp::response_type::normal &&
                            resp.empty()) {
-                    handler(boost::system::error_code {}, std::move(*ret));
+                    finish(tikpp::make_error_code(tikpp::error_code::list_end));
                 } else if (resp.type() != tikpp::response_type::data) {
+                    finish(tikpp::make_error_code(
+                        tikpp::error_code::invalid_response));
+                } else {
+                    tikpp::data::converters::creator<tikpp::response> creator {
+                        resp};
+
+                    auto &item = batch->emplace_back();
+                    item.convert(creator);
+
+                    if (!filter(resp, item)) {
+                        batch->pop_back();
+                    } else if (batch->size() >= batch_size) {
+                        handler(boost::system::error_code {}, *batch);
+                        batch->clear();
+                    }
+
+                    return true;
+                }
+
+                return false;
+            }));
+
+        return result.get();
+    }
+
+    template <typename CompletionToken>
+    decltype(auto) do_async_count(std::shared_ptr<tikpp::request> req,
+                                  CompletionToken &&              token) {
+        GENERATE_COMPLETION_HANDLER(
+            void(const boost::system::error_code &, std::size_t), token,
+            handler, result)
+
+        api_->async_send(
+            std::move(req), [handler {std::move(handler)}](
+                                const auto &err, auto &&resp) mutable {
+                using command_type = tikpp::commands::count<Model>;
+
+                if (err) {
+                    handler(err, 0);
+                } else if (resp.error()) {
+                    handler(resp.error(), 0);
+                } else if (resp.type() != tikpp::response_type::normal ||
+                           !resp.contains(command_type::result_param)) {
                     handler(tikpp::make_error_code(
                                 tikpp::error_code::invalid_response),
-                            std::vector<Model> {});
+                            0);
                 } else {
-                    tikpp::data::converters::creator<tikpp::response> c {resp};
-                    ret->emplace_back(c.create<Model>());
-                    return true;
+                    handler(boost::system::error_code {},
+                            resp.template get<std::size_t>(
+                                command_type::result_param));
                 }
 
                 return false;
@@ -255,46 +632,107 @@ struct repository {
         return result.get();
     }
 
+    template <typename Aggregate, typename CompletionToken>
+    decltype(auto)
+    do_async_aggregate(std::shared_ptr<tikpp::request> req,
+                       Aggregate                       aggregate,
+                       CompletionToken &&              token,
+                       tikpp::data::predicate<Model>   filter = {}) {
+        using aggregate_result_type =
+            std::decay_t<decltype(std::declval<const Aggregate &>().result())>;
+
+        GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &,
+                                         aggregate_result_type &&),
+                                    token, handler, result)
+
+        auto tag = req->tag();
+
+        do_async_stream(
+            std::move(req),
+            [api = api_, tag, handler {std::move(handler)},
+             aggregate = std::make_shared<Aggregate>(std::move(aggregate)),
+             done = std::make_shared<bool>(false)](const auto &err,
+                                                   auto &&item) mutable {
+                if (*done) {
+                    return;
+                }
+
+                if (err == tikpp::error_code::list_end) {
+                    *done = true;
+                    handler(boost::system::error_code {}, aggregate->result());
+                } else if (err) {
+                    *done = true;
+                    handler(err, aggregate_result_type {});
+                } else {
+                    (*aggregate)(item);
+
+                    if constexpr (tikpp::data::aggregates::detail::
+                                      has_is_done_v<const Aggregate &>) {
+                        if (aggregate->is_done()) {
+                            *done = true;
+                            api->async_cancel(tag, [](const auto &) {});
+                            handler(boost::system::error_code {},
+                                    aggregate->result());
+                        }
+                    }
+                }
+            },
+            std::move(filter));
+
+        return result.get();
+    }
+
     template <typename CompletionToken>
-    decltype(auto) do_async_stream(std::shared_ptr<tikpp::request> req,
-                                   CompletionToken &&              token) {
+    decltype(auto)
+    do_async_stream(std::shared_ptr<tikpp::request> req,
+                    CompletionToken &&              token,
+                    tikpp::data::predicate<Model>   filter = {}) {
         GENERATE_COMPLETION_HANDLER(
             void(const boost::system::error_code &, Model &&), token, handler,
             result)
 
-        api_->async_send(std::move(req), [handler {std::move(handler)}](
-                                             const auto &err,
-                                             auto &&     resp) mutable {
-            if (err) {
-                handler(err, Model {});
-            } else if (resp.error()) {
-                handler(resp.error(), Model {});
-            } else if (resp.type() == tikpp::response_type::normal &&
-                       resp.empty()) {
-                handler(tikpp::make_error_code(tikpp::error_code::list_end),
-                        Model {});
-            } else if (resp.type() != tikpp::response_type::data) {
-                handler(
-                    tikpp::make_error_code(tikpp::error_code::invalid_response),
-                    Model {});
-            } else if (!resp.empty()) {
-                tikpp::data::converters::creator<tikpp::response> creator {
-                    resp};
-
-                Model item {};
-                item.convert(creator);
-
-                handler(boost::system::error_code {}, std::move(item));
-                return true;
-            }
-
-            return false;
-        });
+        auto slot = tikpp::detail::cancellation_slot_of(handler);
+
+        api_->async_send(
+            std::move(req),
+            tikpp::detail::bind_cancellation_slot(
+                slot, [handler {std::move(handler)},
+                       filter {std::move(filter)}](const auto &err,
+                                                   auto &&resp) mutable {
+                if (err) {
+                    handler(err, Model {});
+                } else if (resp.error()) {
+                    handler(resp.error(), Model {});
+                } else if (resp.type() == tikpp::response_type::normal &&
+                           resp.empty()) {
+                    handler(tikpp::make_error_code(tikpp::error_code::list_end),
+                            Model {});
+                } else if (resp.type() != tikpp::response_type::data) {
+                    handler(tikpp::make_error_code(
+                                tikpp::error_code::invalid_response),
+                            Model {});
+                } else if (!resp.empty()) {
+                    tikpp::data::converters::creator<tikpp::response> creator {
+                        resp};
+
+                    Model item {};
+                    item.convert(creator);
+
+                    if (filter(resp, item)) {
+                        handler(boost::system::error_code {}, std::move(item));
+                    }
+
+                    return true;
+                }
+
+                return false;
+            }));
 
         return result.get();
     }
 
-    ApiPtr api_;
+    ApiPtr                               api_;
+    std::shared_ptr<tikpp::flow_control> flow_control_;
 };
 
 /*!
@@ -167,7 +167,7 @@ inline auto operator""_w(unsigned long long int w)
 namespace fmt {
 
 template <typename Rep>
-struct fmt::formatter<tikpp::data::types::duration<Rep>> {
+struct formatter<tikpp::data::types::duration<Rep>> {
     constexpr auto parse(format_parse_context &ctx) {
         return ctx.begin();
     }
@@ -0,0 +1,66 @@
+#ifndef TIKPP_DETAIL_CANCELLATION_HPP
+#define TIKPP_DETAIL_CANCELLATION_HPP
+
+#include <boost/version.hpp>
+
+#if BOOST_VERSION >= 107700
+#define TIKPP_HAS_CANCELLATION_SLOTS 1
+
+#include <boost/asio/associated_cancellation_slot.hpp>
+#include <boost/asio/bind_cancellation_slot.hpp>
+#include <boost/asio/cancellation_signal.hpp>
+#endif
+
+#include <type_traits>
+#include <utility>
+
+namespace tikpp::detail {
+
+#ifdef TIKPP_HAS_CANCELLATION_SLOTS
+
+using cancellation_slot = boost::asio::cancellation_slot;
+
+#else
+
+/*!
+ * \brief A placeholder for Asio cancellation slots, which are not supported
+ *        by Boost versions older than 1.77
+ */
+struct cancellation_slot {};
+
+#endif
+
+/*!
+ * \brief Gets the cancellation slot associated with a completion handler
+ */
+template <typename Handler>
+[[nodiscard]] inline auto
+cancellation_slot_of([[maybe_unused]] const Handler &handler)
+    -> cancellation_slot {
+#ifdef TIKPP_HAS_CANCELLATION_SLOTS
+    return boost::asio::get_associated_cancellation_slot(handler);
+#else
+    return {};
+#endif
+}
+
+/*!
+ * \brief Associates a cancellation slot with a callable object, so that an
+ *        intermediate handler keeps the cancellation slot of the completion
+ *        handler it wraps
+ */
+template <typename Callable>
+[[nodiscard]] inline auto
+bind_cancellation_slot([[maybe_unused]] const cancellation_slot &slot,
+                       Callable &&                               callable) {
+#ifdef TIKPP_HAS_CANCELLATION_SLOTS
+    return boost::asio::bind_cancellation_slot(
+        slot, std::forward<Callable>(callable));
+#else
+    return std::decay_t<Callable> {std::forward<Callable>(callable)};
+#endif
+}
+
+} // namespace tikpp::detail
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef TIKPP_DETAIL_LANE_SCHEDULER_HPP
+#define TIKPP_DETAIL_LANE_SCHEDULER_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <utility>
+
+namespace tikpp::detail {
+
+/*!
+ * \brief A set of FIFO lanes, ordered from the most urgent to the least
+ *        urgent, which are served by a weighted scheduler
+ *
+ * Each lane may be served up to its weight of items in a row while a less
+ * urgent lane is waiting, after which the less urgent lane gets one item in.
+ * A zero weight lets a lane always go ahead of the less urgent ones.
+ *
+ * \tparam T     The type of the queued items
+ * \tparam Lanes The number of lanes
+ */
+template <typename T, std::size_t Lanes>
+struct lane_scheduler {
+    using weights_type = std::array<std::size_t, Lanes>;
+
+    explicit lane_scheduler(weights_type weights) : weights_ {weights} {
+    }
+
+    /*!
+     * \brief Queues an item at the back of a lane
+     *
+     * \param [in] lane The index of the lane, zero being the most urgent
+     * \param [in] item The item to be queued
+     */
+    inline void push(std::size_t lane, T item) {
+        assert(lane < Lanes);
+        lanes_[lane].emplace_back(std::move(item));
+        ++size_;
+    }
+
+    /*!
+     * \brief Queues an item at the front of a lane, ahead of its turn
+     *
+     * \param [in] lane The index of the lane, zero being the most urgent
+     * \param [in] item The item to be queued
+     */
+    inline void push_front(std::size_t lane, T item) {
+        assert(lane < Lanes);
+        lanes_[lane].emplace_front(std::move(item));
+        ++size_;
+    }
+
+    /*!
+     * \brief Gets the item which is to be popped next. The scheduler must not
+     *        be empty
+     */
+    [[nodiscard]] inline auto front() -> T & {
+        return lanes_[select()].front();
+    }
+
+    /*!
+     * \brief Removes the item returned by \ref front
+     */
+    inline void pop() {
+        auto lane = select();
+
+        lanes_[lane].pop_front();
+        --size_;
+
+        // The more urgent lanes which were waiting on this one start over
+        ++streaks_[lane];
+        for (std::size_t i {0}; i < lane; ++i) {
+            streaks_[i] = 0;
+        }
+    }
+
+    /*!
+     * \brief Removes the first item which satisfies a predicate, regardless
+     *        of its turn
+     *
+     * \return The removed item, if any
+     */
+    template <typename Predicate>
+    inline auto extract_if(Predicate &&pred) -> std::optional<T> {
+        for (auto &lane : lanes_) {
+            for (auto itr = lane.begin(); itr != lane.end(); ++itr) {
+                if (pred(*itr)) {
+                    std::optional<T> item {std::move(*itr)};
+                    lane.erase(itr);
+                    --size_;
+                    return item;
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    [[nodiscard]] inline auto empty() const noexcept -> bool {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] inline auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+  private:
+    // Finds the most urgent non-empty lane which has not used up its weight
+    // while a less urgent one is waiting
+    inline auto select() const -> std::size_t {
+        assert(!empty());
+
+        std::size_t waiting {size_};
+
+        for (std::size_t lane {0}; lane < Lanes; ++lane) {
+            if (lanes_[lane].empty()) {
+                continue;
+            }
+
+            waiting -= lanes_[lane].size();
+
+            if (waiting == 0 || weights_[lane] == 0 ||
+                streaks_[lane] < weights_[lane]) {
+                return lane;
+            }
+        }
+
+        assert(false);
+        return Lanes - 1;
+    }
+
+    weights_type                     weights_;
+    weights_type                     streaks_ {};
+    std::array<std::deque<T>, Lanes> lanes_ {};
+    std::size_t                      size_ {0};
+};
+
+} // namespace tikpp::detail
+
+#endif
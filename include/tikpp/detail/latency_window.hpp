@@ -0,0 +1,70 @@
+#ifndef TIKPP_DETAIL_LATENCY_WINDOW_HPP
+#define TIKPP_DETAIL_LATENCY_WINDOW_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace tikpp::detail {
+
+/*!
+ * \brief Keeps the most recent latency samples in a ring, which quantiles
+ *        (e.g. the p95 latency) are taken over
+ *
+ * Taking a quantile selects over a copy of the samples, in linear time, so
+ * owners which add many samples take it every so often rather than after
+ * each sample.
+ */
+struct latency_window {
+    using duration = std::chrono::nanoseconds;
+
+    explicit latency_window(std::size_t capacity) : samples_(capacity) {
+        assert(capacity > 0);
+    }
+
+    inline void add(duration sample) {
+        samples_[next_] = sample;
+        next_           = (next_ + 1) % samples_.size();
+        size_           = std::min(size_ + 1, samples_.size());
+    }
+
+    /*!
+     * \brief Gets the number of the kept samples
+     */
+    [[nodiscard]] inline auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+    /*!
+     * \brief Gets a quantile of the kept samples, using the nearest rank
+     *
+     * \param [in] q The quantile, between zero and one
+     *
+     * \return The quantile, or zero if no samples are kept
+     */
+    [[nodiscard]] inline auto quantile(double q) const -> duration {
+        if (size_ == 0) {
+            return duration::zero();
+        }
+
+        std::vector<duration> sorted(samples_.begin(),
+                                     samples_.begin() + size_);
+
+        auto rank = static_cast<std::size_t>(
+            std::clamp(q, 0.0, 1.0) * static_cast<double>(size_ - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+
+        return sorted[rank];
+    }
+
+  private:
+    std::vector<duration> samples_;
+    std::size_t           next_ {0};
+    std::size_t           size_ {0};
+};
+
+} // namespace tikpp::detail
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef TIKPP_DETAIL_MPSC_QUEUE_HPP
+#define TIKPP_DETAIL_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace tikpp::detail {
+
+/*!
+ * \brief An unbounded lock-free multi-producer single-consumer queue (Vyukov's
+ *        intrusive node-based queue)
+ *
+ * \ref push may be called concurrently from any number of threads, while
+ * \ref pop must only be called by a single consumer at a time. A pushed item
+ * may briefly be invisible to the consumer while its producer is still
+ * linking it, so a consumer which finds the queue empty must be woken up again
+ * by the producer after \ref push returns.
+ */
+template <typename T>
+struct mpsc_queue {
+    mpsc_queue() : head_ {new node {}}, tail_ {head_.load()} {
+    }
+
+    mpsc_queue(const mpsc_queue &) = delete;
+    auto operator=(const mpsc_queue &) -> mpsc_queue & = delete;
+
+    ~mpsc_queue() {
+        while (auto *next = tail_->next.load()) {
+            delete tail_;
+            tail_ = next;
+        }
+
+        delete tail_;
+    }
+
+    /*!
+     * \brief Pushes an item to the queue. Safe to be called from any thread
+     */
+    inline void push(T value) {
+        auto *item = new node {std::move(value)};
+        auto *prev = head_.exchange(item, std::memory_order_acq_rel);
+        prev->next.store(item, std::memory_order_release);
+    }
+
+    /*!
+     * \brief Pops an item from the queue. Must only be called by the consumer
+     *
+     * \param [out] out The popped item
+     *
+     * \return Whether an item was popped or not
+     */
+    inline auto pop(T &out) -> bool {
+        auto *next = tail_->next.load(std::memory_order_acquire);
+
+        if (next == nullptr) {
+            return false;
+        }
+
+        out = std::move(*next->value);
+        next->value.reset();
+
+        delete tail_;
+        tail_ = next;
+
+        return true;
+    }
+
+  private:
+    struct node {
+        std::optional<T>    value;
+        std::atomic<node *> next {nullptr};
+    };
+
+    std::atomic<node *> head_;
+    node *              tail_;
+};
+
+} // namespace tikpp::detail
+
+#endif
@@ -2,34 +2,332 @@
 #define TIKPP_DETAIL_OPERATIONS_ASYNC_CONNECT_HPP
 
 #include "tikpp/detail/async_result.hpp"
+#include "tikpp/detail/type_traits/macros.hpp"
+#include "tikpp/dns_cache.hpp"
+#include "tikpp/resolver.hpp"
 
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
 #include <boost/asio/ip/address.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/system/error_code.hpp>
 
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace tikpp::detail::operations {
 
-template <typename AsyncReadStream, typename CompletionToken>
-decltype(auto) async_connect(AsyncReadStream &  sock,
-                             const std::string &host,
-                             std::uint16_t      port,
-                             CompletionToken && token) {
+/*!
+ * \brief The time after which the next address of a host is tried while the
+ *        previous attempts are still pending (RFC 8305 recommends 250ms)
+ */
+constexpr std::chrono::milliseconds connection_attempt_delay {250};
+
+template <typename T, typename = void>
+struct is_raceable : std::false_type {};
+
+template <typename T>
+struct is_raceable<
+    T,
+    std::enable_if_t<std::is_assignable_v<
+        decltype(std::declval<T &>().lowest_layer()),
+        boost::asio::ip::tcp::socket &&>>> : std::true_type {};
+
+//! Whether connection attempts to a stream can be raced on separate sockets,
+//! the winner of which is moved into the stream's lowest layer
+template <typename T>
+constexpr auto is_raceable_v = is_raceable<T>::value;
+
+HAS_MEMBER_FUNCTION(async_handshake,
+                    (std::declval<std::function<void(
+                         const boost::system::error_code &)>>()))
+
+/*!
+ * \brief Calls a connect completion handler on its associated executor
+ */
+template <typename Handler, typename Executor>
+void complete_connect(Handler &&                       handler,
+                      const Executor &                 ex,
+                      const boost::system::error_code &err) {
+    auto hex = boost::asio::get_associated_executor(handler, ex);
+    boost::asio::dispatch(
+        hex, [handler {std::forward<Handler>(handler)}, err]() mutable {
+            handler(err);
+        });
+}
+
+/*!
+ * \brief Orders addresses so that the address families alternate, starting
+ *        with the family of the first address (RFC 8305, section 4)
+ */
+inline auto interleave(const std::vector<boost::asio::ip::address> &addresses,
+                       std::uint16_t port)
+    -> std::vector<boost::asio::ip::tcp::endpoint> {
+    std::vector<boost::asio::ip::tcp::endpoint> first {}, second {}, result {};
+
+    for (const auto &address : addresses) {
+        auto &family = addresses.front().is_v6() == address.is_v6() ? first
+                                                                    : second;
+        family.emplace_back(address, port);
+    }
+
+    for (std::size_t i {0}; i < first.size() || i < second.size(); ++i) {
+        if (i < first.size()) {
+            result.push_back(first[i]);
+        }
+
+        if (i < second.size()) {
+            result.push_back(second[i]);
+        }
+    }
+
+    return result;
+}
+
+/*!
+ * \brief Connects a stream to one of several endpoints, trying them one at a
+ *        time on the stream itself
+ */
+template <typename AsyncStream, typename Handler>
+void connect_sequentially(
+    AsyncStream &                                              sock,
+    std::shared_ptr<std::vector<boost::asio::ip::tcp::endpoint>> endpoints,
+    std::size_t                                                index,
+    Handler &&                                                 handler) {
+    auto ep = (*endpoints)[index];
+
+    sock.async_connect(
+        ep, [&sock, endpoints {std::move(endpoints)}, index,
+             handler {std::forward<Handler>(handler)}](
+                const boost::system::error_code &err, auto &&...) mutable {
+            if (!err || index + 1 == endpoints->size()) {
+                return complete_connect(std::move(handler),
+                                        sock.get_executor(), err);
+            }
+
+            if (sock.is_open()) {
+                sock.close();
+            }
+
+            connect_sequentially(sock, std::move(endpoints), index + 1,
+                                 std::move(handler));
+        });
+}
+
+/*!
+ * \brief Connects a stream to one of several endpoints, starting an attempt
+ *        on a separate socket whenever the previous one fails or takes longer
+ *        than \see connection_attempt_delay, and keeping the first socket
+ *        which connects
+ */
+template <typename AsyncStream, typename Handler>
+struct connect_race final
+    : std::enable_shared_from_this<connect_race<AsyncStream, Handler>> {
+    connect_race(AsyncStream &                               sock,
+                 std::vector<boost::asio::ip::tcp::endpoint> endpoints,
+                 Handler                                     handler)
+        : sock_ {sock},
+          strand_ {boost::asio::make_strand(sock.get_executor())},
+          timer_ {strand_},
+          endpoints_ {std::move(endpoints)},
+          handler_ {std::move(handler)} {
+    }
+
+    inline void start() {
+        boost::asio::post(strand_, [self = this->shared_from_this()] {
+            self->attempt_next();
+        });
+    }
+
+  private:
+    void attempt_next() {
+        auto index = sockets_.size();
+        auto &sock = sockets_.emplace_back(
+            std::make_unique<boost::asio::ip::tcp::socket>(
+                sock_.get_executor()));
+
+        ++pending_;
+        sock->async_connect(
+            endpoints_[index],
+            boost::asio::bind_executor(
+                strand_, [self = this->shared_from_this(),
+                          index](const boost::system::error_code &err) {
+                    self->on_attempt(index, err);
+                }));
+
+        if (sockets_.size() == endpoints_.size()) {
+            return;
+        }
+
+        timer_.expires_after(connection_attempt_delay);
+        timer_.async_wait([self = this->shared_from_this()](const auto &err) {
+            if (!err && !self->done_) {
+                self->attempt_next();
+            }
+        });
+    }
+
+    void on_attempt(std::size_t index, const boost::system::error_code &err) {
+        --pending_;
+
+        if (done_) {
+            return;
+        }
+
+        if (err) {
+            boost::system::error_code ignored {};
+            sockets_[index]->close(ignored);
+
+            if (sockets_.size() < endpoints_.size()) {
+                timer_.cancel();
+                return attempt_next();
+            }
+
+            if (pending_ == 0) {
+                done_ = true;
+                complete_connect(std::move(handler_), sock_.get_executor(),
+                                 err);
+            }
+
+            return;
+        }
+
+        done_ = true;
+        timer_.cancel();
+
+        for (std::size_t i {0}; i < sockets_.size(); ++i) {
+            if (i != index) {
+                boost::system::error_code ignored {};
+                sockets_[i]->close(ignored);
+            }
+        }
+
+        sock_.lowest_layer() = std::move(*sockets_[index]);
+
+        if constexpr (has_async_handshake_v<AsyncStream &>) {
+            sock_.async_handshake(std::move(handler_));
+        } else {
+            complete_connect(std::move(handler_), sock_.get_executor(), err);
+        }
+    }
+
+    AsyncStream &sock_;
+    boost::asio::strand<std::decay_t<decltype(
+        std::declval<AsyncStream &>().get_executor())>>
+                              strand_;
+    boost::asio::steady_timer timer_;
+
+    std::vector<boost::asio::ip::tcp::endpoint>                endpoints_;
+    std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> sockets_ {};
+    std::size_t                                                pending_ {0};
+    bool                                                       done_ {false};
+    Handler                                                    handler_;
+};
+
+template <typename AsyncStream, typename Handler>
+void connect_to_any(AsyncStream &                               sock,
+                    std::vector<boost::asio::ip::tcp::endpoint> endpoints,
+                    Handler &&                                  handler) {
+    if (endpoints.size() == 1) {
+        sock.async_connect(endpoints.front(), std::forward<Handler>(handler));
+    } else if constexpr (is_raceable_v<AsyncStream>) {
+        std::make_shared<connect_race<AsyncStream, std::decay_t<Handler>>>(
+            sock, std::move(endpoints), std::forward<Handler>(handler))
+            ->start();
+    } else {
+        connect_sequentially(
+            sock,
+            std::make_shared<std::vector<boost::asio::ip::tcp::endpoint>>(
+                std::move(endpoints)),
+            0, std::forward<Handler>(handler));
+    }
+}
+
+/*!
+ * \brief Asynchronously connects a stream to a host, which is either an IP
+ *        address or a host name
+ *
+ * Host names are looked up in a DNS cache, and resolved on a miss. When a
+ * host has several addresses, IPv6 and IPv4 addresses are tried alternately:
+ * streams whose lowest layer is a TCP socket (e.g. the plain and the SSL API
+ * sockets) start the next attempt in parallel if the previous one has not
+ * completed within \see connection_attempt_delay ("happy eyeballs"), while
+ * other streams try one address at a time.
+ *
+ * \param [in] sock    The stream to be connected
+ * \param [in] host    The host address or name
+ * \param [in] port    The port to connect to
+ * \param [in] resolve The resolver used to resolve host names, or an empty
+ *                     function to use the system resolver
+ * \param [in] cache   The cache of the resolved host names
+ * \param [in] token   The completion token
+ */
+template <typename AsyncStream, typename CompletionToken>
+decltype(auto) async_connect(AsyncStream &                     sock,
+                             const std::string &               host,
+                             std::uint16_t                     port,
+                             const tikpp::resolver &           resolve,
+                             std::shared_ptr<tikpp::dns_cache> cache,
+                             CompletionToken &&                token) {
     GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &), token,
                                 handler, result);
 
     boost::system::error_code ec {};
     auto address = boost::asio::ip::address::from_string(host, ec);
 
-    if (ec) {
-        return handler(ec);
+    if (!ec) {
+        sock.async_connect({address, port}, std::move(handler));
+        return result.get();
     }
 
-    sock.async_connect({address, port}, std::move(handler));
+    auto shared = std::make_shared<handler_type>(std::move(handler));
+    auto ex     = sock.get_executor();
+
+    cache->async_resolve(
+        host, resolve ? resolve : tikpp::make_system_resolver(ex),
+        [&sock, port, ex, shared](const auto &err, auto addresses) {
+            boost::asio::post(ex, [&sock, port, shared, err,
+                                   addresses {std::move(addresses)}] {
+                if (err || addresses.empty()) {
+                    return complete_connect(
+                        std::move(*shared), sock.get_executor(),
+                        err ? err
+                            : boost::asio::error::make_error_code(
+                                  boost::asio::error::host_not_found));
+                }
+
+                connect_to_any(sock, interleave(addresses, port),
+                               std::move(*shared));
+            });
+        });
+
     return result.get();
 }
 
+/*!
+ * \brief Asynchronously connects a stream to a host, resolving host names
+ *        with the system resolver and caching them in
+ *        \see tikpp::default_dns_cache
+ */
+template <typename AsyncStream, typename CompletionToken>
+decltype(auto) async_connect(AsyncStream &      sock,
+                             const std::string &host,
+                             std::uint16_t      port,
+                             CompletionToken && token) {
+    return async_connect(sock, host, port, tikpp::resolver {},
+                         tikpp::default_dns_cache(),
+                         std::forward<CompletionToken>(token));
+}
+
 } // namespace tikpp::detail::operations
 
 #endif
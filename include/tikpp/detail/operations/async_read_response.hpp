@@ -3,14 +3,16 @@
 
 #include "tikpp/detail/async_result.hpp"
 #include "tikpp/detail/operations/async_read_word.hpp"
+#include "tikpp/detail/sentence_reader.hpp"
 
-#include "tikpp/error_code.hpp"
 #include "tikpp/response.hpp"
 
+#include <boost/asio/associated_executor.hpp>
 #include <boost/system/error_code.hpp>
 
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace tikpp::detail::operations {
@@ -27,27 +29,9 @@ struct async_read_response_op final {
         }
 
         if (word.empty()) {
-            if (!tikpp::response::is_valid_response(words_)) {
-                return handler_(
-                    tikpp::make_error_code(tikpp::error_code::invalid_response),
-                    tikpp::response {});
-            }
-
-            tikpp::response resp {words_};
-
-            if (resp.type() == tikpp::response_type::fatal) {
-                handler_(
-                    tikpp::make_error_code(tikpp::error_code::fatal_response),
-                    tikpp::response {});
-            } else if (!resp.tag().has_value()) {
-                handler_(tikpp::make_error_code(
-                             tikpp::error_code::untagged_response),
-                         tikpp::response {});
-            } else {
-                handler_(boost::system::error_code {}, std::move(resp));
-            }
-
-            return;
+            boost::system::error_code ec {};
+            auto resp = tikpp::detail::to_response(words_, ec);
+            return handler_(ec, std::move(resp));
         }
 
         words_.emplace_back(std::move(word));
@@ -58,6 +42,19 @@ struct async_read_response_op final {
         async_read_word(sock_, std::move(*this));
     }
 
+    /*!
+     * \brief Gets the executor associated with the completion handler, so
+     *        that the intermediate handlers run on it as well (e.g. a strand)
+     */
+    using executor_type = boost::asio::associated_executor_t<
+        Handler,
+        decltype(std::declval<AsyncReadStream &>().get_executor())>;
+
+    [[nodiscard]] inline auto get_executor() const noexcept -> executor_type {
+        return boost::asio::get_associated_executor(handler_,
+                                                    sock_.get_executor());
+    }
+
   private:
     AsyncReadStream &        sock_;
     Handler                  handler_;
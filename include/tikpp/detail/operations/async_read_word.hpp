@@ -4,6 +4,8 @@
 #include "tikpp/detail/async_result.hpp"
 #include "tikpp/detail/operations/async_read_word_length.hpp"
 
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/system/error_code.hpp>
@@ -11,6 +13,7 @@
 #include <cstdint>
 #include <string>
 #include <type_traits>
+#include <utility>
 
 namespace tikpp::detail::operations {
 
@@ -28,6 +31,7 @@ struct async_read_word_op final {
         auto buf = std::make_shared<std::string>();
         buf->resize(len);
 
+        auto ex = get_executor();
         auto cb = [buf, handler {std::move(handler_)}](const auto &err,
                                                        auto        rx) mutable {
             if (err) {
@@ -38,13 +42,22 @@ struct async_read_word_op final {
         };
 
         boost::asio::async_read(sock_, boost::asio::buffer(*buf, len),
-                                std::move(cb));
+                                boost::asio::bind_executor(ex, std::move(cb)));
     }
 
     inline void initiate() {
         async_read_word_length(sock_, std::move(*this));
     }
 
+    using executor_type = boost::asio::associated_executor_t<
+        Handler,
+        decltype(std::declval<AsyncReadStream &>().get_executor())>;
+
+    [[nodiscard]] inline auto get_executor() const noexcept -> executor_type {
+        return boost::asio::get_associated_executor(handler_,
+                                                    sock_.get_executor());
+    }
+
   private:
     AsyncReadStream &sock_;
     Handler          handler_;
@@ -3,6 +3,7 @@
 
 #include "tikpp/detail/async_result.hpp"
 
+#include <boost/asio/associated_executor.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/error.hpp>
 #include <boost/asio/read.hpp>
@@ -13,6 +14,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace tikpp::detail::operations {
@@ -89,6 +91,15 @@ struct async_read_word_length_op final {
                                 std::move(*this));
     }
 
+    using executor_type = boost::asio::associated_executor_t<
+        Handler,
+        decltype(std::declval<AsyncReadStream &>().get_executor())>;
+
+    [[nodiscard]] inline auto get_executor() const noexcept -> executor_type {
+        return boost::asio::get_associated_executor(handler_,
+                                                    sock_.get_executor());
+    }
+
   private:
     AsyncReadStream &sock_;
     Handler          handler_;
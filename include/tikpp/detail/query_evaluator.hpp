@@ -0,0 +1,248 @@
+#ifndef TIKPP_DETAIL_QUERY_EVALUATOR_HPP
+#define TIKPP_DETAIL_QUERY_EVALUATOR_HPP
+
+#include "tikpp/sentence.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace tikpp::detail {
+
+struct query_word {
+    enum class kind { exists, not_exists, equals, less, greater, operation };
+
+    kind        type;
+    std::string name;
+    std::string value;
+};
+
+/*!
+ * \brief Parses a RouterOS query word (e.g. `?<name=value')
+ *
+ * \param [in]  word The word to be parsed
+ * \param [out] out  The parsed word
+ *
+ * \return Whether the word is a valid query word or not
+ */
+inline auto parse_query_word(const std::string &word, query_word &out) -> bool {
+    if (word.size() < 2 || word[0] != '?') {
+        return false;
+    }
+
+    const auto split = [&out](const std::string &str) {
+        if (auto pos = str.find('='); pos != std::string::npos) {
+            out.name  = str.substr(0, pos);
+            out.value = str.substr(pos + 1);
+            return true;
+        }
+
+        out.name = str;
+        out.value.clear();
+        return false;
+    };
+
+    switch (word[1]) {
+    case '#':
+        out.type = query_word::kind::operation;
+        out.name.clear();
+        out.value = word.substr(2);
+        return true;
+    case '-':
+        out.type = query_word::kind::not_exists;
+        split(word.substr(2));
+        return true;
+    case '=':
+        out.type = query_word::kind::equals;
+        return split(word.substr(2));
+    case '<':
+        out.type = query_word::kind::less;
+        return split(word.substr(2));
+    case '>':
+        out.type = query_word::kind::greater;
+        return split(word.substr(2));
+    default:
+        out.type = split(word.substr(1)) ? query_word::kind::equals
+                                         : query_word::kind::exists;
+        return true;
+    }
+}
+
+/*!
+ * \brief Compares two RouterOS values, numerically if both are integers and
+ *        lexicographically otherwise
+ *
+ * \return A negative value if \p lhs < \p rhs, zero if they are equal, and a
+ *         positive value otherwise
+ */
+inline auto compare_values(const std::string &lhs, const std::string &rhs)
+    -> int {
+    const auto is_number = [](const std::string &str) {
+        auto begin = str.begin() + (!str.empty() && str[0] == '-' ? 1 : 0);
+        return begin != str.end() &&
+               std::all_of(begin, str.end(),
+                           [](char c) { return std::isdigit(c) != 0; });
+    };
+
+    if (!is_number(lhs) || !is_number(rhs)) {
+        return lhs.compare(rhs);
+    }
+
+    const bool lneg = lhs[0] == '-', rneg = rhs[0] == '-';
+
+    if (lneg != rneg) {
+        return lneg ? -1 : 1;
+    }
+
+    const auto strip = [](const std::string &str) {
+        auto pos = str.find_first_not_of("-0");
+        return pos == std::string::npos ? std::string {} : str.substr(pos);
+    };
+
+    auto l = strip(lhs), r = strip(rhs);
+    auto ret =
+        l.size() != r.size() ? (l.size() < r.size() ? -1 : 1) : l.compare(r);
+
+    return lneg ? -ret : ret;
+}
+
+/*!
+ * \brief Evaluates RouterOS query words against a sentence the same way the
+ *        router does: each word pushes a value to a stack, `?#' words operate
+ *        on the stack, and the remaining values are and-ed together
+ *
+ * \param [in] words The query words
+ * \param [in] data  The sentence to evaluate the query against
+ *
+ * \return The query result
+ */
+inline auto evaluate_query(const std::vector<std::string> &words,
+                           const tikpp::sentence &         data) -> bool {
+    std::vector<bool> stack {};
+    query_word        qw {};
+
+    const auto pop = [&stack]() {
+        if (stack.empty()) {
+            return false;
+        }
+
+        bool ret = stack.back();
+        stack.pop_back();
+        return ret;
+    };
+
+    for (const auto &word : words) {
+        if (!parse_query_word(word, qw)) {
+            return false;
+        }
+
+        switch (qw.type) {
+        case query_word::kind::exists:
+            stack.push_back(data.contains(qw.name));
+            break;
+        case query_word::kind::not_exists:
+            stack.push_back(!data.contains(qw.name));
+            break;
+        case query_word::kind::equals:
+        case query_word::kind::less:
+        case query_word::kind::greater: {
+            if (!data.contains(qw.name)) {
+                stack.push_back(false);
+                break;
+            }
+
+            auto cmp =
+                compare_values(data.get<std::string>(qw.name), qw.value);
+
+            stack.push_back(qw.type == query_word::kind::equals ? cmp == 0
+                            : qw.type == query_word::kind::less ? cmp < 0
+                                                                : cmp > 0);
+            break;
+        }
+        case query_word::kind::operation:
+            for (auto op : qw.value) {
+                if (op == '!') {
+                    stack.push_back(!pop());
+                } else if (op == '&') {
+                    auto rhs = pop(), lhs = pop();
+                    stack.push_back(lhs && rhs);
+                } else if (op == '|') {
+                    auto rhs = pop(), lhs = pop();
+                    stack.push_back(lhs || rhs);
+                } else if (op == '.') {
+                    stack.push_back(!stack.empty() && stack.back());
+                } else {
+                    return false;
+                }
+            }
+            break;
+        }
+    }
+
+    return std::all_of(stack.begin(), stack.end(), [](bool v) { return v; });
+}
+
+/*!
+ * \brief Gets the number of values which query words leave on the stack,
+ *        which the router then and-s together implicitly
+ *
+ * \param [in] words The query words
+ *
+ * \return The number of values left on the stack
+ */
+inline auto query_depth(const std::vector<std::string> &words) -> std::size_t {
+    std::size_t depth {0};
+    query_word  qw {};
+
+    for (const auto &word : words) {
+        if (!parse_query_word(word, qw)) {
+            continue;
+        }
+
+        if (qw.type != query_word::kind::operation) {
+            ++depth;
+            continue;
+        }
+
+        for (auto op : qw.value) {
+            if (op == '!') {
+                depth = std::max<std::size_t>(depth, 1);
+            } else if (op == '&' || op == '|') {
+                depth = (depth > 2 ? depth - 2 : 0) + 1;
+            } else if (op == '.') {
+                ++depth;
+            }
+        }
+    }
+
+    return depth;
+}
+
+/*!
+ * \brief Gets the names of the fields referenced by query words
+ *
+ * \param [in] words The query words
+ *
+ * \return The referenced field names, without duplicates
+ */
+inline auto query_fields(const std::vector<std::string> &words)
+    -> std::vector<std::string> {
+    std::vector<std::string> ret {};
+    query_word               qw {};
+
+    for (const auto &word : words) {
+        if (parse_query_word(word, qw) &&
+            qw.type != query_word::kind::operation &&
+            std::find(ret.begin(), ret.end(), qw.name) == ret.end()) {
+            ret.push_back(qw.name);
+        }
+    }
+
+    return ret;
+}
+
+} // namespace tikpp::detail
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef TIKPP_DETAIL_SENTENCE_READER_HPP
+#define TIKPP_DETAIL_SENTENCE_READER_HPP
+
+#include "tikpp/error_code.hpp"
+#include "tikpp/response.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tikpp::detail {
+
+/*!
+ * \brief Makes a response of the words of a read sentence, or sets an error
+ *        if the sentence is not a valid tagged response
+ */
+inline auto to_response(const std::vector<std::string> &words,
+                        boost::system::error_code &     err)
+    -> tikpp::response {
+    if (!tikpp::response::is_valid_response(words)) {
+        err = tikpp::make_error_code(tikpp::error_code::invalid_response);
+        return {};
+    }
+
+    tikpp::response resp {words};
+
+    if (resp.type() == tikpp::response_type::fatal) {
+        err = tikpp::make_error_code(tikpp::error_code::fatal_response);
+        return {};
+    }
+
+    if (!resp.tag().has_value()) {
+        err = tikpp::make_error_code(tikpp::error_code::untagged_response);
+        return {};
+    }
+
+    return resp;
+}
+
+/*!
+ * \brief Decodes sentences out of data which is read in chunks of any size
+ *
+ * The data is read into a single buffer (\see prepare), whole words are taken
+ * out of it as soon as they are read, and only a partly read word is moved
+ * back to the front of the buffer to make room for more data.
+ */
+struct sentence_reader {
+    explicit sentence_reader(std::size_t read_size) : read_size_ {read_size} {
+        assert(read_size > 0);
+    }
+
+    /*!
+     * \brief Gets the buffer which the next read is made into, of at least
+     *        the read size
+     */
+    inline auto prepare() -> boost::asio::mutable_buffer {
+        if (begin_ == end_) {
+            begin_ = end_ = 0;
+        } else if (begin_ > 0 && buf_.size() - end_ < read_size_) {
+            std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+
+        if (buf_.size() - end_ < read_size_) {
+            buf_.resize(end_ + read_size_);
+        }
+
+        return boost::asio::buffer(buf_.data() + end_, buf_.size() - end_);
+    }
+
+    /*!
+     * \brief Adds the bytes which were read into the prepared buffer
+     */
+    inline void commit(std::size_t size) noexcept {
+        assert(end_ + size <= buf_.size());
+        end_ += size;
+    }
+
+    /*!
+     * \brief Decodes the next sentence, if it has been read whole
+     *
+     * \param [out] words The words of the sentence
+     * \param [out] err   Set if an invalid word length was read
+     *
+     * \return The size of the sentence in bytes, or zero if it has not been
+     *         read whole yet
+     */
+    inline auto next(std::vector<std::string> &  words,
+                     boost::system::error_code &err) -> std::size_t {
+        while (begin_ < end_) {
+            std::uint32_t length {0};
+            auto          prefix = decode_length(length, err);
+
+            if (err || prefix == 0 || end_ - begin_ - prefix < length) {
+                return 0;
+            }
+
+            const auto *word = buf_.data() + begin_ + prefix;
+            begin_ += prefix + length;
+            sentence_size_ += prefix + length;
+
+            if (length == 0) {
+                words = std::move(words_);
+                words_.clear();
+                return std::exchange(sentence_size_, 0);
+            }
+
+            words_.emplace_back(reinterpret_cast<const char *>(word), length);
+        }
+
+        return 0;
+    }
+
+    /*!
+     * \brief Gets the number of read bytes which are not decoded yet
+     */
+    [[nodiscard]] inline auto buffered() const noexcept -> std::size_t {
+        return end_ - begin_;
+    }
+
+    /*!
+     * \brief Drops all the read data, e.g. when the connection is closed
+     */
+    inline void clear() noexcept {
+        begin_ = end_  = 0;
+        sentence_size_ = 0;
+        words_.clear();
+    }
+
+  private:
+    /*
+     * Decodes the length prefix of the next word, and returns its size, or
+     * zero if it has not been read whole yet
+     */
+    inline auto decode_length(std::uint32_t &            length,
+                              boost::system::error_code &err) const
+        -> std::size_t {
+        const auto *data  = buf_.data() + begin_;
+        auto        first = data[0];
+
+        std::size_t missing {0};
+
+        if ((first & 0x80) == 0x00) {
+            length = first;
+            return 1;
+        } else if ((first & 0xC0) == 0x80) {
+            length  = first & ~0xC0;
+            missing = 1;
+        } else if ((first & 0xE0) == 0xC0) {
+            length  = first & ~0xE0;
+            missing = 2;
+        } else if ((first & 0xF0) == 0xE0) {
+            length  = first & ~0xF0;
+            missing = 3;
+        } else if (first == 0xF0) {
+            missing = 4;
+        } else {
+            err = boost::asio::error::message_size;
+            return 0;
+        }
+
+        if (end_ - begin_ < missing + 1) {
+            return 0;
+        }
+
+        for (std::size_t i {1}; i <= missing; ++i) {
+            length = (length << 8) | data[i];
+        }
+
+        return missing + 1;
+    }
+
+    std::size_t               read_size_;
+    std::vector<std::uint8_t> buf_;
+    std::size_t               begin_ {0};
+    std::size_t               end_ {0};
+
+    std::vector<std::string> words_;
+    std::size_t              sentence_size_ {0};
+};
+
+} // namespace tikpp::detail
+
+#endif
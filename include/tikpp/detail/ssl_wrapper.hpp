@@ -2,34 +2,170 @@
 #define TIKPP_DETAIL_SSL_SOCKET_HPP
 
 #include "tikpp/detail/async_result.hpp"
-#include "tikpp/io_context.hpp"
+#include "tikpp/ssl_context.hpp"
+#include "tikpp/tls_session_cache.hpp"
 
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/ssl/context.hpp>
+#include <boost/asio/ssl/error.hpp>
 #include <boost/asio/ssl/stream.hpp>
+#include <boost/system/error_code.hpp>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && OPENSSL_VERSION_NUMBER >= 0x30000000L && \
+    !defined(OPENSSL_NO_KTLS)
+#define TIKPP_HAS_KERNEL_TLS 1
+#endif
 
 namespace tikpp::detail {
 
+/*!
+ * \brief An SSL/TLS stream over another stream
+ *
+ * The SSL context is shared by default (\see tikpp::default_ssl_context), and
+ * the sessions of the routers are cached (\see tikpp::tls_session_cache), so
+ * reconnecting resumes the previous session rather than doing a full
+ * handshake. The `ssl_verify' parameter selects the default context, and is
+ * ignored if another context is set.
+ *
+ * Decrypted data is read a record at a time into a buffer, which the small
+ * reads of the sentence decoder are served from without going through the
+ * SSL engine.
+ *
+ * On Linux, the record encryption can be offloaded to the kernel (kTLS, \see
+ * kernel_tls), in which case OpenSSL works on the socket itself rather than
+ * through Asio's SSL engine.
+ */
 template <typename AsyncStream, bool ssl_verify = false>
 struct ssl_wrapper final {
-    using executor_type = boost::asio::io_context::executor_type;
+    using executor_type =
+        typename boost::asio::ssl::stream<AsyncStream>::executor_type;
 
-    ssl_wrapper(tikpp::io_context &io)
-        : ctx_ {boost::asio::ssl::context::sslv23_client}, stream_ {io, ctx_} {
+    /*!
+     * \brief The size of the buffer which decrypted data is read into, which
+     *        is the largest TLS record payload
+     */
+    static constexpr std::size_t read_buffer_size = 16 * 1024;
 
-        using ctx = std::decay_t<decltype(ctx_)>;
+    /*!
+     * \brief Creates the wrapped stream from an execution context (e.g.
+     *        \see tikpp::io_context) or an executor
+     */
+    template <typename Context>
+    ssl_wrapper(Context &&ctx)
+        : ctx_ {tikpp::default_ssl_context(ssl_verify)},
+          sessions_ {tikpp::default_tls_session_cache()},
+          conn_ {std::make_shared<connection>(std::forward<Context>(ctx),
+                                              *ctx_)} {
+    }
 
-        if constexpr (ssl_verify) {
-            ctx_.set_verify_mode(boost::asio::ssl::context::verify_peer);
-            ctx_.set_default_verify_paths();
+    inline auto get_executor() const noexcept -> executor_type {
+        return conn_->stream.lowest_layer().get_executor();
+    }
 
-        } else {
-            ctx_.set_verify_mode(boost::asio::ssl::context::verify_none);
-        }
+    [[nodiscard]] inline auto context() const noexcept
+        -> const std::shared_ptr<boost::asio::ssl::context> & {
+        return ctx_;
     }
 
-    inline auto get_executor() const noexcept -> executor_type {
-        return stream_.get_executor();
+    /*!
+     * \brief Sets the SSL context, which may be shared with other
+     *        connections (\see tikpp::make_ssl_context). Must be called while
+     *        the stream is closed
+     *
+     * \param [in] ctx The SSL context
+     */
+    inline void context(std::shared_ptr<boost::asio::ssl::context> ctx) {
+        assert(ctx != nullptr && !is_open());
+
+        ctx_ = std::move(ctx);
+        reset();
+    }
+
+    [[nodiscard]] inline auto session_cache() const noexcept
+        -> const std::shared_ptr<tikpp::tls_session_cache> & {
+        return sessions_;
+    }
+
+    /*!
+     * \brief Sets the cache which TLS sessions are resumed from
+     *
+     * \param [in] sessions The session cache, or null to always do full
+     *                      handshakes
+     */
+    inline void
+    session_cache(std::shared_ptr<tikpp::tls_session_cache> sessions) {
+        sessions_ = std::move(sessions);
+    }
+
+    [[nodiscard]] inline auto kernel_tls() const noexcept -> bool {
+        return kernel_tls_;
+    }
+
+    /*!
+     * \brief Sets whether the next connections try to offload the record
+     *        encryption to the kernel (kTLS). A connection falls back to
+     *        OpenSSL's own encryption if the kernel, the OpenSSL build or the
+     *        negotiated cipher does not support it (\see kernel_tls_send and
+     *        \see kernel_tls_recv). Ignored on other platforms than Linux
+     *
+     * \param [in] enabled Whether kTLS is used
+     */
+    inline void kernel_tls(bool enabled) noexcept {
+#ifdef TIKPP_HAS_KERNEL_TLS
+        kernel_tls_ = enabled;
+#else
+        (void)enabled;
+#endif
+    }
+
+    /*!
+     * \brief Gets whether the kernel encrypts the written records
+     */
+    [[nodiscard]] inline auto kernel_tls_send() const noexcept -> bool {
+#ifdef TIKPP_HAS_KERNEL_TLS
+        return conn_->on_socket &&
+               BIO_get_ktls_send(
+                   ::SSL_get_wbio(conn_->stream.native_handle())) != 0;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Gets whether the kernel decrypts the read records
+     */
+    [[nodiscard]] inline auto kernel_tls_recv() const noexcept -> bool {
+#ifdef TIKPP_HAS_KERNEL_TLS
+        return conn_->on_socket &&
+               BIO_get_ktls_recv(
+                   ::SSL_get_rbio(conn_->stream.native_handle())) != 0;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Gets whether the last handshake resumed a cached session
+     */
+    [[nodiscard]] inline auto session_reused() const noexcept -> bool {
+        return ::SSL_session_reused(conn_->stream.native_handle()) == 1;
     }
 
     template <typename CompletionToken>
@@ -40,42 +176,325 @@ struct ssl_wrapper final {
             void(const boost::system::error_code &, std::size_t), token,
             handler, result);
 
-        return stream_.lowest_layer().async_connect(
+        return conn_->stream.lowest_layer().async_connect(
             ep, [this, handler {std::move(handler)}](const auto &err) mutable {
                 if (err) {
                     handler(err);
                 } else {
-                    stream_.async_handshake(decltype(stream_)::client,
-                                            std::move(handler));
+                    async_handshake(std::move(handler));
                 }
             });
     }
 
+    /*!
+     * \brief Asynchronously performs the client handshake on a connected
+     *        lowest layer, resuming the cached session of the router if
+     *        there is one
+     */
+    template <typename CompletionToken>
+    inline decltype(auto) async_handshake(CompletionToken &&token) {
+        GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
+                                    token, handler, result);
+
+        auto *ssl   = conn_->stream.native_handle();
+        conn_->slot = {sessions_, session_key()};
+
+        if (sessions_ != nullptr && !conn_->slot.key.empty()) {
+            if (auto session = sessions_->lookup(conn_->slot.key)) {
+                ::SSL_set_session(ssl, session.get());
+            }
+
+            ::SSL_set_ex_data(ssl, tikpp::detail::tls_session_slot_index(),
+                              &conn_->slot);
+        }
+
+        auto ex = boost::asio::get_associated_executor(handler, get_executor());
+        auto done = boost::asio::bind_executor(
+            ex, [conn = conn_, handler {std::move(handler)}](
+                    const boost::system::error_code &err, auto &&...) mutable {
+                // The cached session may be what the router rejected
+                if (err && conn->slot.cache != nullptr) {
+                    conn->slot.cache->erase(conn->slot.key);
+                }
+
+                handler(err);
+            });
+
+#ifdef TIKPP_HAS_KERNEL_TLS
+        if (kernel_tls_) {
+            // OpenSSL only offloads to the kernel when it does the IO itself
+            auto &sock = conn_->stream.lowest_layer();
+            sock.non_blocking(true);
+
+            ::SSL_set_fd(ssl, static_cast<int>(sock.native_handle()));
+            ::SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);
+            ::SSL_set_connect_state(ssl);
+            conn_->on_socket = true;
+
+            run_on_socket(
+                conn_, [](SSL *ssl) { return ::SSL_do_handshake(ssl); }, ex,
+                std::move(done));
+
+            return result.get();
+        }
+#endif
+
+        conn_->stream.async_handshake(boost::asio::ssl::stream_base::client,
+                                      std::move(done));
+
+        return result.get();
+    }
+
+    inline auto lowest_layer() noexcept -> decltype(auto) {
+        return conn_->stream.lowest_layer();
+    }
+
+    /*!
+     * \brief Closes the stream. The SSL state is dropped, so the stream can be
+     *        connected again
+     */
     inline void close() {
-        stream_.lowest_layer().close();
+        // OpenSSL drops the session of an SSL which is freed without having
+        // sent a shutdown alert, which would prevent resuming it
+        ::SSL_set_shutdown(conn_->stream.native_handle(), SSL_SENT_SHUTDOWN);
+
+        conn_->stream.lowest_layer().close();
+        reset();
     }
 
     inline bool is_open() const noexcept {
-        return stream_.lowest_layer().is_open();
+        return conn_->stream.lowest_layer().is_open();
     }
 
     template <typename CompletionToken>
-    inline void async_read_some(boost::asio::mutable_buffer buf,
-                                CompletionToken &&          token) {
-        return stream_.async_read_some(buf,
-                                       std::forward<CompletionToken>(token));
+    inline decltype(auto) async_read_some(boost::asio::mutable_buffer buf,
+                                          CompletionToken &&          token) {
+        GENERATE_COMPLETION_HANDLER(
+            void(const boost::system::error_code &, std::size_t), token,
+            handler, result);
+
+        auto ex = boost::asio::get_associated_executor(handler, get_executor());
+
+        if (conn_->buffered() > 0 || buf.size() == 0) {
+            auto len = conn_->take(buf);
+            boost::asio::post(
+                ex, [handler {std::move(handler)}, len]() mutable {
+                    handler(boost::system::error_code {}, len);
+                });
+
+            return result.get();
+        }
+
+        if (conn_->on_socket) {
+            run_on_socket(
+                conn_,
+                [conn = conn_.get()](SSL *ssl) {
+                    return ::SSL_read(ssl, conn->input.data(),
+                                      static_cast<int>(conn->input.size()));
+                },
+                ex,
+                [conn = conn_, buf, handler {std::move(handler)}](
+                    const boost::system::error_code &err,
+                    std::size_t                      len) mutable {
+                    conn->input_begin = 0;
+                    conn->input_end   = len;
+                    handler(err, conn->take(buf));
+                });
+
+            return result.get();
+        }
+
+        conn_->stream.async_read_some(
+            boost::asio::buffer(conn_->input),
+            boost::asio::bind_executor(
+                ex, [conn = conn_, buf, handler {std::move(handler)}](
+                        const boost::system::error_code &err,
+                        std::size_t                      len) mutable {
+                    conn->input_begin = 0;
+                    conn->input_end   = len;
+                    handler(err, conn->take(buf));
+                }));
+
+        return result.get();
     }
 
     template <typename CompletionToken>
-    inline void async_write_some(boost::asio::const_buffer buf,
-                                 CompletionToken &&        token) {
-        return stream_.async_write_some(std::move(buf),
-                                        std::forward<CompletionToken>(token));
+    inline decltype(auto) async_write_some(boost::asio::const_buffer buf,
+                                           CompletionToken &&        token) {
+        GENERATE_COMPLETION_HANDLER(
+            void(const boost::system::error_code &, std::size_t), token,
+            handler, result);
+
+        if (conn_->on_socket) {
+            auto ex =
+                boost::asio::get_associated_executor(handler, get_executor());
+
+            if (buf.size() == 0) {
+                boost::asio::post(ex,
+                                  [handler {std::move(handler)}]() mutable {
+                                      handler(boost::system::error_code {}, 0);
+                                  });
+            } else {
+                run_on_socket(
+                    conn_,
+                    [buf](SSL *ssl) {
+                        return ::SSL_write(ssl, buf.data(),
+                                           static_cast<int>(buf.size()));
+                    },
+                    ex, std::move(handler));
+            }
+
+            return result.get();
+        }
+
+        conn_->stream.async_write_some(buf, keep_alive(std::move(handler)));
+        return result.get();
     }
 
   private:
-    boost::asio::ssl::context             ctx_;
-    boost::asio::ssl::stream<AsyncStream> stream_;
+    /*
+     * The SSL stream of a connection, where its sessions are cached, and its
+     * decrypted data which has not been read yet
+     */
+    struct connection {
+        template <typename Context>
+        connection(Context &&ctx, boost::asio::ssl::context &ssl_ctx)
+            : stream {std::forward<Context>(ctx), ssl_ctx},
+              input(read_buffer_size) {
+        }
+
+        [[nodiscard]] inline auto buffered() const noexcept -> std::size_t {
+            return input_end - input_begin;
+        }
+
+        inline auto take(boost::asio::mutable_buffer buf) noexcept
+            -> std::size_t {
+            auto len = boost::asio::buffer_copy(
+                buf, boost::asio::buffer(input.data() + input_begin,
+                                         buffered()));
+            input_begin += len;
+            return len;
+        }
+
+        boost::asio::ssl::stream<AsyncStream> stream;
+        tikpp::detail::tls_session_slot       slot {};
+        bool                                  on_socket {false};
+
+        std::vector<std::uint8_t> input;
+        std::size_t               input_begin {0};
+        std::size_t               input_end {0};
+    };
+
+    /*
+     * Pending SSL operations refer to their stream, so a stream which is
+     * replaced after being closed is kept until they have completed
+     */
+    template <typename Handler>
+    inline auto keep_alive(Handler &&handler) {
+        auto ex = boost::asio::get_associated_executor(handler, get_executor());
+
+        return boost::asio::bind_executor(
+            ex, [conn = conn_, handler {std::forward<Handler>(handler)}](
+                    const boost::system::error_code &err,
+                    std::size_t                      len) mutable {
+                handler(err, len);
+            });
+    }
+
+    /*
+     * Runs an OpenSSL call of a connection which does its own IO (i.e. with
+     * kTLS) until it completes, waiting for the socket whenever it would
+     * block, and passes its result to a handler on an executor. Retries run
+     * on that executor too, so all the OpenSSL calls of a connection stay on
+     * the caller's strand
+     */
+    template <typename Operation, typename Executor, typename Handler>
+    static void run_on_socket(std::shared_ptr<connection> conn,
+                              Operation                   op,
+                              const Executor &            ex,
+                              Handler &&                  handler) {
+        ::ERR_clear_error();
+
+        auto ret         = op(conn->stream.native_handle());
+        auto errno_value = errno;
+
+        if (ret > 0) {
+            boost::asio::post(ex, [handler {std::forward<Handler>(handler)},
+                                   ret]() mutable {
+                handler(boost::system::error_code {},
+                        static_cast<std::size_t>(ret));
+            });
+
+            return;
+        }
+
+        auto err = ::SSL_get_error(conn->stream.native_handle(), ret);
+
+        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+            auto &sock = conn->stream.lowest_layer();
+            sock.async_wait(
+                err == SSL_ERROR_WANT_READ
+                    ? boost::asio::socket_base::wait_read
+                    : boost::asio::socket_base::wait_write,
+                boost::asio::bind_executor(
+                    ex, [conn, op, ex,
+                         handler {std::forward<Handler>(handler)}](
+                            const boost::system::error_code &err) mutable {
+                        if (err) {
+                            return handler(err, 0);
+                        }
+
+                        run_on_socket(std::move(conn), std::move(op), ex,
+                                      std::move(handler));
+                    }));
+
+            return;
+        }
+
+        auto code = socket_error(err, errno_value);
+        boost::asio::post(
+            ex, [handler {std::forward<Handler>(handler)}, code]() mutable {
+                handler(code, 0);
+            });
+    }
+
+    static inline auto socket_error(int err, int errno_value)
+        -> boost::system::error_code {
+        if (err == SSL_ERROR_ZERO_RETURN) {
+            return boost::asio::error::eof;
+        }
+
+        if (auto code = ::ERR_get_error(); code != 0) {
+            return {static_cast<int>(code),
+                    boost::asio::error::get_ssl_category()};
+        }
+
+        if (err == SSL_ERROR_SYSCALL && errno_value != 0) {
+            return {errno_value, boost::system::system_category()};
+        }
+
+        return boost::asio::ssl::error::stream_truncated;
+    }
+
+    inline void reset() {
+        conn_ = std::make_shared<connection>(get_executor(), *ctx_);
+    }
+
+    inline auto session_key() const -> std::string {
+        boost::system::error_code ec {};
+        auto ep = conn_->stream.lowest_layer().remote_endpoint(ec);
+
+        if (ec) {
+            return {};
+        }
+
+        return ep.address().to_string() + ':' + std::to_string(ep.port());
+    }
+
+    std::shared_ptr<boost::asio::ssl::context> ctx_;
+    std::shared_ptr<tikpp::tls_session_cache>  sessions_;
+    std::shared_ptr<connection>                conn_;
+    bool                                       kernel_tls_ {false};
 };
 
 } // namespace tikpp::detail
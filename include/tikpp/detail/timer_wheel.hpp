@@ -0,0 +1,208 @@
+#ifndef TIKPP_DETAIL_TIMER_WHEEL_HPP
+#define TIKPP_DETAIL_TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <list>
+#include <utility>
+
+namespace tikpp::detail {
+
+/*!
+ * \brief A hierarchical timer wheel, which keeps a large number of deadlines
+ *        with O(1) scheduling and cancellation
+ *
+ * Time is measured in ticks, which are advanced by the owner (e.g. from a
+ * single periodic timer). Level 0 has a slot for each of the next
+ * \ref slots ticks, and each higher level has a slot for \ref slots times
+ * the ticks of the level below it. Entries are moved down one level when
+ * the wheel reaches their slot, until they expire from level 0. Deadlines
+ * further than the top level covers are kept in the top level, and are
+ * moved around it until they fit.
+ *
+ * \tparam T The type of the values associated with the deadlines
+ */
+template <typename T>
+struct timer_wheel {
+    static constexpr std::size_t slot_bits = 6;
+    static constexpr std::size_t slots     = std::size_t {1} << slot_bits;
+    static constexpr std::size_t levels    = 4;
+
+    struct entry {
+        std::uint64_t deadline;
+        T             value;
+        std::size_t   level;
+        std::size_t   slot;
+    };
+
+    /*!
+     * \brief A handle to a scheduled entry, which is valid until the entry
+     *        either expires or is cancelled
+     */
+    using handle = typename std::list<entry>::iterator;
+
+    /*!
+     * \brief Creates an empty wheel
+     *
+     * \param [in] now The current tick
+     */
+    explicit timer_wheel(std::uint64_t now = 0) : next_ {now + 1} {
+    }
+
+    /*!
+     * \brief Schedules a value to expire at a tick. Deadlines which already
+     *        passed expire on the next tick
+     *
+     * \param [in] deadline The tick at which the value expires
+     * \param [in] value    The value to be passed back on expiration
+     *
+     * \return A handle which can be used to cancel the entry
+     */
+    inline auto schedule(std::uint64_t deadline, T value) -> handle {
+        auto [level, slot] = locate(deadline, next_);
+        auto &list         = wheel_[level][slot];
+
+        list.push_back(entry {deadline, std::move(value), level, slot});
+        ++size_;
+
+        return std::prev(list.end());
+    }
+
+    /*!
+     * \brief Removes a scheduled entry before it expires
+     *
+     * \param [in] h The entry handle
+     */
+    inline void cancel(handle h) {
+        wheel_[h->level][h->slot].erase(h);
+        --size_;
+    }
+
+    /*!
+     * \brief Advances the wheel up to a tick (inclusive), passing the values
+     *        of the expired entries to a callable object
+     *
+     * \param [in] now        The current tick
+     * \param [in] on_expired The callable object, which is called with each
+     *                        expired value
+     */
+    template <typename Callable>
+    inline void advance(std::uint64_t now, Callable &&on_expired) {
+        // Nothing can expire, so idle periods are skipped at once
+        if (size_ == 0) {
+            return reset(now);
+        }
+
+        for (; next_ <= now; ++next_) {
+            cascade(next_);
+
+            auto &list = wheel_[0][next_ & (slots - 1)];
+
+            while (!list.empty()) {
+                auto value = std::move(list.front().value);
+                list.pop_front();
+                --size_;
+
+                on_expired(std::move(value));
+            }
+        }
+    }
+
+    /*!
+     * \brief Moves an empty wheel on to a tick. An owner which stops
+     *        advancing the wheel while it is empty calls it before
+     *        scheduling again, so that the next advance does not walk through
+     *        all the idle ticks
+     *
+     * \param [in] now The current tick
+     */
+    inline void reset(std::uint64_t now) noexcept {
+        assert(size_ == 0);
+        next_ = std::max(next_, now + 1);
+    }
+
+    /*!
+     * \brief Gets the next tick to be processed
+     */
+    [[nodiscard]] inline auto next_tick() const noexcept -> std::uint64_t {
+        return next_;
+    }
+
+    //! \brief Removes all the scheduled entries
+    inline void clear() noexcept {
+        for (auto &level : wheel_) {
+            for (auto &list : level) {
+                list.clear();
+            }
+        }
+
+        size_ = 0;
+    }
+
+    [[nodiscard]] inline auto empty() const noexcept -> bool {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] inline auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+  private:
+    // Finds the slot of a deadline, relative to the next tick to be processed
+    static inline auto locate(std::uint64_t deadline, std::uint64_t ref)
+        -> std::pair<std::size_t, std::size_t> {
+        if (deadline <= ref) {
+            return {0, ref & (slots - 1)};
+        }
+
+        auto delta = deadline - ref;
+
+        for (std::size_t level {0}; level < levels; ++level) {
+            if (delta < (std::uint64_t {1} << (slot_bits * (level + 1)))) {
+                return {level,
+                        (deadline >> (slot_bits * level)) & (slots - 1)};
+            }
+        }
+
+        // Parked in the furthest slot of the top level, until it gets closer
+        constexpr auto top   = levels - 1;
+        auto           limit = ref + (std::uint64_t {1} << (slot_bits * levels));
+        return {top, ((limit - 1) >> (slot_bits * top)) & (slots - 1)};
+    }
+
+    // Moves the entries of the higher level slots which start at a tick down
+    inline void cascade(std::uint64_t tick) {
+        std::size_t top {0};
+
+        while (top + 1 < levels &&
+               (tick & ((std::uint64_t {1} << (slot_bits * (top + 1))) - 1)) ==
+                   0) {
+            ++top;
+        }
+
+        for (auto level = top; level > 0; --level) {
+            auto &from =
+                wheel_[level][(tick >> (slot_bits * level)) & (slots - 1)];
+
+            while (!from.empty()) {
+                auto itr           = from.begin();
+                auto [lower, slot] = locate(itr->deadline, tick);
+
+                itr->level = lower;
+                itr->slot  = slot;
+                wheel_[lower][slot].splice(wheel_[lower][slot].end(), from,
+                                           itr);
+            }
+        }
+    }
+
+    std::array<std::array<std::list<entry>, slots>, levels> wheel_ {};
+    std::uint64_t                                           next_;
+    std::size_t                                             size_ {0};
+};
+
+} // namespace tikpp::detail
+
+#endif
@@ -18,7 +18,7 @@ struct is_error_handler<
     : std::true_type {};
 
 template <typename T>
-constexpr auto is_error_handler_v = is_error_handler<T>::value;
+constexpr bool is_error_handler_v = is_error_handler<T>::value;
 
 } // namespace tikpp::detail::type_traits
 
@@ -24,15 +24,15 @@ HAS_MEMBER_FUNCTION(async_read_some,
 HAS_MEMBER_FUNCTION(get_executor, ())
 
 template <typename T>
-constexpr auto                  is_async_write_stream_v =
+constexpr bool is_async_write_stream_v =
     has_async_write_some_v<T> &&has_get_executor_v<T>;
 
 template <typename T>
-constexpr auto                 is_async_read_stream_v =
+constexpr bool is_async_read_stream_v =
     has_async_read_some_v<T> &&has_get_executor_v<T>;
 
 template <typename T>
-constexpr auto                   is_async_stream_v =
+constexpr bool is_async_stream_v =
     is_async_write_stream_v<T> &&is_async_read_stream_v<T>;
 
 } // namespace tikpp::detail::type_traits
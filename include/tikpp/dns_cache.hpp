@@ -0,0 +1,186 @@
+#ifndef TIKPP_DNS_CACHE_HPP
+#define TIKPP_DNS_CACHE_HPP
+
+#include "tikpp/resolver.hpp"
+
+#include <boost/asio/ip/address.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tikpp {
+
+/*!
+ * \brief A cache of host name resolutions which may be shared by many API
+ *        connections (and threads)
+ *
+ * Resolved addresses are kept for a fixed time to live; the system resolver
+ * does not report the TTLs of the DNS records, so it is configured instead.
+ * While a host name is being resolved, other lookups of it wait for that
+ * resolution rather than starting their own, so a fleet of connections which
+ * reconnect at once resolves each name only once. Failed resolutions are not
+ * cached.
+ */
+struct dns_cache {
+    using clock = std::chrono::steady_clock;
+
+    /*!
+     * \brief Creates an empty cache
+     *
+     * \param [in] ttl The time which resolved addresses are kept for. A zero
+     *                 TTL only joins concurrent lookups of the same name
+     */
+    explicit dns_cache(std::chrono::milliseconds ttl = std::chrono::seconds {
+                           30}) noexcept
+        : ttl_ {ttl} {
+    }
+
+    /*!
+     * \brief Gets the time which resolved addresses are kept for
+     */
+    [[nodiscard]] inline auto ttl() const -> std::chrono::milliseconds {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return ttl_;
+    }
+
+    /*!
+     * \brief Sets the time which resolved addresses are kept for. Addresses
+     *        which are already cached keep their expiry
+     */
+    inline void ttl(std::chrono::milliseconds ttl) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        ttl_ = ttl;
+    }
+
+    /*!
+     * \brief Gets the cached addresses of a host, if they have not expired
+     *
+     * \param [in] host The host name
+     */
+    [[nodiscard]] inline auto lookup(const std::string &host)
+        -> std::optional<std::vector<boost::asio::ip::address>> {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return lookup_locked(host);
+    }
+
+    /*!
+     * \brief Gets the addresses of a host from the cache, or resolves them
+     *        if they are not cached
+     *
+     * \param [in] host    The host name
+     * \param [in] resolve The resolver to be used on a cache miss
+     * \param [in] handler The handler to be called with the addresses. It is
+     *                     called from within this call on a cache hit, or
+     *                     from wherever the resolver completes otherwise
+     */
+    void async_resolve(const std::string &    host,
+                       const tikpp::resolver &resolve,
+                       tikpp::resolve_handler handler) {
+        std::unique_lock<std::mutex> lock {mutex_};
+
+        if (auto addresses = lookup_locked(host)) {
+            lock.unlock();
+            return handler({}, std::move(*addresses));
+        }
+
+        auto [it, first] = pending_.try_emplace(host);
+        it->second.push_back(std::move(handler));
+
+        if (!first) {
+            return;
+        }
+
+        lock.unlock();
+
+        resolve(host, [this, host](const auto &err, auto addresses) {
+            std::vector<tikpp::resolve_handler> waiting {};
+
+            {
+                std::lock_guard<std::mutex> lock {mutex_};
+
+                if (!err && !addresses.empty()) {
+                    entries_[host] = {addresses, clock::now() + ttl_};
+                }
+
+                auto it = pending_.find(host);
+                waiting = std::move(it->second);
+                pending_.erase(it);
+            }
+
+            for (auto &handler : waiting) {
+                handler(err, addresses);
+            }
+        });
+    }
+
+    /*!
+     * \brief Removes all of the cached addresses
+     */
+    inline void clear() {
+        std::lock_guard<std::mutex> lock {mutex_};
+        entries_.clear();
+    }
+
+  private:
+    struct entry {
+        std::vector<boost::asio::ip::address> addresses;
+        clock::time_point                     expires;
+    };
+
+    inline auto lookup_locked(const std::string &host)
+        -> std::optional<std::vector<boost::asio::ip::address>> {
+        auto it = entries_.find(host);
+
+        if (it == entries_.end()) {
+            return std::nullopt;
+        }
+
+        if (clock::now() >= it->second.expires) {
+            entries_.erase(it);
+            return std::nullopt;
+        }
+
+        return it->second.addresses;
+    }
+
+    mutable std::mutex        mutex_;
+    std::chrono::milliseconds ttl_;
+
+    std::unordered_map<std::string, entry> entries_;
+    std::unordered_map<std::string, std::vector<tikpp::resolve_handler>>
+        pending_;
+};
+
+/*!
+ * \brief Creates a DNS cache
+ *
+ * \param [in] ttl The time which resolved addresses are kept for
+ *
+ * \return A shared pointer to the created cache
+ */
+[[nodiscard]] inline auto
+make_dns_cache(std::chrono::milliseconds ttl = std::chrono::seconds {30})
+    -> std::shared_ptr<dns_cache> {
+    return std::make_shared<dns_cache>(ttl);
+}
+
+/*!
+ * \brief Gets the process-wide DNS cache, which API connections use unless
+ *        they are given another one
+ */
+[[nodiscard]] inline auto default_dns_cache()
+    -> const std::shared_ptr<dns_cache> & {
+    static const auto cache = tikpp::make_dns_cache();
+    return cache;
+}
+
+} // namespace tikpp
+
+#endif
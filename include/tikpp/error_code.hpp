@@ -33,7 +33,7 @@ enum class [[nodiscard]] error_code : int {
     return_value,      item_already_exists,
     unknown_parameter, login_failure,
     list_end,          unknown_error_category,
-    unknown_error};
+    unknown_error,     router_unhealthy};
 
 inline auto operator==(const boost::system::error_code &lhs,
                        error_code                       rhs) noexcept -> bool {
@@ -0,0 +1,350 @@
+#ifndef TIKPP_FLEET_HPP
+#define TIKPP_FLEET_HPP
+
+#include "tikpp/api.hpp"
+#include "tikpp/basic_api.hpp"
+#include "tikpp/detail/async_result.hpp"
+#include "tikpp/io_context.hpp"
+
+#include "fmt/format.h"
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tikpp {
+
+namespace detail {
+
+/*!
+ * \brief Hashes a string using 64-bit FNV-1a followed by the MurmurHash3
+ *        finalizer, which unlike `std::hash' is stable across platforms and
+ *        runs. The finalizer spreads similar ids (e.g. `router-1' and
+ *        `router-2') over the whole hash ring
+ */
+inline auto stable_hash(const std::string &str) noexcept -> std::uint64_t {
+    std::uint64_t hash {0xcbf29ce484222325};
+
+    for (auto c : str) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+} // namespace detail
+
+/*!
+ * \brief Manages API connections to a large number of routers, sharded over a
+ *        pool of IO contexts which are each run by a single thread
+ *
+ * Routers are identified by a string id, and are assigned to shards using
+ * consistent hashing, so a router stays on the same shard as long as the
+ * number of shards does not change, and only a fraction of the routers move
+ * when it does. Since every connection is only ever run by its shard thread,
+ * connections need no synchronization between each other.
+ *
+ * Opening connections is limited to a maximum number of concurrent attempts,
+ * to avoid flooding the network (and the routers) with handshakes when the
+ * whole fleet is opened at once.
+ */
+template <typename AsyncStream = boost::asio::ip::tcp::socket>
+struct basic_fleet {
+    using api_type = tikpp::basic_api_te<AsyncStream>;
+    using api_ptr  = std::shared_ptr<api_type>;
+
+    /*!
+     * \brief The handler called on fatal connection errors, with the id of
+     *        the router whose connection failed
+     */
+    using error_handler = std::function<void(
+        const std::string &, const boost::system::error_code &)>;
+
+    static constexpr std::size_t virtual_nodes = 128;
+
+    /*!
+     * \brief Creates a fleet with the passed number of shards
+     *
+     * \param [in] shards               The number of shards (and threads)
+     * \param [in] max_concurrent_opens The maximum number of concurrent
+     *                                  connection attempts
+     * \param [in] handler              The handler called on fatal errors
+     */
+    explicit basic_fleet(
+        std::size_t   shards = std::max(std::thread::hardware_concurrency(), 1U),
+        std::size_t   max_concurrent_opens = 64,
+        error_handler handler              = {})
+        : max_concurrent_opens_ {std::max<std::size_t>(max_concurrent_opens,
+                                                       1)},
+          error_handler_ {std::move(handler)} {
+        assert(shards > 0);
+
+        for (std::size_t i {0}; i < shards; ++i) {
+            contexts_.emplace_back(std::make_unique<tikpp::io_context>(1));
+
+            for (std::size_t j {0}; j < virtual_nodes; ++j) {
+                ring_.emplace(
+                    tikpp::detail::stable_hash(fmt::format("{}#{}", i, j)), i);
+            }
+        }
+    }
+
+    basic_fleet(const basic_fleet &) = delete;
+    basic_fleet(basic_fleet &&)      = delete;
+    auto operator=(const basic_fleet &) -> basic_fleet & = delete;
+    auto operator=(basic_fleet &&) -> basic_fleet & = delete;
+
+    ~basic_fleet() {
+        stop();
+    }
+
+    //! \brief Starts running each shard on its own thread
+    inline void start() {
+        assert(threads_.empty());
+
+        for (auto &io : contexts_) {
+            io->restart();
+            guards_.emplace_back(io->get_executor());
+            threads_.emplace_back([&io = *io]() { io.run(); });
+        }
+    }
+
+    /*!
+     * \brief Stops all the shards, and waits for their threads to exit. The
+     *        pending handlers are kept until the fleet is started again
+     */
+    inline void stop() {
+        guards_.clear();
+
+        for (auto &io : contexts_) {
+            io->stop();
+        }
+
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+
+        threads_.clear();
+    }
+
+    /*!
+     * \brief Gets the shard which a router is assigned to
+     *
+     * \param [in] id The router id
+     *
+     * \return The shard index
+     */
+    [[nodiscard]] inline auto shard_of(const std::string &id) const
+        -> std::size_t {
+        auto itr = ring_.lower_bound(tikpp::detail::stable_hash(id));
+        return itr == ring_.end() ? ring_.begin()->second : itr->second;
+    }
+
+    /*!
+     * \brief Gets the number of shards
+     */
+    [[nodiscard]] inline auto shards() const noexcept -> std::size_t {
+        return contexts_.size();
+    }
+
+    /*!
+     * \brief Gets the IO context of a shard
+     */
+    [[nodiscard]] inline auto io_context(std::size_t shard)
+        -> tikpp::io_context & {
+        return *contexts_.at(shard);
+    }
+
+    /*!
+     * \brief Gets the connection of a router, creating it on the router shard
+     *        if it does not exist. The created connection is closed
+     *
+     * \param [in] id The router id
+     *
+     * \return The router connection
+     */
+    inline auto add(const std::string &id) -> api_ptr {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        if (auto itr = routers_.find(id); itr != routers_.end()) {
+            return itr->second;
+        }
+
+        auto api = tikpp::make_api_te<AsyncStream>(
+            *contexts_[shard_of(id)],
+            [id, &handler = error_handler_](const auto &err) {
+                if (handler) {
+                    handler(id, err);
+                }
+            });
+
+        routers_.emplace(id, api);
+        return api;
+    }
+
+    /*!
+     * \brief Gets the connection of a router
+     *
+     * \param [in] id The router id
+     *
+     * \return The router connection, or nullptr if the router was not added
+     */
+    [[nodiscard]] inline auto get(const std::string &id) const -> api_ptr {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        auto itr = routers_.find(id);
+        return itr == routers_.end() ? nullptr : itr->second;
+    }
+
+    /*!
+     * \brief Gets the number of routers in the fleet
+     */
+    [[nodiscard]] inline auto size() const -> std::size_t {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return routers_.size();
+    }
+
+    /*!
+     * \brief Asynchronously opens a connection to a router, then logs in to
+     *        it. The router is added to the fleet if it was not
+     *
+     * The attempt is queued if the maximum number of concurrent attempts is
+     * reached. The handler is called on the router shard thread.
+     *
+     * \param [in]     id       The router id
+     * \param [in]     host     The router host address
+     * \param [in]     port     The API listening port
+     * \param [in]     name     The name used to login
+     * \param [in]     password The password used to login
+     * \param [in,out] token    The asynchronous operation completion token
+     *
+     * \return The passed completion token result
+     */
+    template <typename CompletionToken>
+    decltype(auto) async_open(const std::string &id,
+                              std::string        host,
+                              std::uint16_t      port,
+                              std::string        name,
+                              std::string        password,
+                              CompletionToken && token) {
+        GENERATE_COMPLETION_HANDLER(void(const boost::system::error_code &),
+                                    token, handler, result);
+
+        auto api = add(id);
+
+        enqueue_open(
+            [this, api, shard = shard_of(id), host {std::move(host)}, port,
+             name {std::move(name)}, password {std::move(password)},
+             handler = std::make_shared<handler_type>(std::move(handler))]() {
+                boost::asio::post(*contexts_[shard], [this, api, host, port,
+                                                      name, password,
+                                                      handler]() {
+                    api->async_open(host, port, name, password,
+                                    [this, handler](const auto &err) {
+                                        on_open_done();
+                                        (*handler)(err);
+                                    });
+                });
+            });
+
+        return result.get();
+    }
+
+    /*!
+     * \brief Gets the number of connection attempts which are in progress
+     */
+    [[nodiscard]] inline auto active_opens() const -> std::size_t {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return active_opens_;
+    }
+
+    /*!
+     * \brief Gets the number of connection attempts which are waiting for
+     *        the in progress ones to complete
+     */
+    [[nodiscard]] inline auto pending_opens() const -> std::size_t {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return pending_opens_.size();
+    }
+
+  private:
+    inline void enqueue_open(std::function<void()> open) {
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+
+            if (active_opens_ >= max_concurrent_opens_) {
+                pending_opens_.emplace_back(std::move(open));
+                return;
+            }
+
+            ++active_opens_;
+        }
+
+        open();
+    }
+
+    inline void on_open_done() {
+        std::function<void()> next {};
+
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+
+            if (pending_opens_.empty()) {
+                --active_opens_;
+                return;
+            }
+
+            next = std::move(pending_opens_.front());
+            pending_opens_.pop_front();
+        }
+
+        next();
+    }
+
+    std::size_t   max_concurrent_opens_;
+    error_handler error_handler_;
+
+    std::vector<std::unique_ptr<tikpp::io_context>> contexts_;
+    std::vector<boost::asio::executor_work_guard<
+        tikpp::io_context::executor_type>>
+                             guards_;
+    std::vector<std::thread> threads_;
+
+    std::map<std::uint64_t, std::size_t> ring_;
+
+    mutable std::mutex                       mutex_;
+    std::unordered_map<std::string, api_ptr> routers_;
+    std::deque<std::function<void()>>        pending_opens_;
+    std::size_t                              active_opens_ {0};
+};
+
+/*!
+ * \brief An alias for \see basic_fleet which uses boost::asio::ip::tcp::socket
+ *        as the connection socket
+ */
+using fleet = basic_fleet<>;
+
+} // namespace tikpp
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef TIKPP_FLOW_CONTROL_HPP
+#define TIKPP_FLOW_CONTROL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace tikpp {
+
+/*!
+ * \brief A credit counter used to apply backpressure on a request's responses
+ *
+ * Each response delivered to the request handler consumes one credit. When a
+ * flow runs out of credit, its API connection stops reading from the socket
+ * (which makes TCP push back on the router) until more credit is granted.
+ * Since all the responses share one socket, this pauses the other requests on
+ * the same connection as well.
+ */
+struct flow_control {
+    explicit flow_control(std::size_t credit) : credit_ {credit} {
+    }
+
+    /*!
+     * \brief Grants more credit to the flow, resuming the connection reads if
+     *        the flow was exhausted. Safe to be called from any thread
+     *
+     * \param [in] credit The number of responses to be allowed
+     */
+    inline void grant(std::size_t credit) {
+        if (credit_.fetch_add(credit) == 0 && credit > 0) {
+            std::function<void()> cb {};
+
+            {
+                std::lock_guard<std::mutex> lock {mutex_};
+                cb = resume_cb_;
+            }
+
+            if (cb) {
+                cb();
+            }
+        }
+    }
+
+    /*!
+     * \brief Gets the remaining credit of the flow
+     */
+    [[nodiscard]] inline auto credit() const noexcept -> std::size_t {
+        return credit_.load();
+    }
+
+    /*!
+     * \brief Gets whether the flow ran out of credit or not
+     */
+    [[nodiscard]] inline auto is_exhausted() const noexcept -> bool {
+        return credit_.load() == 0;
+    }
+
+    /*!
+     * \brief Consumes one credit
+     *
+     * \return Whether the flow still has credit or not
+     */
+    inline auto consume() noexcept -> bool {
+        auto current = credit_.load();
+
+        while (current > 0 &&
+               !credit_.compare_exchange_weak(current, current - 1)) {
+        }
+
+        return current > 1;
+    }
+
+    /*!
+     * \brief Sets the function to be called when an exhausted flow gets more
+     *        credit. Used by the API connection
+     */
+    inline void on_resume(std::function<void()> cb) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        resume_cb_ = std::move(cb);
+    }
+
+  private:
+    std::atomic_size_t    credit_;
+    std::mutex            mutex_;
+    std::function<void()> resume_cb_;
+};
+
+/*!
+ * \brief Creates a new flow control object
+ *
+ * \param [in] credit The initial credit of the flow
+ *
+ * \return The created flow control object
+ */
+[[nodiscard]] inline auto make_flow_control(std::size_t credit)
+    -> std::shared_ptr<flow_control> {
+    return std::make_shared<flow_control>(credit);
+}
+
+} // namespace tikpp
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef TIKPP_HEALTH_CHECK_HPP
+#define TIKPP_HEALTH_CHECK_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tikpp {
+
+/*!
+ * \brief Describes how the health of an API connection is checked
+ *
+ * A connection which has read nothing for a whole probe interval sends a
+ * probe request, whose round trip time is tracked (\see rtt_estimator). Probes
+ * which fail or time out, and requests which time out, count as failures, and
+ * enough failures in a row open the circuit breaker of the connection (\see
+ * circuit_breaker), which then fails requests at once instead of queueing
+ * them behind a router which does not answer.
+ */
+struct health_check_policy {
+    //! How long a connection reads nothing before it is probed
+    std::chrono::milliseconds interval {5000};
+
+    //! The time which a probe has to complete within
+    std::chrono::milliseconds timeout {2000};
+
+    //! The command of the probe requests, which should be cheap for the router
+    //! to answer
+    std::string command {"/system/identity/print"};
+
+    //! The number of failures in a row which open the circuit breaker
+    std::size_t failure_threshold {3};
+
+    //! How long the circuit breaker stays open before a probe is sent to find
+    //! out whether the router has recovered
+    std::chrono::milliseconds open_duration {10000};
+};
+
+/*!
+ * \brief Tracks the smoothed round trip time of a connection, and its
+ *        variation, the way TCP does (RFC 6298)
+ *
+ * Only updated from the connection strand, and may be read from any thread.
+ */
+struct rtt_estimator {
+    /*!
+     * \brief Updates the estimate with a measured round trip time
+     */
+    inline void on_sample(std::chrono::nanoseconds rtt) {
+        auto sample = rtt.count();
+
+        if (samples_.load(std::memory_order_relaxed) == 0) {
+            srtt_.store(sample, std::memory_order_relaxed);
+            rttvar_.store(sample / 2, std::memory_order_relaxed);
+        } else {
+            auto srtt   = srtt_.load(std::memory_order_relaxed);
+            auto rttvar = rttvar_.load(std::memory_order_relaxed);
+
+            // RTTVAR is updated with the previous SRTT, so alpha = 1/8 and
+            // beta = 1/4
+            auto delta = sample > srtt ? sample - srtt : srtt - sample;
+            rttvar_.store(rttvar - rttvar / 4 + delta / 4,
+                          std::memory_order_relaxed);
+            srtt_.store(srtt - srtt / 8 + sample / 8,
+                        std::memory_order_relaxed);
+        }
+
+        samples_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Gets the smoothed round trip time, or zero if not measured yet
+     */
+    [[nodiscard]] inline auto srtt() const noexcept
+        -> std::chrono::nanoseconds {
+        return std::chrono::nanoseconds {
+            srtt_.load(std::memory_order_relaxed)};
+    }
+
+    /*!
+     * \brief Gets the round trip time variation
+     */
+    [[nodiscard]] inline auto rttvar() const noexcept
+        -> std::chrono::nanoseconds {
+        return std::chrono::nanoseconds {
+            rttvar_.load(std::memory_order_relaxed)};
+    }
+
+    /*!
+     * \brief Gets the time after which an answer is overdue (i.e. the
+     *        retransmission timeout of TCP, without its one second floor)
+     */
+    [[nodiscard]] inline auto timeout() const noexcept
+        -> std::chrono::nanoseconds {
+        return srtt() + 4 * rttvar();
+    }
+
+    /*!
+     * \brief Gets the number of measured round trips
+     */
+    [[nodiscard]] inline auto samples() const noexcept -> std::size_t {
+        return samples_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<std::int64_t> srtt_ {0};
+    std::atomic<std::int64_t> rttvar_ {0};
+    std::atomic_size_t        samples_ {0};
+};
+
+enum class circuit_state { closed, open, half_open };
+
+/*!
+ * \brief A circuit breaker, which is opened by a number of failures in a row
+ *
+ * Once opened, it waits for a while before going half open, where a single
+ * trial (i.e. a probe) decides whether it closes again or is opened for
+ * another while.
+ *
+ * Only updated from the connection strand, and its state and failure count
+ * may be read from any thread.
+ */
+struct circuit_breaker {
+    using clock = std::chrono::steady_clock;
+
+    explicit circuit_breaker(std::size_t               failure_threshold,
+                             std::chrono::milliseconds open_duration)
+        : failure_threshold_ {std::max<std::size_t>(failure_threshold, 1)},
+          open_duration_ {open_duration} {
+    }
+
+    [[nodiscard]] inline auto state() const noexcept -> circuit_state {
+        return state_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Gets the number of failures since the last success
+     */
+    [[nodiscard]] inline auto failures() const noexcept -> std::size_t {
+        return failures_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Records a success, which closes a half open breaker. An open
+     *        breaker is left open, as it may be an answer to a request which
+     *        was sent before it was opened
+     */
+    inline void on_success() {
+        failures_.store(0, std::memory_order_relaxed);
+
+        if (state() == circuit_state::half_open) {
+            state_.store(circuit_state::closed, std::memory_order_relaxed);
+        }
+    }
+
+    /*!
+     * \brief Records a failure, which opens a half open breaker, or a closed
+     *        one which has reached its failure threshold
+     *
+     * \return Whether the breaker was opened
+     */
+    inline auto on_failure(clock::time_point now = clock::now()) -> bool {
+        auto failures = failures_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        if (state() == circuit_state::open ||
+            (state() == circuit_state::closed &&
+             failures < failure_threshold_)) {
+            return false;
+        }
+
+        opened_at_ = now;
+        state_.store(circuit_state::open, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*!
+     * \brief Makes an open breaker half open once it has been open for long
+     *        enough
+     *
+     * \return Whether the breaker is half open, and a trial can be made
+     */
+    inline auto try_half_open(clock::time_point now = clock::now()) -> bool {
+        if (state() == circuit_state::open && now >= reopens_at()) {
+            state_.store(circuit_state::half_open, std::memory_order_relaxed);
+        }
+
+        return state() == circuit_state::half_open;
+    }
+
+    /*!
+     * \brief Gets the time after which an open breaker can go half open
+     */
+    [[nodiscard]] inline auto reopens_at() const noexcept
+        -> clock::time_point {
+        return opened_at_ + open_duration_;
+    }
+
+  private:
+    std::size_t                failure_threshold_;
+    std::chrono::milliseconds  open_duration_;
+    std::atomic<circuit_state> state_ {circuit_state::closed};
+    std::atomic_size_t         failures_ {0};
+    clock::time_point          opened_at_ {};
+};
+
+} // namespace tikpp
+
+#endif
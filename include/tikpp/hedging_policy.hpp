@@ -0,0 +1,58 @@
+#ifndef TIKPP_HEDGING_POLICY_HPP
+#define TIKPP_HEDGING_POLICY_HPP
+
+#include <chrono>
+#include <cstddef>
+
+namespace tikpp {
+
+/*!
+ * \brief Describes when a connection pool hedges the idempotent reads (i.e.
+ *        `print' and `getall' commands) which it sends
+ *
+ * A read which has not got its first response within a quantile of the
+ * observed latency (p95 by default) is sent again over another session. The
+ * first of the two to respond is taken, and the other one is cancelled on
+ * the router, so one slow session does not dominate the tail latency. How
+ * many reads may be hedged is bounded by a budget, so a router which is slow
+ * on every session is not sent twice the load.
+ */
+struct hedging_policy {
+    //! The quantile of the observed latency after which a read is hedged
+    double quantile {0.95};
+
+    //! The number of the latest latencies which the quantile is taken over
+    std::size_t window {1000};
+
+    //! The number of latencies which have to be observed before any read is
+    //! hedged
+    std::size_t min_samples {100};
+
+    //! The shortest time a read waits before being hedged
+    std::chrono::milliseconds min_delay {1};
+
+    //! The highest ratio of hedged reads to all the reads, in the long run
+    double max_ratio {0.1};
+
+    //! The number of hedges which can be made in a burst, when the budget
+    //! was not used for a while
+    double max_burst {10.0};
+};
+
+/*!
+ * \brief Counters of the hedged reads of a connection pool
+ */
+struct hedging_stats {
+    //! The reads which could be hedged
+    std::size_t reads {0};
+
+    //! The reads which were hedged, i.e. sent over a second session
+    std::size_t hedged {0};
+
+    //! The hedged reads whose second attempt responded first
+    std::size_t won {0};
+};
+
+} // namespace tikpp
+
+#endif
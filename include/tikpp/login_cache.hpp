@@ -0,0 +1,154 @@
+#ifndef TIKPP_LOGIN_CACHE_HPP
+#define TIKPP_LOGIN_CACHE_HPP
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace tikpp {
+
+/*!
+ * \brief The login protocols of RouterOS
+ */
+enum class login_protocol : std::uint8_t {
+    v1, //!< The MD5 challenge-response login, used before RouterOS 6.43
+    v2  //!< The plain name and password login
+};
+
+/*!
+ * \brief A cache of the login protocols which routers were logged in with,
+ *        which may be shared by many API connections (and threads)
+ *
+ * Connections look their router up before logging in: a router which is
+ * known to use the challenge-response protocol is asked for a challenge
+ * straight away, rather than first being sent the password in plain text.
+ * If that fails (e.g. the router was upgraded), the entry is dropped and the
+ * plain login is tried.
+ *
+ * Routers are keyed by their host and API port (i.e. `host:port').
+ */
+struct login_cache {
+    /*!
+     * \brief Gets the protocol which a router was last logged in with
+     *
+     * \param [in] key The router key
+     */
+    [[nodiscard]] inline auto lookup(const std::string &key) const
+        -> std::optional<login_protocol> {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        if (auto it = entries_.find(key); it != entries_.end()) {
+            return it->second;
+        }
+
+        return std::nullopt;
+    }
+
+    /*!
+     * \brief Records the protocol which a router was logged in with
+     *
+     * \param [in] key      The router key
+     * \param [in] protocol The login protocol
+     */
+    inline void store(const std::string &key, login_protocol protocol) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        entries_[key] = protocol;
+    }
+
+    inline void erase(const std::string &key) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        entries_.erase(key);
+    }
+
+    inline void clear() {
+        std::lock_guard<std::mutex> lock {mutex_};
+        entries_.clear();
+    }
+
+    [[nodiscard]] inline auto size() const -> std::size_t {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return entries_.size();
+    }
+
+    /*!
+     * \brief Writes the cached protocols to a stream, one `key protocol'
+     *        line per router, to be loaded by another process
+     *
+     * \param [in,out] os The output stream
+     */
+    inline void save(std::ostream &os) const {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        for (const auto &[key, protocol] : entries_) {
+            os << key << ' ' << (protocol == login_protocol::v1 ? "v1" : "v2")
+               << '\n';
+        }
+    }
+
+    /*!
+     * \brief Reads protocols written by \see save into the cache, skipping
+     *        malformed lines
+     *
+     * \param [in,out] is The input stream
+     *
+     * \return The number of loaded entries
+     */
+    inline auto load(std::istream &is) -> std::size_t {
+        std::string line {};
+        std::size_t loaded {0};
+
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        while (std::getline(is, line)) {
+            auto pos = line.rfind(' ');
+
+            if (pos == 0 || pos == std::string::npos) {
+                continue;
+            }
+
+            auto name = line.substr(pos + 1);
+
+            if (name != "v1" && name != "v2") {
+                continue;
+            }
+
+            entries_[line.substr(0, pos)] =
+                name == "v1" ? login_protocol::v1 : login_protocol::v2;
+            ++loaded;
+        }
+
+        return loaded;
+    }
+
+  private:
+    mutable std::mutex                              mutex_;
+    std::unordered_map<std::string, login_protocol> entries_;
+};
+
+/*!
+ * \brief Creates an empty login protocol cache
+ *
+ * \return A shared pointer to the created cache
+ */
+[[nodiscard]] inline auto make_login_cache() -> std::shared_ptr<login_cache> {
+    return std::make_shared<login_cache>();
+}
+
+/*!
+ * \brief Gets the process-wide login protocol cache, which API connections
+ *        use unless they are given another one
+ */
+[[nodiscard]] inline auto default_login_cache()
+    -> const std::shared_ptr<login_cache> & {
+    static const auto cache = tikpp::make_login_cache();
+    return cache;
+}
+
+} // namespace tikpp
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef TIKPP_READ_BUDGET_HPP
+#define TIKPP_READ_BUDGET_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace tikpp {
+
+/*!
+ * \brief Bounds the work which a connection does in one turn on its IO
+ *        context, i.e. how much of the read data it decodes and hands to the
+ *        response handlers before it yields to the other handlers
+ *
+ * A connection which has read more than its budget (e.g. a large `getall'
+ * result) posts the rest of its work behind the handlers which are already
+ * ready, so other connections sharing the IO context are not kept waiting
+ * until it is done. Zero leaves a bound unlimited.
+ */
+struct read_budget {
+    //! The number of sentences which are decoded in one turn
+    std::size_t sentences {64};
+
+    //! The number of bytes which are decoded in one turn, at the end of the
+    //! sentence which reaches it
+    std::size_t bytes {64 * 1024};
+};
+
+/*!
+ * \brief Counts the read turns of a connection, and how long they kept the
+ *        IO context thread busy, which is how long the other connections
+ *        sharing it may have been kept waiting by it
+ *
+ * Only updated from the connection strand, and may be read from any thread.
+ */
+struct read_stats {
+    /*!
+     * \brief Records a turn which decoded some sentences
+     *
+     * \param [in] sentences The number of decoded sentences
+     * \param [in] bytes     The size of the decoded sentences
+     * \param [in] duration  How long the turn took
+     * \param [in] yielded   Whether the turn ran out of budget
+     */
+    inline void on_turn(std::size_t              sentences,
+                        std::size_t              bytes,
+                        std::chrono::nanoseconds duration,
+                        bool                     yielded) {
+        sentences_.fetch_add(sentences, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        turns_.fetch_add(1, std::memory_order_relaxed);
+        busy_.fetch_add(duration.count(), std::memory_order_relaxed);
+
+        if (yielded) {
+            yields_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        auto longest = longest_.load(std::memory_order_relaxed);
+        longest_.store(std::max(longest, duration.count()),
+                       std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline auto sentences() const noexcept -> std::size_t {
+        return sentences_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline auto bytes() const noexcept -> std::size_t {
+        return bytes_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline auto turns() const noexcept -> std::size_t {
+        return turns_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Gets the number of turns which ran out of budget, and posted the
+     *        rest of their work
+     */
+    [[nodiscard]] inline auto yields() const noexcept -> std::size_t {
+        return yields_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Gets the total time of the turns
+     */
+    [[nodiscard]] inline auto busy_time() const noexcept
+        -> std::chrono::nanoseconds {
+        return std::chrono::nanoseconds {busy_.load(std::memory_order_relaxed)};
+    }
+
+    /*!
+     * \brief Gets the time of the longest turn, which bounds the delay which
+     *        the connection adds to the others on the same thread
+     */
+    [[nodiscard]] inline auto longest_turn() const noexcept
+        -> std::chrono::nanoseconds {
+        return std::chrono::nanoseconds {
+            longest_.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    std::atomic_size_t        sentences_ {0};
+    std::atomic_size_t        bytes_ {0};
+    std::atomic_size_t        turns_ {0};
+    std::atomic_size_t        yields_ {0};
+    std::atomic<std::int64_t> busy_ {0};
+    std::atomic<std::int64_t> longest_ {0};
+};
+
+} // namespace tikpp
+
+#endif
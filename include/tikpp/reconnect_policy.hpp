@@ -0,0 +1,64 @@
+#ifndef TIKPP_RECONNECT_POLICY_HPP
+#define TIKPP_RECONNECT_POLICY_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+namespace tikpp {
+
+/*!
+ * \brief Describes how an API connection is reopened after it is lost
+ *
+ * Attempts are delayed by a random time between zero and an exponentially
+ * growing bound (i.e. "full jitter"), so that many connections which are lost
+ * at the same time (e.g. behind the same flaky link) spread their attempts
+ * instead of reconnecting all at once.
+ */
+struct reconnect_policy {
+    //! The bound of the delay before the first attempt
+    std::chrono::milliseconds initial_delay {100};
+
+    //! The highest bound of the delay before an attempt
+    std::chrono::milliseconds max_delay {30000};
+
+    //! The factor which the delay bound grows by after each failed attempt
+    double multiplier {2.0};
+
+    //! The number of failed attempts after which the connection is given up,
+    //! or zero to never give up
+    std::size_t max_attempts {0};
+
+    //! Whether the idempotent requests (\see tikpp::request::idempotent)
+    //! which were written before the connection was lost are sent again,
+    //! rather than failed
+    bool retry_idempotent {true};
+
+    /*!
+     * \brief Gets the delay before a reconnection attempt
+     *
+     * \param [in]     attempt The number of the failed attempts so far
+     * \param [in,out] rng     The random number generator to be used
+     *
+     * \return The delay before the attempt
+     */
+    template <typename Random>
+    [[nodiscard]] inline auto delay(std::size_t attempt, Random &rng) const
+        -> std::chrono::milliseconds {
+        using rep = std::chrono::milliseconds::rep;
+
+        auto bound = static_cast<double>(initial_delay.count()) *
+                     std::pow(multiplier, static_cast<double>(attempt));
+        bound = std::min(bound, static_cast<double>(max_delay.count()));
+
+        std::uniform_int_distribution<rep> dist {
+            0, std::max<rep>(static_cast<rep>(bound), 0)};
+        return std::chrono::milliseconds {dist(rng)};
+    }
+};
+
+} // namespace tikpp
+
+#endif
@@ -1,12 +1,17 @@
 #ifndef TIKPP_REQUEST_HPP
 #define TIKPP_REQUEST_HPP
 
+#include "tikpp/flow_control.hpp"
 #include "tikpp/sentence.hpp"
 
 #include "fmt/format.h"
 
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tikpp {
@@ -45,9 +50,26 @@ inline void encode_word(std::string word, std::vector<std::uint8_t> &buf) {
 
 } // namespace detail
 
+/*!
+ * \brief The classes of requests which are sent ahead of each other, from the
+ *        most urgent to the least urgent
+ */
+enum class request_priority : std::uint8_t {
+    //! Control requests (e.g. logins and cancellations), and interactive ones
+    high,
+
+    //! Regular requests
+    normal,
+
+    //! Bulk requests (e.g. provisioning jobs), which may wait
+    bulk
+};
+
 struct request : sentence {
     request(std::string command, std::uint32_t tag)
-        : command_ {std::move(command)}, tag_ {tag} {
+        : command_ {std::move(command)},
+          tag_ {tag},
+          priority_ {request_priority::normal} {
     }
 
     inline void add_word(std::string key, std::string value) {
@@ -95,12 +117,98 @@ struct request : sentence {
         return tag_;
     }
 
+    [[nodiscard]] inline auto flow_control() const noexcept
+        -> const std::shared_ptr<tikpp::flow_control> & {
+        return flow_control_;
+    }
+
+    /*!
+     * \brief Sets the flow control object which limits how many responses of
+     *        this request can be delivered before the connection stops
+     *        reading (\see tikpp::flow_control)
+     */
+    inline void flow_control(std::shared_ptr<tikpp::flow_control> fc) {
+        flow_control_ = std::move(fc);
+    }
+
+    [[nodiscard]] inline auto timeout() const noexcept
+        -> const std::optional<std::chrono::milliseconds> & {
+        return timeout_;
+    }
+
+    /*!
+     * \brief Sets the time which this request has to complete within, before
+     *        it fails with `timed_out' and is cancelled on the router. A zero
+     *        timeout disables the connection default timeout for this request
+     *        (e.g. for `listen' commands)
+     */
+    inline void timeout(std::chrono::milliseconds value) {
+        timeout_ = value;
+    }
+
+    [[nodiscard]] inline auto priority() const noexcept -> request_priority {
+        return priority_;
+    }
+
+    /*!
+     * \brief Sets the class of this request, which decides how soon it is
+     *        written when the connection has queued requests
+     */
+    inline void priority(request_priority value) noexcept {
+        priority_ = value;
+    }
+
+    /*!
+     * \brief Gets whether sending this request more than once has the same
+     *        effect as sending it once, so it can be sent again after the
+     *        connection is lost. Unless set, this holds for the reading
+     *        commands (i.e. `print', `getall' and `listen')
+     */
+    [[nodiscard]] inline auto idempotent() const noexcept -> bool {
+        if (idempotent_.has_value()) {
+            return *idempotent_;
+        }
+
+        for (std::string_view suffix : {"/print", "/getall", "/listen"}) {
+            if (command_.size() >= suffix.size() &&
+                command_.compare(command_.size() - suffix.size(),
+                                 suffix.size(), suffix) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    inline void idempotent(bool value) noexcept {
+        idempotent_ = value;
+    }
+
+    /*!
+     * \brief Makes a copy of this request with another tag, to be sent in
+     *        addition to it (e.g. over another connection)
+     *
+     * \param [in] tag The tag of the copy
+     *
+     * \return The copy
+     */
+    [[nodiscard]] inline auto clone(std::uint32_t tag) const
+        -> std::shared_ptr<request> {
+        auto copy  = std::make_shared<request>(*this);
+        copy->tag_ = tag;
+        return copy;
+    }
+
     void encode(std::vector<std::uint8_t> &buf) const;
 
   protected:
-    std::string              command_;
-    std::vector<std::string> query_;
-    std::uint32_t            tag_;
+    std::string                              command_;
+    std::vector<std::string>                 query_;
+    std::uint32_t                            tag_;
+    std::shared_ptr<tikpp::flow_control>     flow_control_;
+    std::optional<std::chrono::milliseconds> timeout_;
+    request_priority                         priority_;
+    std::optional<bool>                      idempotent_;
 };
 
 } // namespace tikpp
@@ -0,0 +1,71 @@
+#ifndef TIKPP_RESOLVER_HPP
+#define TIKPP_RESOLVER_HPP
+
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tikpp {
+
+/*!
+ * \brief The completion handler of a host name resolution, which is given
+ *        the addresses of the host in the order they should be tried
+ */
+using resolve_handler = std::function<void(
+    const boost::system::error_code &, std::vector<boost::asio::ip::address>)>;
+
+/*!
+ * \brief A function which asynchronously resolves a host name, and calls the
+ *        passed handler exactly once (possibly from within the call)
+ *
+ * Anything with this signature may be used, e.g. a stub which returns fixed
+ * addresses in tests.
+ */
+using resolver =
+    std::function<void(const std::string &host, resolve_handler handler)>;
+
+/*!
+ * \brief Creates a resolver which uses the system resolver (i.e.
+ *        `getaddrinfo`)
+ *
+ * \param [in] ex The executor which the resolution completes on
+ *
+ * \return The created resolver
+ */
+template <typename Executor>
+[[nodiscard]] inline auto make_system_resolver(Executor ex)
+    -> tikpp::resolver {
+    return [ex](const std::string &host, resolve_handler handler) {
+        using boost::asio::ip::tcp;
+
+        auto res = std::make_shared<tcp::resolver>(ex);
+        res->async_resolve(
+            host, std::string {},
+            [res, handler {std::move(handler)}](
+                const auto &err, tcp::resolver::results_type results) {
+                std::vector<boost::asio::ip::address> addresses {};
+
+                for (const auto &entry : results) {
+                    auto address = entry.endpoint().address();
+
+                    if (std::find(addresses.begin(), addresses.end(),
+                                  address) == addresses.end()) {
+                        addresses.push_back(std::move(address));
+                    }
+                }
+
+                handler(err, std::move(addresses));
+            });
+    };
+}
+
+} // namespace tikpp
+
+#endif
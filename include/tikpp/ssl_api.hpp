@@ -4,7 +4,6 @@
 #include "tikpp/api.hpp"
 #include "tikpp/basic_api.hpp"
 #include "tikpp/detail/ssl_wrapper.hpp"
-#include "tikpp/io_context.hpp"
 
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/system/error_code.hpp>
@@ -12,57 +11,74 @@
 #include <functional>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace tikpp {
 
 /*!
  * \brief Creates a new instance of \see api with SSL/TLS support
  *
- * \param [in] io      The IO object to be used by the API connection
+ * \param [in] ctx     The execution context or the executor to be used by
+ *                     the API connection
  * \param [in] handler A callable object to be called on fatal errors
+ * \param [in] options The TCP options of the connection socket
  *
  * \return The create \see basic_api instance
  */
 template <typename AsyncStream = boost::asio::ip::tcp::socket,
-          typename ErrorHandler>
-[[nodiscard]] inline decltype(auto) make_ssl_api(tikpp::io_context &io,
-                                                 ErrorHandler &&    handler) {
+          typename ErrorHandler,
+          typename Context>
+[[nodiscard]] inline decltype(auto)
+make_ssl_api(Context &&                ctx,
+             ErrorHandler &&           handler,
+             tikpp::connection_options options = {}) {
     return tikpp::make_api<tikpp::detail::ssl_wrapper<AsyncStream>,
-                           ErrorHandler>(io,
-                                         std::forward<ErrorHandler>(handler));
+                           ErrorHandler>(std::forward<Context>(ctx),
+                                         std::forward<ErrorHandler>(handler),
+                                         std::move(options));
 }
 
 /*!
  * \brief Creates a new instance of \see api with SSL/TLS support
  *
- * \param [in] io      The IO object to be used by the API connection
+ * \param [in] ctx     The execution context or the executor to be used by
+ *                     the API connection
  * \param [in] handler A reference to a callable object to be called on fatal
  *                     errors
+ * \param [in] options The TCP options of the connection socket
  *
  * \return The create \see basic_api instance
  */
 template <typename AsyncStream = boost::asio::ip::tcp::socket,
-          typename ErrorHandler>
-[[nodiscard]] inline decltype(auto) make_ssl_api(tikpp::io_context &io,
-                                                 ErrorHandler &     handler) {
+          typename ErrorHandler,
+          typename Context>
+[[nodiscard]] inline decltype(auto)
+make_ssl_api(Context &&                ctx,
+             ErrorHandler &            handler,
+             tikpp::connection_options options = {}) {
     return tikpp::make_api<tikpp::detail::ssl_wrapper<AsyncStream>,
-                           ErrorHandler>(io, handler);
+                           ErrorHandler>(std::forward<Context>(ctx), handler,
+                                         std::move(options));
 }
 
 /*!
  * \brief Creates a new instance of \see basic_api_te with SSL support
  *
- * \param [in] io      The IO object to be used by the API connection
+ * \param [in] ctx     The execution context or the executor to be used by
+ *                     the API connection
  * \param [in] handler A callable object to be called on fatal errors
+ * \param [in] options The TCP options of the connection socket
  *
  * \return The create \see basic_api instance
  */
-template <typename AsyncStream = boost::asio::ip::tcp::socket>
+template <typename AsyncStream = boost::asio::ip::tcp::socket,
+          typename Context>
 [[nodiscard]] inline decltype(auto) make_ssl_api_te(
-    tikpp::io_context &                                    io,
-    std::function<void(const boost::system::error_code &)> handler) {
+    Context &&                                             ctx,
+    std::function<void(const boost::system::error_code &)> handler,
+    tikpp::connection_options                              options = {}) {
     return tikpp::make_api_te<tikpp::detail::ssl_wrapper<AsyncStream>>(
-        io, std::move(handler));
+        std::forward<Context>(ctx), std::move(handler), std::move(options));
 }
 
 } // namespace tikpp
@@ -0,0 +1,110 @@
+#ifndef TIKPP_SSL_CONTEXT_HPP
+#define TIKPP_SSL_CONTEXT_HPP
+
+#include "tikpp/tls_session_cache.hpp"
+
+#include <boost/asio/ssl/context.hpp>
+#include <openssl/ssl.h>
+
+#include <memory>
+#include <string>
+
+namespace tikpp {
+
+namespace detail {
+
+/*!
+ * \brief The cache and the key which the new sessions of an SSL connection
+ *        are stored with, attached to the connection's `SSL' object
+ */
+struct tls_session_slot {
+    std::shared_ptr<tikpp::tls_session_cache> cache;
+    std::string                               key;
+};
+
+inline auto tls_session_slot_index() -> int {
+    static const int index =
+        ::SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+/*
+ * Called by OpenSSL when the server hands out a session (with TLS 1.3, this
+ * is after the handshake, when a ticket arrives). Returning 1 keeps the
+ * reference to the session
+ */
+inline auto on_new_tls_session(SSL *ssl, SSL_SESSION *session) -> int {
+    auto *slot = static_cast<tls_session_slot *>(
+        ::SSL_get_ex_data(ssl, tls_session_slot_index()));
+
+    if (slot == nullptr || slot->cache == nullptr || slot->key.empty()) {
+        return 0;
+    }
+
+    slot->cache->store(slot->key, session);
+    return 1;
+}
+
+} // namespace detail
+
+/*!
+ * \brief Lets the SSL API connections which use a context resume their
+ *        sessions through \see tikpp::tls_session_cache. Contexts created
+ *        with \see make_ssl_context already have it enabled
+ *
+ * \param [in,out] ctx The SSL context, which must not be in use yet
+ */
+inline void enable_session_resumption(boost::asio::ssl::context &ctx) {
+    ::SSL_CTX_set_session_cache_mode(ctx.native_handle(),
+                                     SSL_SESS_CACHE_CLIENT |
+                                         SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    ::SSL_CTX_sess_set_new_cb(ctx.native_handle(),
+                              tikpp::detail::on_new_tls_session);
+}
+
+/*!
+ * \brief Creates a client SSL context for SSL API connections, which may be
+ *        shared by any number of them
+ *
+ * \param [in] verify Whether the router certificates are verified against
+ *                    the default verify paths
+ *
+ * \return A shared pointer to the created context
+ */
+[[nodiscard]] inline auto make_ssl_context(bool verify = false)
+    -> std::shared_ptr<boost::asio::ssl::context> {
+    auto ctx = std::make_shared<boost::asio::ssl::context>(
+        boost::asio::ssl::context::sslv23_client);
+
+    if (verify) {
+        ctx->set_verify_mode(boost::asio::ssl::context::verify_peer);
+        ctx->set_default_verify_paths();
+    } else {
+        ctx->set_verify_mode(boost::asio::ssl::context::verify_none);
+    }
+
+    enable_session_resumption(*ctx);
+    return ctx;
+}
+
+/*!
+ * \brief Gets the process-wide SSL context of a verify mode, which SSL API
+ *        connections use unless they are given another one. It is created
+ *        on first use, so the default verify paths are only loaded once
+ *
+ * \param [in] verify Whether the router certificates are verified
+ */
+[[nodiscard]] inline auto default_ssl_context(bool verify)
+    -> const std::shared_ptr<boost::asio::ssl::context> & {
+    if (verify) {
+        static const auto ctx = tikpp::make_ssl_context(true);
+        return ctx;
+    }
+
+    static const auto ctx = tikpp::make_ssl_context(false);
+    return ctx;
+}
+
+} // namespace tikpp
+
+#endif
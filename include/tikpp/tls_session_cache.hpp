@@ -0,0 +1,120 @@
+#ifndef TIKPP_TLS_SESSION_CACHE_HPP
+#define TIKPP_TLS_SESSION_CACHE_HPP
+
+#include <openssl/ssl.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tikpp {
+
+/*!
+ * \brief A cache of the TLS sessions of routers, which lets SSL API
+ *        connections resume a session (by session ID or ticket) instead of
+ *        doing a full handshake when they reconnect. It may be shared by many
+ *        connections (and threads)
+ *
+ * Routers are keyed by their address and API port (i.e. `address:port').
+ */
+struct tls_session_cache {
+    using session_ptr = std::shared_ptr<SSL_SESSION>;
+
+    /*!
+     * \brief Creates an empty cache
+     *
+     * \param [in] max_entries The maximum number of cached sessions, after
+     *                         which storing a session evicts another one
+     */
+    explicit tls_session_cache(std::size_t max_entries = 4096) noexcept
+        : max_entries_ {max_entries} {
+    }
+
+    /*!
+     * \brief Gets the session of a router, if one is cached
+     *
+     * \param [in] key The router key
+     */
+    [[nodiscard]] inline auto lookup(const std::string &key) const
+        -> session_ptr {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        if (auto it = sessions_.find(key); it != sessions_.end()) {
+            return it->second;
+        }
+
+        return nullptr;
+    }
+
+    /*!
+     * \brief Caches the session of a router, replacing its previous one
+     *
+     * \param [in] key     The router key
+     * \param [in] session The session, whose reference is taken over by the
+     *                     cache
+     */
+    inline void store(const std::string &key, SSL_SESSION *session) {
+        session_ptr ptr {session, ::SSL_SESSION_free};
+
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        if (max_entries_ == 0) {
+            return;
+        }
+
+        if (sessions_.size() >= max_entries_ &&
+            sessions_.find(key) == sessions_.end()) {
+            sessions_.erase(sessions_.begin());
+        }
+
+        sessions_[key] = std::move(ptr);
+    }
+
+    inline void erase(const std::string &key) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        sessions_.erase(key);
+    }
+
+    inline void clear() {
+        std::lock_guard<std::mutex> lock {mutex_};
+        sessions_.clear();
+    }
+
+    [[nodiscard]] inline auto size() const -> std::size_t {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return sessions_.size();
+    }
+
+  private:
+    mutable std::mutex                           mutex_;
+    std::size_t                                  max_entries_;
+    std::unordered_map<std::string, session_ptr> sessions_;
+};
+
+/*!
+ * \brief Creates an empty TLS session cache
+ *
+ * \param [in] max_entries The maximum number of cached sessions
+ *
+ * \return A shared pointer to the created cache
+ */
+[[nodiscard]] inline auto make_tls_session_cache(std::size_t max_entries = 4096)
+    -> std::shared_ptr<tls_session_cache> {
+    return std::make_shared<tls_session_cache>(max_entries);
+}
+
+/*!
+ * \brief Gets the process-wide TLS session cache, which SSL API connections
+ *        use unless they are given another one
+ */
+[[nodiscard]] inline auto default_tls_session_cache()
+    -> const std::shared_ptr<tls_session_cache> & {
+    static const auto cache = tikpp::make_tls_session_cache();
+    return cache;
+}
+
+} // namespace tikpp
+
+#endif
@@ -50,6 +50,8 @@ auto error_category::message(int c) const -> std::string {
         return "End of list reached";
     case tikpp::error_code::unknown_error_category:
         return "Unknoww error category";
+    case tikpp::error_code::router_unhealthy:
+        return "The router is deemed unhealthy";
 
     default:
         return "Unknoww error";
@@ -43,6 +43,12 @@ struct socket final {
                 boost::asio::error::make_error_code(boost::asio::error::fault));
         }
 
+        // Reconnecting after being closed
+        if (!input_pipe_.is_open()) {
+            input_pipe_  = boost::process::async_pipe {io_};
+            output_pipe_ = boost::process::async_pipe {io_};
+        }
+
         connected_.store(true);
         ep_ = ep;
 
@@ -0,0 +1,53 @@
+#ifndef TIKPP_TESTS_UTIL_TLS_HPP
+#define TIKPP_TESTS_UTIL_TLS_HPP
+
+#include <boost/asio/ssl/context.hpp>
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include <memory>
+
+namespace tikpp::tests::util {
+
+/*!
+ * \brief Creates a TLS server context with a self-signed 2048-bit RSA
+ *        certificate, for local servers which SSL API connections (which do
+ *        not verify certificates by default) can connect to
+ */
+inline auto make_tls_server_context()
+    -> std::shared_ptr<boost::asio::ssl::context> {
+    auto ctx = std::make_shared<boost::asio::ssl::context>(
+        boost::asio::ssl::context::tls_server);
+
+    auto *key = ::EVP_PKEY_new();
+    auto *rsa = ::EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+
+    ::EVP_PKEY_keygen_init(rsa);
+    ::EVP_PKEY_CTX_set_rsa_keygen_bits(rsa, 2048);
+    ::EVP_PKEY_keygen(rsa, &key);
+    ::EVP_PKEY_CTX_free(rsa);
+
+    auto *cert = ::X509_new();
+    ::ASN1_INTEGER_set(::X509_get_serialNumber(cert), 1);
+    ::X509_gmtime_adj(::X509_getm_notBefore(cert), 0);
+    ::X509_gmtime_adj(::X509_getm_notAfter(cert), 24 * 60 * 60);
+    ::X509_set_pubkey(cert, key);
+    ::X509_NAME_add_entry_by_txt(
+        ::X509_get_subject_name(cert), "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char *>("router"), -1, -1, 0);
+    ::X509_set_issuer_name(cert, ::X509_get_subject_name(cert));
+    ::X509_sign(cert, key, ::EVP_sha256());
+
+    ::SSL_CTX_use_certificate(ctx->native_handle(), cert);
+    ::SSL_CTX_use_PrivateKey(ctx->native_handle(), key);
+
+    ::X509_free(cert);
+    ::EVP_PKEY_free(key);
+
+    return ctx;
+}
+
+} // namespace tikpp::tests::util
+
+#endif
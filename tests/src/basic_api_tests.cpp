@@ -1,3 +1,5 @@
+#include "tikpp/api.hpp"
+#include "tikpp/flow_control.hpp"
 #include "tikpp/request.hpp"
 #include "tikpp/tests/fakes/socket.hpp"
 #include "tikpp/tests/fixtures/basic_api.hpp"
@@ -5,12 +7,27 @@
 
 #include "fmt/format.h"
 #include "gtest/gtest.h"
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/read.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/asio/write.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
+#include <optional>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -27,6 +44,64 @@ std::vector<std::uint8_t> make_sentence(Arg &&... args) {
     return buf;
 }
 
+/*!
+ * \brief Answers each request written to a fake socket with `!done' as soon as
+ *        it is received
+ */
+void respond_done(tikpp::tests::fakes::socket &sock, std::size_t count) {
+    std::vector<std::uint8_t> len(1), resp {};
+    std::string               word {}, tag {};
+
+    for (std::size_t i {0}; i < count;) {
+        boost::asio::read(sock.output_pipe(), boost::asio::buffer(len));
+
+        if (len[0] == 0) {
+            resp = ::make_sentence("!done", tag);
+            boost::asio::write(sock.input_pipe(), boost::asio::buffer(resp));
+            ++i;
+            continue;
+        }
+
+        word.resize(len[0]);
+        boost::asio::read(sock.output_pipe(), boost::asio::buffer(word));
+
+        if (word.rfind(".tag=", 0) == 0) {
+            tag = word;
+        }
+    }
+}
+
+/*!
+ * \brief Reads the words of the sentences written to a fake socket
+ */
+auto read_sentences(tikpp::tests::fakes::socket &sock, std::size_t count)
+    -> std::vector<std::vector<std::string>> {
+    std::vector<std::vector<std::string>> sentences {};
+    std::vector<std::string>              words {};
+    std::vector<std::uint8_t>             len(1);
+
+    while (sentences.size() < count) {
+        boost::asio::read(sock.output_pipe(), boost::asio::buffer(len));
+
+        if (len[0] == 0) {
+            sentences.emplace_back(std::move(words));
+            words.clear();
+            continue;
+        }
+
+        words.emplace_back(len[0], '\0');
+        boost::asio::read(sock.output_pipe(),
+                          boost::asio::buffer(words.back()));
+    }
+
+    return sentences;
+}
+
+auto contains_word(const std::vector<std::string> &sentence,
+                   const std::string &             word) -> bool {
+    return std::find(sentence.begin(), sentence.end(), word) != sentence.end();
+}
+
 } // namespace
 
 namespace tikpp::tests {
@@ -171,8 +246,10 @@ TEST_F(ConnectedBasicApiTest, FatalResponseTest) {
     boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(resp));
 
     auto req = api->make_request("/test/command");
-    api->async_send(std::move(req), [this](const auto &err, auto &&resp) {
-        EXPECT_FALSE(true);
+    api->async_send(std::move(req), [](const auto &err, auto &&) {
+        // Failed if it is written as the connection is closed, but never
+        // answered
+        EXPECT_EQ(err, boost::asio::error::not_connected);
         return false;
     });
 
@@ -197,13 +274,107 @@ TEST_F(BasicApiTest, NotConnectedSendTest) {
     io.run();
 }
 
+TEST_F(BasicApiTest, HeldSendTest) {
+    std::vector<std::vector<std::string>> sentences {};
+    std::atomic_bool                      read {false};
+
+    auto reader = [this, &sentences, &read](std::size_t count) {
+        read.store(false);
+        return std::thread {[this, &sentences, &read, count] {
+            sentences = ::read_sentences(api->socket(), count);
+            read.store(true);
+        }};
+    };
+
+    auto poll_until = [this](auto &&done) {
+        while (!done()) {
+            io.poll();
+            std::this_thread::yield();
+        }
+    };
+
+    auto respond = [this](const std::string &tag) {
+        auto resp = ::make_sentence("!done", tag);
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(resp));
+    };
+
+    bool opened {false};
+    api->async_open(ConnectedBasicApiTest::test_ip_address,
+                    ConnectedBasicApiTest::test_api_port, "admin", "secret",
+                    [&opened](const auto &err) {
+                        EXPECT_FALSE(err);
+                        opened = true;
+                    });
+
+    std::size_t completed {0};
+
+    for (const auto *command : {"/interface/print", "/ip/address/print"}) {
+        api->async_send(api->make_request(command),
+                        [&completed](const auto &err, auto &&) {
+                            EXPECT_FALSE(err);
+                            ++completed;
+                            return false;
+                        });
+    }
+
+    auto login = reader(1);
+    poll_until([&]() { return read.load(); });
+    login.join();
+
+    ASSERT_EQ(sentences.size(), 1);
+    EXPECT_EQ(sentences[0][0], "/login");
+
+    // Only the login is written until it succeeds
+    for (int i {0}; i < 100; ++i) {
+        io.poll();
+    }
+
+    EXPECT_EQ(api->in_flight(), 1);
+    EXPECT_FALSE(opened);
+
+    auto held = reader(2);
+    respond(sentences[0][1]);
+    poll_until([&]() { return opened && read.load(); });
+    held.join();
+
+    ASSERT_EQ(sentences.size(), 2);
+    EXPECT_EQ(sentences[0][0], "/interface/print");
+    EXPECT_EQ(sentences[1][0], "/ip/address/print");
+
+    respond(sentences[0][1]);
+    respond(sentences[1][1]);
+    poll_until([&]() { return completed == 2; });
+
+    api->close();
+}
+
+TEST_F(BasicApiTest, HeldSendFailureTest) {
+    bool failed {false};
+    api->async_send(api->make_request("/interface/print"),
+                    [&failed](const auto &err, auto &&) {
+                        // Fails with the reason the connection was not opened
+                        EXPECT_EQ(err, boost::asio::error::fault);
+                        failed = true;
+                        return false;
+                    });
+
+    api->socket().always_fails(true);
+    api->async_open(ConnectedBasicApiTest::test_ip_address,
+                    ConnectedBasicApiTest::test_api_port,
+                    [](const auto &err) { EXPECT_TRUE(err); });
+
+    io.run();
+    EXPECT_TRUE(failed);
+}
+
 TEST_F(ConnectedBasicApiTest, UntaggedSendTest) {
     auto req  = api->make_request("/test/command");
     auto resp = ::make_sentence("!done", "=param=value");
     boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(resp));
 
-    api->async_send(std::move(req), [](const auto &err, auto &&resp) {
-        EXPECT_TRUE(false);
+    api->async_send(std::move(req), [](const auto &err, auto &&) {
+        EXPECT_EQ(err, boost::asio::error::not_connected);
         return false;
     });
 
@@ -220,8 +391,8 @@ TEST_F(ConnectedBasicApiTest, InvalidResponseTest) {
     auto resp = ::make_sentence("invalid header", "invalid param");
     boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(resp));
 
-    api->async_send(std::move(req), [](const auto &err, auto &&resp) {
-        EXPECT_TRUE(false);
+    api->async_send(std::move(req), [](const auto &err, auto &&) {
+        EXPECT_EQ(err, boost::asio::error::not_connected);
         return false;
     });
 
@@ -266,4 +437,1004 @@ TEST_F(ConnectedBasicApiTest, HandlerPersistenceTest) {
     io.run();
 }
 
+TEST_F(ConnectedBasicApiTest, FlowControlTest) {
+    constexpr auto test_iterations = 10;
+    constexpr auto initial_credit  = 3;
+
+    auto req  = api->make_request("/test/listen");
+    auto resp = ::make_sentence("!re", "=param=value",
+                                fmt::format(".tag={}", req->tag()));
+
+    for (std::size_t i {0}; i < test_iterations; ++i) {
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(resp));
+    }
+
+    auto flow = tikpp::make_flow_control(initial_credit);
+    req->flow_control(flow);
+
+    std::size_t hits {0};
+
+    api->async_send(std::move(req), [&](const auto &err, auto &&resp) {
+        EXPECT_FALSE(err);
+        EXPECT_EQ(resp.type(), tikpp::response_type::data);
+
+        if (++hits >= test_iterations) {
+            api->close();
+            return false;
+        }
+
+        return true;
+    });
+
+    io.poll();
+
+    EXPECT_EQ(hits, initial_credit);
+    EXPECT_TRUE(flow->is_exhausted());
+    EXPECT_TRUE(api->is_reading_paused());
+
+    flow->grant(2);
+    io.poll();
+
+    EXPECT_EQ(hits, initial_credit + 2);
+    EXPECT_TRUE(api->is_reading_paused());
+
+    flow->grant(test_iterations);
+    io.run();
+
+    EXPECT_EQ(hits, test_iterations);
+    EXPECT_FALSE(api->is_reading_paused());
+}
+
+TEST_F(ConnectedBasicApiTest, ConcurrentSendTest) {
+    constexpr std::uint32_t io_threads   = 4;
+    constexpr std::uint32_t user_threads = 4;
+    constexpr std::uint32_t requests     = 250;
+    constexpr std::uint32_t total        = user_threads * requests;
+
+    std::atomic<std::uint32_t> completed {0};
+    std::vector<std::thread>   threads {};
+
+    std::thread responder {[this] { ::respond_done(api->socket(), total); }};
+
+    auto work = boost::asio::make_work_guard(io);
+
+    for (std::uint32_t i {0}; i < io_threads; ++i) {
+        threads.emplace_back([this] { io.run(); });
+    }
+
+    for (std::uint32_t i {0}; i < user_threads; ++i) {
+        threads.emplace_back([this, &completed] {
+            for (std::uint32_t j {0}; j < requests; ++j) {
+                api->async_send(api->make_request("/system/identity/print"),
+                                [&completed](const auto &err, auto &&resp) {
+                                    EXPECT_FALSE(err);
+                                    EXPECT_EQ(resp.type(),
+                                              tikpp::response_type::normal);
+                                    ++completed;
+                                    return false;
+                                });
+            }
+        });
+    }
+
+    responder.join();
+
+    while (completed.load() < total) {
+        std::this_thread::yield();
+    }
+
+    work.reset();
+    io.stop();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(completed.load(), total);
+}
+
+TEST_F(ConnectedBasicApiTest, ChainedSendTest) {
+    constexpr std::uint32_t chain_length = 100;
+
+    std::uint32_t sent {0}, completed {0};
+    std::thread   responder {
+        [this] { ::respond_done(api->socket(), chain_length); }};
+
+    std::function<void()> send_next = [&]() {
+        auto req = api->make_request("/system/identity/print");
+        EXPECT_EQ(req->tag(), sent++);
+
+        api->async_send(std::move(req), [&](const auto &err, auto &&resp) {
+            EXPECT_FALSE(err);
+            EXPECT_TRUE(api->get_executor().running_in_this_thread());
+            EXPECT_EQ(resp.tag().value(), completed++);
+
+            // Sent from the connection strand, so it takes the inline path
+            if (sent < chain_length) {
+                send_next();
+            }
+
+            return false;
+        });
+    };
+
+    send_next();
+
+    while (completed < chain_length) {
+        io.run_one();
+    }
+
+    responder.join();
+
+    EXPECT_EQ(sent, chain_length);
+    EXPECT_EQ(completed, chain_length);
+}
+
+TEST_F(ConnectedBasicApiTest, TimeoutTest) {
+    constexpr std::chrono::milliseconds timeout {30};
+
+    api->default_timeout(timeout);
+
+    auto timed   = api->make_request("/system/resource/print");
+    auto untimed = api->make_request("/interface/listen");
+    untimed->timeout(std::chrono::milliseconds {0});
+
+    auto tag = timed->tag();
+
+    std::atomic_bool                      read {false};
+    std::vector<std::vector<std::string>> sentences {};
+    std::thread                           reader {[this, &read, &sentences] {
+        sentences = ::read_sentences(api->socket(), 3);
+        read.store(true);
+    }};
+
+    bool timed_out {false};
+    auto start = std::chrono::steady_clock::now();
+
+    api->async_send(std::move(untimed), [](const auto &err, auto &&) {
+        ADD_FAILURE() << "Untimed request completed: " << err.message();
+        return false;
+    });
+
+    api->async_send(std::move(timed), [&](const auto &err, auto &&) {
+        EXPECT_EQ(err, boost::asio::error::timed_out);
+        EXPECT_GE(std::chrono::steady_clock::now() - start, timeout);
+        timed_out = true;
+        return false;
+    });
+
+    while (!timed_out || !read.load()) {
+        io.run_one();
+    }
+
+    reader.join();
+
+    // The timed out request is cancelled on the router
+    ASSERT_EQ(sentences.size(), 3);
+    EXPECT_EQ(sentences[2][0], "/cancel");
+    EXPECT_TRUE(::contains_word(sentences[2], fmt::format("=tag={}", tag)));
+
+    api->close();
+    EXPECT_EQ(api->pending_deadlines(), 0);
+}
+
+TEST_F(ConnectedBasicApiTest, TimeoutPausedTest) {
+    auto stream = api->make_request("/interface/listen");
+    auto plain  = api->make_request("/system/resource/print");
+    stream->timeout(std::chrono::milliseconds {20});
+    stream->flow_control(tikpp::make_flow_control(1));
+
+    // The answer to the plain request is read after the stream paused reading
+    auto row  = ::make_sentence("!re", "=name=ether1",
+                               fmt::format(".tag={}", stream->tag()));
+    auto done = ::make_sentence("!done", fmt::format(".tag={}", plain->tag()));
+
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(row));
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(row));
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(done));
+
+    bool timed_out {false}, completed {false};
+
+    api->async_send(std::move(stream), [&](const auto &err, auto &&) {
+        if (err) {
+            EXPECT_EQ(err, boost::asio::error::timed_out);
+            timed_out = true;
+            return false;
+        }
+
+        return true;
+    });
+
+    api->async_send(std::move(plain), [&](const auto &err, auto &&) {
+        EXPECT_FALSE(err);
+        completed = true;
+        return false;
+    });
+
+    io.poll();
+    EXPECT_TRUE(api->is_reading_paused());
+    EXPECT_FALSE(completed);
+
+    // The timed out stream no longer holds reading paused
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds {1};
+
+    while (!completed && std::chrono::steady_clock::now() < until) {
+        io.run_one_for(std::chrono::milliseconds {10});
+    }
+
+    EXPECT_TRUE(timed_out);
+    EXPECT_TRUE(completed);
+    EXPECT_FALSE(api->is_reading_paused());
+
+    api->close();
+}
+
+TEST_F(ConnectedBasicApiTest, TimeoutQueuedTest) {
+    api->max_in_flight(1);
+
+    auto first  = api->make_request("/interface/print");
+    auto queued = api->make_request("/ip/address/print");
+    auto last   = api->make_request("/system/identity/print");
+    queued->timeout(std::chrono::milliseconds {20});
+
+    auto first_tag = first->tag();
+    auto last_tag  = last->tag();
+
+    std::vector<std::vector<std::string>> sentences {};
+    std::atomic_bool                      read {false};
+    std::thread                           reader {[this, &sentences, &read] {
+        sentences = ::read_sentences(api->socket(), 2);
+        read.store(true);
+    }};
+
+    bool timed_out {false};
+    auto start = std::chrono::steady_clock::now();
+
+    api->async_send(std::move(first), [](const auto &err, auto &&) {
+        EXPECT_FALSE(err);
+        return false;
+    });
+
+    // Held back behind the full window, yet its deadline already runs
+    api->async_send(std::move(queued), [&](const auto &err, auto &&) {
+        EXPECT_EQ(err, boost::asio::error::timed_out);
+        EXPECT_GE(std::chrono::steady_clock::now() - start,
+                  std::chrono::milliseconds {20});
+        timed_out = true;
+        return false;
+    });
+
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds {1};
+
+    while (!timed_out && std::chrono::steady_clock::now() < until) {
+        io.run_one_for(std::chrono::milliseconds {10});
+    }
+
+    EXPECT_TRUE(timed_out);
+    EXPECT_EQ(api->pending_deadlines(), 0);
+
+    // The timed out request is removed from the queue, and is neither
+    // written nor cancelled on the router
+    api->async_send(std::move(last), [](const auto &, auto &&) {
+        return false;
+    });
+
+    auto resp = ::make_sentence("!done", fmt::format(".tag={}", first_tag));
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(resp));
+
+    while (!read.load()) {
+        io.poll();
+        std::this_thread::yield();
+    }
+
+    reader.join();
+
+    ASSERT_EQ(sentences.size(), 2);
+    EXPECT_EQ(sentences[0][0], "/interface/print");
+    EXPECT_EQ(sentences[1][0], "/system/identity/print");
+    EXPECT_TRUE(
+        ::contains_word(sentences[1], fmt::format(".tag={}", last_tag)));
+
+    api->close();
+}
+
+TEST_F(BasicApiTest, TimeoutHeldTest) {
+    std::vector<std::vector<std::string>> sentences {};
+    std::thread                           reader {[this, &sentences] {
+        sentences = ::read_sentences(api->socket(), 1);
+    }};
+
+    bool opened {false}, timed_out {false};
+    api->async_open(ConnectedBasicApiTest::test_ip_address,
+                    ConnectedBasicApiTest::test_api_port, "admin", "secret",
+                    [&opened](const auto &) { opened = true; });
+
+    // Held until the login, which the router never answers, succeeds
+    auto req = api->make_request("/interface/print");
+    req->timeout(std::chrono::milliseconds {20});
+
+    api->async_send(std::move(req), [&timed_out](const auto &err, auto &&) {
+        EXPECT_EQ(err, boost::asio::error::timed_out);
+        timed_out = true;
+        return false;
+    });
+
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds {1};
+
+    while (!timed_out && std::chrono::steady_clock::now() < until) {
+        io.run_one_for(std::chrono::milliseconds {10});
+    }
+
+    reader.join();
+
+    EXPECT_TRUE(timed_out);
+    EXPECT_FALSE(opened);
+    EXPECT_EQ(api->pending_deadlines(), 0);
+
+    ASSERT_EQ(sentences.size(), 1);
+    EXPECT_EQ(sentences[0][0], "/login");
+
+    api->close();
+}
+
+TEST_F(ConnectedBasicApiTest, CancelTest) {
+    auto req = api->make_request("/interface/listen");
+    auto tag = req->tag();
+
+    std::vector<std::vector<std::string>> sentences {};
+    std::atomic_bool                      written {false}, read {false};
+    std::thread reader {[this, &sentences, &written, &read] {
+        sentences = ::read_sentences(api->socket(), 1);
+        written.store(true);
+
+        auto rest = ::read_sentences(api->socket(), 1);
+        sentences.insert(sentences.end(), rest.begin(), rest.end());
+        read.store(true);
+    }};
+
+    bool cancelled {false};
+
+    api->async_send(std::move(req), [&cancelled](const auto &err, auto &&) {
+        EXPECT_EQ(err, boost::asio::error::operation_aborted);
+        cancelled = true;
+        return true;
+    });
+
+    // Nothing wakes the IO context up once the reader is done
+    while (!written.load()) {
+        io.poll();
+        std::this_thread::yield();
+    }
+
+    api->cancel(tag);
+
+    while (!cancelled || !read.load()) {
+        io.poll();
+        std::this_thread::yield();
+    }
+
+    reader.join();
+
+    // The request was already written, so it is cancelled on the router
+    ASSERT_EQ(sentences.size(), 2);
+    EXPECT_EQ(sentences[1][0], "/cancel");
+    EXPECT_TRUE(::contains_word(sentences[1], fmt::format("=tag={}", tag)));
+
+    api->close();
+}
+
+TEST_F(ConnectedBasicApiTest, CancelPausedTest) {
+    auto stream = api->make_request("/interface/listen");
+    auto plain  = api->make_request("/system/resource/print");
+    auto tag    = stream->tag();
+    stream->flow_control(tikpp::make_flow_control(1));
+
+    auto row  = ::make_sentence("!re", "=name=ether1",
+                               fmt::format(".tag={}", stream->tag()));
+    auto done = ::make_sentence("!done", fmt::format(".tag={}", plain->tag()));
+
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(row));
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(row));
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(done));
+
+    bool cancelled {false}, completed {false};
+
+    api->async_send(std::move(stream), [&](const auto &err, auto &&) {
+        if (err) {
+            EXPECT_EQ(err, boost::asio::error::operation_aborted);
+            cancelled = true;
+            return false;
+        }
+
+        return true;
+    });
+
+    api->async_send(std::move(plain), [&](const auto &err, auto &&) {
+        EXPECT_FALSE(err);
+        completed = true;
+        return false;
+    });
+
+    io.poll();
+    EXPECT_TRUE(api->is_reading_paused());
+    EXPECT_FALSE(completed);
+
+    api->cancel(tag);
+    io.poll();
+
+    EXPECT_TRUE(cancelled);
+    EXPECT_TRUE(completed);
+    EXPECT_FALSE(api->is_reading_paused());
+
+    api->close();
+}
+
+TEST_F(ConnectedBasicApiTest, CancelQueuedTest) {
+    auto first  = api->make_request("/system/identity/print");
+    auto queued = api->make_request("/interface/listen");
+    auto last   = api->make_request("/system/resource/print");
+
+    std::vector<std::vector<std::string>> sentences {};
+    std::atomic_bool                      read {false};
+    std::thread reader {[this, &sentences, &read] {
+        sentences = ::read_sentences(api->socket(), 2);
+        read.store(true);
+    }};
+
+    bool cancelled {false};
+
+    // Sent from the strand, so the second request waits for the first one to
+    // be written
+    boost::asio::post(api->get_executor(), [&]() {
+        auto tag = queued->tag();
+
+        api->async_send(std::move(first),
+                        [](const auto &, auto &&) { return false; });
+        api->async_send(std::move(queued), [&cancelled](const auto &err,
+                                                        auto &&) {
+            EXPECT_EQ(err, boost::asio::error::operation_aborted);
+            cancelled = true;
+            return false;
+        });
+
+        api->cancel(tag);
+        EXPECT_TRUE(cancelled);
+
+        api->async_send(std::move(last),
+                        [](const auto &, auto &&) { return false; });
+    });
+
+    while (!cancelled || !read.load()) {
+        io.poll();
+        std::this_thread::yield();
+    }
+
+    reader.join();
+
+    // The cancelled request is dropped before being written
+    ASSERT_EQ(sentences.size(), 2);
+    EXPECT_EQ(sentences[0][0], "/system/identity/print");
+    EXPECT_EQ(sentences[1][0], "/system/resource/print");
+
+    api->close();
+}
+
+TEST_F(ConnectedBasicApiTest, PriorityTest) {
+    std::vector<std::vector<std::string>> sentences {};
+    std::atomic_bool                      read {false};
+    std::thread reader {[this, &sentences, &read] {
+        sentences = ::read_sentences(api->socket(), 6);
+        read.store(true);
+    }};
+
+    auto send = [this](const std::string &command, auto priority) {
+        api->async_send(api->make_request(command), priority,
+                        [](const auto &, auto &&) { return false; });
+    };
+
+    // Sent from the strand, so the rest of the requests are queued while the
+    // first one is being written
+    boost::asio::post(api->get_executor(), [&]() {
+        send("/first", tikpp::request_priority::normal);
+        send("/bulk/1", tikpp::request_priority::bulk);
+        send("/bulk/2", tikpp::request_priority::bulk);
+        send("/normal", tikpp::request_priority::normal);
+        send("/high", tikpp::request_priority::high);
+
+        api->async_send(api->make_request<tikpp::commands::cancel>(0),
+                        [](const auto &, auto &&) { return false; });
+    });
+
+    while (!read.load()) {
+        io.poll();
+        std::this_thread::yield();
+    }
+
+    reader.join();
+
+    std::vector<std::string> commands {};
+
+    for (const auto &sentence : sentences) {
+        commands.push_back(sentence[0]);
+    }
+
+    EXPECT_EQ(commands, (std::vector<std::string> {"/first", "/high",
+                                                   "/cancel", "/normal",
+                                                   "/bulk/1", "/bulk/2"}));
+
+    api->close();
+}
+
+TEST_F(ConnectedBasicApiTest, WriteBatchTest) {
+    constexpr std::size_t requests = 300;
+
+    std::size_t completed {0};
+    std::thread responder {
+        [this] { ::respond_done(api->socket(), requests); }};
+
+    // Sent from the strand, so that the requests after the first one are
+    // queued, and written in batches of many sentences
+    boost::asio::post(api->get_executor(), [&]() {
+        for (std::size_t i {0}; i < requests; ++i) {
+            auto req = api->make_request(fmt::format("/command/{}", i));
+            req->add_param("value", std::string(100, 'x'));
+
+            api->async_send(std::move(req),
+                            [&completed, i](const auto &err, auto &&) {
+                                EXPECT_FALSE(err);
+                                EXPECT_EQ(completed, i);
+                                ++completed;
+                                return false;
+                            });
+        }
+    });
+
+    while (completed < requests) {
+        io.poll();
+        std::this_thread::yield();
+    }
+
+    responder.join();
+
+    EXPECT_EQ(api->in_flight(), 0);
+
+    api->close();
+}
+
+TEST_F(ConnectedBasicApiTest, ReadBudgetTest) {
+    constexpr std::size_t rows   = 200;
+    constexpr std::size_t budget = 16;
+
+    api->read_budget({budget, 0});
+
+    auto req = api->make_request("/test/getall");
+    auto tag = fmt::format(".tag={}", req->tag());
+
+    // Read at once, as a large result would be
+    std::vector<std::uint8_t> buf {};
+
+    for (std::size_t i {0}; i < rows; ++i) {
+        auto row = ::make_sentence("!re", fmt::format("=.id=*{}", i), tag);
+        buf.insert(buf.end(), row.begin(), row.end());
+    }
+
+    auto done = ::make_sentence("!done", tag);
+    buf.insert(buf.end(), done.begin(), done.end());
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(buf));
+
+    std::size_t                handled {0};
+    std::optional<std::size_t> interleaved {};
+
+    api->async_send(std::move(req), [&](const auto &err, auto &&resp) {
+        EXPECT_FALSE(err);
+
+        // Another handler, which becomes ready while the rows are handled
+        if (++handled == 1) {
+            boost::asio::post(io, [&]() { interleaved = handled; });
+        }
+
+        if (resp.type() == tikpp::response_type::normal) {
+            api->close();
+            return false;
+        }
+
+        return true;
+    });
+
+    io.run();
+
+    EXPECT_EQ(handled, rows + 1);
+    ASSERT_TRUE(interleaved.has_value());
+    EXPECT_EQ(*interleaved, budget);
+
+    const auto &stats = api->read_stats();
+    EXPECT_EQ(stats.sentences(), rows + 1);
+    EXPECT_EQ(stats.yields(), (rows + 1) / budget);
+    EXPECT_GT(stats.turns(), stats.yields());
+    EXPECT_GT(stats.longest_turn().count(), 0);
+    EXPECT_GE(stats.busy_time(), stats.longest_turn());
+}
+
+TEST_F(ConnectedBasicApiTest, InFlightWindowTest) {
+    constexpr std::size_t window   = 2;
+    constexpr std::size_t requests = 4;
+
+    api->max_in_flight(window);
+
+    std::vector<std::uint32_t>            tags {};
+    std::vector<std::vector<std::string>> sentences {};
+    std::atomic_bool                      read {false};
+    std::size_t                           completed {0};
+
+    auto reader = [this, &sentences, &read](std::size_t count) {
+        read.store(false);
+        return std::thread {[this, &sentences, &read, count] {
+            auto rest = ::read_sentences(api->socket(), count);
+            sentences.insert(sentences.end(), rest.begin(), rest.end());
+            read.store(true);
+        }};
+    };
+
+    auto wait_read = [this, &read](std::thread &thread) {
+        while (!read.load()) {
+            io.poll();
+            std::this_thread::yield();
+        }
+
+        thread.join();
+        io.poll();
+    };
+
+    auto first = reader(window);
+
+    for (std::size_t i {0}; i < requests; ++i) {
+        auto req = api->make_request(fmt::format("/command/{}", i));
+        tags.push_back(req->tag());
+
+        api->async_send(std::move(req), [&completed](const auto &err, auto &&) {
+            EXPECT_FALSE(err);
+            ++completed;
+            return false;
+        });
+    }
+
+    wait_read(first);
+
+    // The rest of the requests are held back until the first ones complete
+    ASSERT_EQ(sentences.size(), window);
+    EXPECT_EQ(api->in_flight(), window);
+
+    auto next = reader(1);
+    auto resp = ::make_sentence("!done", fmt::format(".tag={}", tags[0]));
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(resp));
+
+    wait_read(next);
+
+    EXPECT_EQ(completed, 1);
+    ASSERT_EQ(sentences.size(), window + 1);
+    EXPECT_EQ(sentences.back()[0], "/command/2");
+    EXPECT_EQ(api->in_flight(), window);
+
+    api->close();
+    EXPECT_EQ(api->in_flight(), 0);
+}
+
+TEST_F(BasicApiTest, ReconnectTest) {
+    tikpp::reconnect_policy policy {};
+    policy.initial_delay = std::chrono::milliseconds {1};
+    api->reconnect_policy(policy);
+
+    std::vector<std::vector<std::string>> sentences {};
+    std::atomic_bool                      read {false};
+
+    auto reader = [this, &sentences, &read](std::size_t count) {
+        read.store(false);
+        sentences.clear();
+        return std::thread {[this, &sentences, &read, count] {
+            sentences = ::read_sentences(api->socket(), count);
+            read.store(true);
+        }};
+    };
+
+    auto poll_until = [this](auto &&done) {
+        while (!done()) {
+            io.poll();
+            std::this_thread::yield();
+        }
+    };
+
+    auto respond = [this](const std::string &tag) {
+        auto resp = ::make_sentence("!done", tag);
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(resp));
+    };
+
+    respond(".tag=0");
+
+    bool opened {false};
+    api->async_open(ConnectedBasicApiTest::test_ip_address,
+                    ConnectedBasicApiTest::test_api_port, "admin", "secret",
+                    [&opened](const auto &err) {
+                        EXPECT_FALSE(err);
+                        opened = true;
+                    });
+
+    auto login = reader(1);
+    poll_until([&]() { return opened && read.load(); });
+    login.join();
+
+    auto listen = api->make_request("/interface/listen");
+    auto print  = api->make_request("/system/resource/print");
+    auto add    = api->make_request("/ip/address/add");
+
+    auto listen_tag = listen->tag();
+    auto print_tag  = print->tag();
+
+    bool printed {false}, add_failed {false};
+
+    api->async_send(std::move(listen), [](const auto &err, auto &&) {
+        ADD_FAILURE() << "Listen request completed: " << err.message();
+        return false;
+    });
+    api->async_send(std::move(print), [&printed](const auto &err, auto &&) {
+        EXPECT_FALSE(err);
+        printed = true;
+        return false;
+    });
+    api->async_send(std::move(add), [&add_failed](const auto &err, auto &&) {
+        EXPECT_TRUE(err);
+        add_failed = true;
+        return false;
+    });
+
+    auto written = reader(3);
+    poll_until([&]() { return read.load(); });
+    written.join();
+
+    // The connection is lost after the requests were written
+    auto fatal = ::make_sentence("!fatal", "Session closed");
+    boost::asio::write(api->socket().input_pipe(), boost::asio::buffer(fatal));
+
+    poll_until([&]() { return add_failed && api->is_open(); });
+    EXPECT_TRUE(api->is_reconnecting());
+
+    login = reader(1);
+    poll_until([&]() { return read.load(); });
+    login.join();
+
+    ASSERT_EQ(sentences.size(), 1);
+    EXPECT_EQ(sentences[0][0], "/login");
+
+    auto resent = reader(2);
+    respond(sentences[0][1]);
+    poll_until([&]() { return read.load(); });
+    resent.join();
+
+    EXPECT_FALSE(api->is_reconnecting());
+
+    // The idempotent and the long-lived requests are sent again as they were
+    ASSERT_EQ(sentences.size(), 2);
+    EXPECT_EQ(sentences[0][0], "/interface/listen");
+    EXPECT_EQ(sentences[0][1], fmt::format(".tag={}", listen_tag));
+    EXPECT_EQ(sentences[1][0], "/system/resource/print");
+    EXPECT_EQ(sentences[1][1], fmt::format(".tag={}", print_tag));
+
+    respond(fmt::format(".tag={}", print_tag));
+    poll_until([&]() { return printed; });
+
+    EXPECT_FALSE(last_error());
+    api->close();
+}
+
+TEST_F(BasicApiTest, LoginCacheTest) {
+    constexpr auto challenge = "0123456789abcdef0123456789abcdef";
+
+    auto cache = tikpp::make_login_cache();
+    api->login_cache(cache);
+
+    auto key = fmt::format("{}:{}", ConnectedBasicApiTest::test_ip_address,
+                           ConnectedBasicApiTest::test_api_port);
+
+    // Opens the connection, answering each login sentence with the next
+    // response, and returns the written login sentences
+    auto open = [this](std::vector<std::vector<std::string>> responses) {
+        std::vector<std::vector<std::string>> sentences {};
+        bool                                  opened {false};
+
+        api->async_open(ConnectedBasicApiTest::test_ip_address,
+                        ConnectedBasicApiTest::test_api_port, "admin",
+                        "secret", [&opened](const auto &err) {
+                            EXPECT_FALSE(err);
+                            opened = true;
+                        });
+
+        for (auto &response : responses) {
+            std::atomic_bool read {false};
+            std::thread      reader {[this, &sentences, &read] {
+                sentences.push_back(
+                    ::read_sentences(api->socket(), 1).front());
+                read.store(true);
+            }};
+
+            while (!read.load()) {
+                io.poll();
+                std::this_thread::yield();
+            }
+
+            reader.join();
+
+            std::vector<std::uint8_t> buf {};
+            response.push_back(sentences.back()[1]);
+
+            for (const auto &word : response) {
+                tikpp::detail::encode_word(word, buf);
+            }
+
+            tikpp::detail::encode_length(0, buf);
+            boost::asio::write(api->socket().input_pipe(),
+                               boost::asio::buffer(buf));
+        }
+
+        while (!opened) {
+            io.poll();
+            std::this_thread::yield();
+        }
+
+        api->close();
+        return sentences;
+    };
+
+    auto ret = fmt::format("=ret={}", challenge);
+
+    // An old router answers the plain login with a challenge
+    auto sentences = open({{"!done", ret}, {"!done"}});
+    ASSERT_EQ(sentences.size(), 2);
+    EXPECT_TRUE(::contains_word(sentences[0], "=password=secret"));
+    EXPECT_EQ(cache->lookup(key), tikpp::login_protocol::v1);
+
+    // Then it is asked for a challenge straight away
+    sentences = open({{"!done", ret}, {"!done"}});
+    ASSERT_EQ(sentences.size(), 2);
+    EXPECT_EQ(sentences[0].size(), 2);
+    EXPECT_EQ(sentences[0][0], "/login");
+    EXPECT_FALSE(::contains_word(sentences[1], "=password=secret"));
+
+    // Until it no longer uses the old protocol
+    sentences = open({{"!done"}, {"!done"}});
+    ASSERT_EQ(sentences.size(), 2);
+    EXPECT_EQ(sentences[0].size(), 2);
+    EXPECT_TRUE(::contains_word(sentences[1], "=password=secret"));
+    EXPECT_EQ(cache->lookup(key), tikpp::login_protocol::v2);
+
+    EXPECT_FALSE(last_error());
+}
+
+TEST_F(BasicApiTest, HealthCheckTest) {
+    tikpp::health_check_policy policy {};
+    policy.interval          = std::chrono::milliseconds {20};
+    policy.timeout           = std::chrono::milliseconds {30};
+    policy.failure_threshold = 1;
+    policy.open_duration     = std::chrono::milliseconds {50};
+    api->health_check(policy);
+
+    // Answers the first probe, leaves the second one unanswered, and answers
+    // the one which is sent once the circuit breaker goes half open
+    std::atomic_bool answered {false};
+    std::thread      router {[this, &answered] {
+        auto answer = [this](const std::vector<std::string> &probe,
+                             bool                            row) {
+            EXPECT_EQ(probe[0], "/system/identity/print");
+
+            auto tag = *std::find_if(probe.begin(), probe.end(),
+                                     [](const auto &word) {
+                                         return word.rfind(".tag=", 0) == 0;
+                                     });
+
+            auto resp = ::make_sentence("!done", tag);
+
+            if (row) {
+                auto re = ::make_sentence("!re", "=name=router", tag);
+                resp.insert(resp.begin(), re.begin(), re.end());
+            }
+
+            boost::asio::write(api->socket().input_pipe(),
+                               boost::asio::buffer(resp));
+        };
+
+        answer(::read_sentences(api->socket(), 1).front(), true);
+
+        // The timed out probe is cancelled on the router
+        auto unanswered = ::read_sentences(api->socket(), 2);
+        EXPECT_EQ(unanswered[1][0], "/cancel");
+
+        answer(::read_sentences(api->socket(), 1).front(), false);
+        answered.store(true);
+    }};
+
+    auto poll_until = [this](auto &&pred) {
+        while (!pred()) {
+            io.poll();
+            std::this_thread::yield();
+        }
+    };
+
+    api->async_open(ConnectedBasicApiTest::test_ip_address,
+                    ConnectedBasicApiTest::test_api_port,
+                    [](const auto &err) { EXPECT_FALSE(err); });
+
+    poll_until([this]() { return api->rtt().samples() == 1; });
+    EXPECT_GT(api->rtt().srtt().count(), 0);
+    EXPECT_TRUE(api->is_healthy());
+
+    // The unanswered probe times out, which opens the circuit breaker
+    poll_until([this]() { return !api->is_healthy(); });
+
+    bool failed {false};
+    api->async_send(api->make_request("/interface/print"),
+                    [&failed](const auto &err, auto &&) {
+                        EXPECT_EQ(err, tikpp::error_code::router_unhealthy);
+                        failed = true;
+                        return false;
+                    });
+
+    poll_until([&failed]() { return failed; });
+
+    // Until a probe is answered again
+    poll_until([this, &answered]() {
+        return answered.load() && api->is_healthy();
+    });
+
+    router.join();
+
+    EXPECT_EQ(api->rtt().samples(), 2);
+    EXPECT_FALSE(last_error());
+    api->close();
+}
+
+TEST_F(BasicApiTest, BoundHandlerTest) {
+    auto other  = boost::asio::make_strand(io);
+    bool called = false;
+
+    api->async_open(ConnectedBasicApiTest::test_ip_address,
+                    ConnectedBasicApiTest::test_api_port,
+                    boost::asio::bind_executor(other, [&](const auto &err) {
+                        EXPECT_FALSE(err);
+                        EXPECT_TRUE(other.running_in_this_thread());
+                        EXPECT_FALSE(
+                            api->get_executor().running_in_this_thread());
+                        called = true;
+
+                        api->close();
+                    }));
+
+    io.run();
+    EXPECT_TRUE(called);
+}
+
+TEST(BasicApiExecutorTest, ThreadPoolTest) {
+    boost::asio::thread_pool       pool {2};
+    boost::asio::ip::tcp::acceptor acceptor {
+        pool, {boost::asio::ip::make_address("127.0.0.1"), 0}};
+    boost::asio::ip::tcp::socket peer {pool};
+
+    acceptor.async_accept(peer, [](const auto &err) { EXPECT_FALSE(err); });
+
+    auto api = tikpp::make_api(pool.get_executor(), [](const auto &) {});
+    std::promise<boost::system::error_code> opened {};
+
+    api->async_open("127.0.0.1", acceptor.local_endpoint().port(),
+                    [&opened, &api](const auto &err) {
+                        EXPECT_TRUE(
+                            api->get_executor().running_in_this_thread());
+                        opened.set_value(err);
+                    });
+
+    EXPECT_FALSE(opened.get_future().get());
+    EXPECT_TRUE(api->is_open());
+
+    boost::asio::post(api->get_executor(), [&api] { api->close(); });
+    pool.join();
+}
+
 } // namespace tikpp::tests
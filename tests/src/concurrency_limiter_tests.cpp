@@ -0,0 +1,95 @@
+#include "tikpp/concurrency_limiter.hpp"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstddef>
+
+namespace tikpp::tests {
+
+using namespace std::chrono_literals;
+
+TEST(ConcurrencyLimiterTest, BoundsTest) {
+    tikpp::concurrency_limiter limiter {{/* initial_limit */ 100,
+                                         /* min_limit */ 2,
+                                         /* max_limit */ 8}};
+
+    EXPECT_EQ(limiter.limit(), 8);
+
+    for (std::size_t i {0}; i < 1000; ++i) {
+        limiter.on_drop();
+    }
+
+    EXPECT_EQ(limiter.limit(), 2);
+}
+
+TEST(ConcurrencyLimiterTest, IncreaseTest) {
+    tikpp::concurrency_limiter limiter {{/* initial_limit */ 4}};
+
+    // Grows by one request for each window of fast responses
+    for (std::size_t i {0}; i < 4; ++i) {
+        limiter.on_sample(1ms);
+    }
+
+    EXPECT_EQ(limiter.limit(), 5);
+
+    for (std::size_t i {0}; i < 5; ++i) {
+        limiter.on_sample(1ms);
+    }
+
+    EXPECT_EQ(limiter.limit(), 6);
+}
+
+TEST(ConcurrencyLimiterTest, DecreaseTest) {
+    tikpp::concurrency_limiter::options opts {};
+    opts.initial_limit = 16;
+    opts.backoff       = 0.5;
+
+    tikpp::concurrency_limiter limiter {opts};
+
+    for (std::size_t i {0}; i < 16; ++i) {
+        limiter.on_sample(1ms);
+    }
+
+    EXPECT_EQ(limiter.limit(), 17);
+
+    limiter.on_sample(10ms);
+    EXPECT_EQ(limiter.limit(), 8);
+
+    // Backs off only once for a whole window of slow responses
+    for (std::size_t i {0}; i < 7; ++i) {
+        limiter.on_sample(10ms);
+    }
+
+    EXPECT_EQ(limiter.limit(), 8);
+
+    limiter.on_drop();
+    EXPECT_EQ(limiter.limit(), 4);
+}
+
+TEST(ConcurrencyLimiterTest, MinLatencyWindowTest) {
+    tikpp::concurrency_limiter::options opts {};
+    opts.initial_limit      = 1;
+    opts.min_latency_window = 10;
+
+    tikpp::concurrency_limiter limiter {opts};
+
+    for (std::size_t i {0}; i < 10; ++i) {
+        limiter.on_sample(1ms);
+    }
+
+    // The path got slower for good, which is learnt after a latency window
+    for (std::size_t i {0}; i < 20; ++i) {
+        limiter.on_sample(5ms);
+    }
+
+    auto limit = limiter.limit();
+
+    for (std::size_t i {0}; i < 10; ++i) {
+        limiter.on_sample(5ms);
+    }
+
+    EXPECT_GT(limiter.limit(), limit);
+}
+
+} // namespace tikpp::tests
@@ -0,0 +1,148 @@
+#include "tikpp/api.hpp"
+#include "tikpp/connection_options.hpp"
+#include "tikpp/io_context.hpp"
+
+#include "gtest/gtest.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/socket_base.hpp>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <chrono>
+
+namespace {
+
+/*!
+ * \brief Gets an integer option of a socket, which Asio has no type for
+ */
+auto get_int_option(boost::asio::ip::tcp::socket &sock, int level, int name)
+    -> int {
+    int       value {0};
+    socklen_t len {sizeof(value)};
+
+    ::getsockopt(sock.native_handle(), level, name, &value, &len);
+    return value;
+}
+
+/*!
+ * \brief A connected pair of loopback TCP sockets
+ */
+struct socket_pair {
+    explicit socket_pair(tikpp::io_context &io)
+        : acceptor {io, {boost::asio::ip::make_address("127.0.0.1"), 0}},
+          client {io},
+          server {io} {
+        client.connect(acceptor.local_endpoint());
+        acceptor.accept(server);
+    }
+
+    boost::asio::ip::tcp::acceptor acceptor;
+    boost::asio::ip::tcp::socket   client, server;
+};
+
+struct error_handler {
+    void operator()(const boost::system::error_code &) const {
+    }
+};
+
+} // namespace
+
+namespace tikpp::tests {
+
+TEST(ConnectionOptionsTest, DefaultsTest) {
+    tikpp::io_context io {};
+    ::socket_pair     pair {io};
+
+    tikpp::apply_connection_options(pair.client, {});
+
+    boost::asio::ip::tcp::no_delay       no_delay {};
+    boost::asio::socket_base::keep_alive keep_alive {};
+    pair.client.get_option(no_delay);
+    pair.client.get_option(keep_alive);
+
+    EXPECT_TRUE(no_delay.value());
+    EXPECT_TRUE(keep_alive.value());
+
+#ifdef TIKPP_HAS_KEEPALIVE_OPTIONS
+    EXPECT_EQ(::get_int_option(pair.client, IPPROTO_TCP, TCP_KEEPIDLE), 30);
+    EXPECT_EQ(::get_int_option(pair.client, IPPROTO_TCP, TCP_KEEPINTVL), 10);
+    EXPECT_EQ(::get_int_option(pair.client, IPPROTO_TCP, TCP_KEEPCNT), 3);
+#endif
+
+#ifdef TCP_QUICKACK
+    EXPECT_EQ(::get_int_option(pair.client, IPPROTO_TCP, TCP_QUICKACK), 1);
+#endif
+}
+
+TEST(ConnectionOptionsTest, CustomTest) {
+    tikpp::io_context io {};
+    ::socket_pair     pair {io};
+
+    tikpp::connection_options options {};
+    options.no_delay            = false;
+    options.keep_alive          = false;
+    options.receive_buffer_size = 256 * 1024;
+    options.send_buffer_size    = 128 * 1024;
+
+    boost::asio::socket_base::receive_buffer_size default_rcvbuf {};
+    pair.client.get_option(default_rcvbuf);
+
+    tikpp::apply_connection_options(pair.client, options);
+
+    boost::asio::ip::tcp::no_delay                no_delay {};
+    boost::asio::socket_base::keep_alive          keep_alive {};
+    boost::asio::socket_base::receive_buffer_size rcvbuf {};
+    boost::asio::socket_base::send_buffer_size    sndbuf {};
+    pair.client.get_option(no_delay);
+    pair.client.get_option(keep_alive);
+    pair.client.get_option(rcvbuf);
+    pair.client.get_option(sndbuf);
+
+    EXPECT_FALSE(no_delay.value());
+    EXPECT_FALSE(keep_alive.value());
+
+    // The kernel may round the sizes (Linux doubles them), or cap them
+    EXPECT_NE(rcvbuf.value(), default_rcvbuf.value());
+    EXPECT_GE(sndbuf.value(), 4096);
+}
+
+TEST(ConnectionOptionsTest, ApiTest) {
+    tikpp::io_context              io {};
+    boost::asio::ip::tcp::acceptor acceptor {
+        io, {boost::asio::ip::make_address("127.0.0.1"), 0}};
+
+    tikpp::connection_options options {};
+    options.keep_alive_idle = std::chrono::seconds {45};
+
+    auto api = tikpp::make_api(io, ::error_handler {}, options);
+    EXPECT_EQ(api->connection_options().keep_alive_idle.count(), 45);
+
+    // Not applied to the socket until it is connected
+    bool opened {false};
+    api->async_open("127.0.0.1", acceptor.local_endpoint().port(),
+                    [&opened](const auto &err) {
+                        EXPECT_FALSE(err);
+                        opened = true;
+                    });
+
+    boost::asio::ip::tcp::socket server {io};
+    acceptor.accept(server);
+
+    while (!opened) {
+        io.run_one();
+    }
+
+    boost::asio::ip::tcp::no_delay no_delay {};
+    api->socket().get_option(no_delay);
+    EXPECT_TRUE(no_delay.value());
+
+#ifdef TIKPP_HAS_KEEPALIVE_OPTIONS
+    EXPECT_EQ(::get_int_option(api->socket(), IPPROTO_TCP, TCP_KEEPIDLE), 45);
+#endif
+
+    api->close();
+}
+
+} // namespace tikpp::tests
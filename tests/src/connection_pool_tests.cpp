@@ -0,0 +1,377 @@
+#include "tikpp/commands/cancel.hpp"
+#include "tikpp/connection_pool.hpp"
+#include "tikpp/request.hpp"
+#include "tikpp/tests/fakes/socket.hpp"
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+template <typename... Arg>
+std::vector<std::uint8_t> make_sentence(Arg &&... args) {
+    std::vector<std::uint8_t> buf {};
+
+    (tikpp::detail::encode_word(
+         tikpp::detail::convert_back(std::forward<Arg>(args)), buf),
+     ...);
+
+    tikpp::detail::encode_length(0, buf);
+    return buf;
+}
+
+} // namespace
+
+namespace tikpp::tests {
+
+struct ConnectionPoolTest : ::testing::Test {
+    using error_handler_type =
+        std::function<void(const boost::system::error_code &)>;
+    using pool_type = tikpp::connection_pool<
+        tikpp::basic_api<tikpp::tests::fakes::socket, error_handler_type>>;
+
+    static constexpr auto pool_size   = 3;
+    static constexpr auto pinned_size = 1;
+
+    ConnectionPoolTest()
+        : pool {tikpp::make_connection_pool<tikpp::tests::fakes::socket>(
+              io, pool_size, pinned_size,
+              error_handler_type {[](const auto &err) {
+                  fmt::print("[!] An error occured: {}\n", err.message());
+              }})} {
+    }
+
+    void SetUp() override {
+        pool->async_open("1.2.3.4", 8728,
+                         [](const auto &err) { EXPECT_FALSE(err); });
+        io.poll();
+        EXPECT_TRUE(pool->is_open());
+    }
+
+    template <typename Request>
+    inline auto read_request(std::size_t session, const Request &req)
+        -> bool {
+        std::vector<std::uint8_t> expected {}, result {};
+        req->encode(expected);
+        result.resize(expected.size());
+
+        boost::asio::read(pool->session(session)->socket().output_pipe(),
+                          boost::asio::buffer(result));
+        return expected == result;
+    }
+
+    tikpp::io_context          io;
+    std::shared_ptr<pool_type> pool;
+};
+
+TEST_F(ConnectionPoolTest, LeastLoadedDispatchTest) {
+    std::size_t             completed {0};
+    std::set<std::uint32_t> tags {};
+
+    const auto on_response = [&completed](const auto &err, auto &&resp) {
+        EXPECT_FALSE(err);
+        EXPECT_EQ(resp.type(), tikpp::response_type::normal);
+        ++completed;
+        return false;
+    };
+
+    // Each shared session gets one request before any gets a second one
+    for (std::size_t i {0}; i < 4; ++i) {
+        auto req = pool->make_request("/system/resource/print");
+        EXPECT_TRUE(tags.insert(req->tag()).second);
+
+        auto session = pinned_size + i % (pool_size - pinned_size);
+        pool->async_send(req, on_response);
+        io.poll();
+
+        EXPECT_TRUE(read_request(session, req));
+        EXPECT_EQ(pool->in_flight(session),
+                  i / (pool_size - pinned_size) + 1);
+    }
+
+    EXPECT_EQ(pool->in_flight(0), 0);
+
+    for (std::uint32_t tag : tags) {
+        auto session = pinned_size + tag % (pool_size - pinned_size);
+        auto buf     = ::make_sentence("!done", fmt::format(".tag={}", tag));
+        boost::asio::write(pool->session(session)->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+    }
+
+    io.poll();
+
+    EXPECT_EQ(completed, tags.size());
+
+    for (std::size_t i {0}; i < pool_size; ++i) {
+        EXPECT_EQ(pool->in_flight(i), 0);
+    }
+
+    pool->close();
+    EXPECT_FALSE(pool->is_open());
+}
+
+TEST_F(ConnectionPoolTest, PinnedListenTest) {
+    auto listen = pool->make_request("/interface/listen");
+    auto print  = pool->make_request("/interface/print");
+
+    EXPECT_TRUE(pool_type::is_long_lived(*listen));
+    EXPECT_FALSE(pool_type::is_long_lived(*print));
+
+    pool->async_send(listen, [](const auto &err, auto &&) {
+        EXPECT_FALSE(err);
+        return true;
+    });
+    pool->async_send(print, [](const auto &err, auto &&) {
+        EXPECT_FALSE(err);
+        return false;
+    });
+    io.poll();
+
+    EXPECT_TRUE(read_request(0, listen));
+    EXPECT_TRUE(read_request(pinned_size, print));
+    EXPECT_EQ(pool->in_flight(0), 1);
+    EXPECT_EQ(pool->in_flight(pinned_size), 1);
+
+    // The cancellation is sent over the session which owns the request
+    bool cancelled {false};
+    pool->async_cancel(listen->tag(), [&cancelled](const auto &err) {
+        EXPECT_FALSE(err);
+        cancelled = true;
+    });
+    io.poll();
+
+    auto cancel_tag = pool->current_tag() - 1;
+    auto buf = ::make_sentence("!done", fmt::format(".tag={}", cancel_tag));
+    boost::asio::write(pool->session(0)->socket().input_pipe(),
+                       boost::asio::buffer(buf));
+    io.poll();
+
+    EXPECT_TRUE(cancelled);
+
+    pool->close();
+}
+
+TEST_F(ConnectionPoolTest, HedgingTest) {
+    constexpr std::size_t warmup = 16;
+
+    tikpp::hedging_policy policy {};
+    policy.min_samples = warmup;
+    policy.min_delay   = std::chrono::milliseconds {5};
+    pool->hedging(policy);
+
+    const auto respond = [this](std::size_t session, const auto &req) {
+        EXPECT_TRUE(read_request(session, req));
+
+        auto buf = ::make_sentence("!done", fmt::format(".tag={}", req->tag()));
+        boost::asio::write(pool->session(session)->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+        io.poll();
+    };
+
+    // Reads which respond in time are not hedged, and give the latencies
+    // which the hedge delay is taken from
+    for (std::size_t i {0}; i < warmup; ++i) {
+        auto req = pool->make_request("/system/resource/print");
+        pool->async_send(req, [](const auto &err, auto &&) {
+            EXPECT_FALSE(err);
+            return false;
+        });
+        io.poll();
+
+        respond(pinned_size, req);
+    }
+
+    EXPECT_EQ(pool->hedge_delay(), std::chrono::milliseconds {5});
+    EXPECT_EQ(pool->hedging_stats().reads, warmup);
+    EXPECT_EQ(pool->hedging_stats().hedged, 0);
+
+    // A read which does not respond in time is sent over the other shared
+    // session, which responds first
+    auto req = pool->make_request("/interface/print");
+    std::vector<tikpp::response_type> responses {};
+
+    pool->async_send(req, [&responses](const auto &err, auto &&resp) {
+        EXPECT_FALSE(err);
+        responses.push_back(resp.type());
+        return resp.type() == tikpp::response_type::data;
+    });
+    io.poll();
+
+    EXPECT_TRUE(read_request(pinned_size, req));
+
+    while (pool->hedging_stats().hedged == 0) {
+        io.run_one_for(std::chrono::milliseconds {10});
+    }
+
+    io.poll();
+
+    auto hedge = req->clone(pool->current_tag() - 1);
+    EXPECT_TRUE(read_request(pinned_size + 1, hedge));
+
+    auto tag = fmt::format(".tag={}", hedge->tag());
+    auto buf = ::make_sentence("!re", "=name=ether1", tag);
+    auto done = ::make_sentence("!done", tag);
+    buf.insert(buf.end(), done.begin(), done.end());
+
+    boost::asio::write(pool->session(pinned_size + 1)->socket().input_pipe(),
+                       boost::asio::buffer(buf));
+    io.poll();
+
+    ASSERT_EQ(responses.size(), 2);
+    EXPECT_EQ(responses[0], tikpp::response_type::data);
+    EXPECT_EQ(responses[1], tikpp::response_type::normal);
+
+    // The first attempt is cancelled on the router
+    auto cancel = std::make_shared<tikpp::commands::cancel>(
+        pool->current_tag() - 1, req->tag());
+    EXPECT_TRUE(read_request(pinned_size, cancel));
+
+    EXPECT_EQ(pool->hedging_stats().hedged, 1);
+    EXPECT_EQ(pool->hedging_stats().won, 1);
+
+    for (std::size_t i {0}; i < pool_size; ++i) {
+        EXPECT_EQ(pool->in_flight(i), 0);
+    }
+
+    // Writes are not hedged
+    auto add = pool->make_request("/ip/address/add");
+    pool->async_send(add, [](const auto &, auto &&) { return false; });
+    io.poll();
+
+    EXPECT_TRUE(read_request(pinned_size, add));
+    EXPECT_EQ(pool->hedging_stats().reads, warmup + 1);
+
+    pool->close();
+}
+
+TEST_F(ConnectionPoolTest, HedgeDelayTest) {
+    constexpr std::size_t               samples = 16;
+    constexpr std::chrono::milliseconds service {10};
+
+    tikpp::hedging_policy policy {};
+    policy.quantile    = 0.5;
+    policy.window      = samples;
+    policy.min_samples = samples;
+    policy.min_delay   = std::chrono::milliseconds {1};
+    policy.max_ratio   = 1.0;
+    policy.max_burst   = samples;
+    pool->hedging(policy);
+
+    const auto respond = [this](std::size_t session, const auto &req) {
+        auto buf = ::make_sentence("!done", fmt::format(".tag={}", req->tag()));
+        boost::asio::write(pool->session(session)->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+        io.poll();
+    };
+
+    const auto send = [this]() {
+        auto req = pool->make_request("/system/resource/print");
+        pool->async_send(req, [](const auto &err, auto &&) {
+            EXPECT_FALSE(err);
+            return false;
+        });
+        io.poll();
+
+        EXPECT_TRUE(read_request(pinned_size, req));
+        return req;
+    };
+
+    for (std::size_t i {0}; i < samples; ++i) {
+        auto req = send();
+        std::this_thread::sleep_for(service);
+        respond(pinned_size, req);
+    }
+
+    EXPECT_GE(pool->hedge_delay(), service);
+
+    // Reads whose first attempt never responds, and whose hedge responds at
+    // once, still took the hedge delay for the caller
+    for (std::size_t i {0}; i < samples; ++i) {
+        auto req    = send();
+        auto hedged = pool->hedging_stats().hedged;
+
+        while (pool->hedging_stats().hedged == hedged) {
+            io.run_one_for(std::chrono::milliseconds {1});
+        }
+
+        io.poll();
+
+        auto hedge = req->clone(pool->current_tag() - 1);
+        EXPECT_TRUE(read_request(pinned_size + 1, hedge));
+        respond(pinned_size + 1, hedge);
+
+        auto cancel = std::make_shared<tikpp::commands::cancel>(
+            pool->current_tag() - 1, req->tag());
+        EXPECT_TRUE(read_request(pinned_size, cancel));
+    }
+
+    EXPECT_EQ(pool->hedging_stats().won, samples);
+    EXPECT_GE(pool->hedge_delay(), service);
+
+    pool->close();
+}
+
+TEST_F(ConnectionPoolTest, ConcurrentOpenTest) {
+    constexpr std::size_t sessions   = 32;
+    constexpr std::size_t io_threads = 4;
+
+    auto concurrent = tikpp::make_connection_pool<tikpp::tests::fakes::socket>(
+        io, sessions, 0, error_handler_type {[](const auto &) {}});
+
+    // Half of the sessions fail, so the first error is stored concurrently
+    for (std::size_t i {1}; i < sessions; i += 2) {
+        concurrent->session(i)->socket().always_fails(true);
+    }
+
+    std::atomic_size_t        calls {0};
+    boost::system::error_code error {};
+    std::vector<std::thread>  threads {};
+
+    auto work = boost::asio::make_work_guard(io);
+
+    for (std::size_t i {0}; i < io_threads; ++i) {
+        threads.emplace_back([this] { io.run(); });
+    }
+
+    concurrent->async_open("1.2.3.4", 8728,
+                           [&calls, &error](const auto &err) {
+                               if (calls.fetch_add(1) == 0) {
+                                   error = err;
+                               }
+                           });
+
+    while (calls.load() == 0) {
+        std::this_thread::yield();
+    }
+
+    work.reset();
+    io.stop();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(calls.load(), 1);
+    EXPECT_EQ(error, boost::asio::error::fault);
+
+    for (std::size_t i {0}; i < sessions; i += 2) {
+        EXPECT_TRUE(concurrent->session(i)->is_open());
+    }
+
+    concurrent->close();
+    pool->close();
+}
+
+} // namespace tikpp::tests
@@ -0,0 +1,145 @@
+#include "tikpp/data/aggregates.hpp"
+#include "tikpp/data/model.hpp"
+#include "tikpp/data/types/bytes.hpp"
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct test_model : tikpp::data::model {
+    read_only<std::string>                 group;
+    read_only<std::uint32_t>               number;
+    read_only<tikpp::data::types::bytes>   size;
+};
+
+auto make_items() -> std::vector<test_model> {
+    std::vector<test_model> ret {};
+
+    for (std::uint32_t i {1}; i <= 10; ++i) {
+        test_model m {};
+        m.group  = tikpp::data::types::read_only<std::string> {
+            i % 2 == 0 ? "even" : "odd"};
+        m.number = tikpp::data::types::read_only<std::uint32_t> {i * 3 % 11};
+        m.size   = tikpp::data::types::read_only<tikpp::data::types::bytes> {
+            tikpp::data::types::bytes {i * 1024ULL}};
+        ret.push_back(std::move(m));
+    }
+
+    return ret;
+}
+
+template <typename Aggregate>
+auto run(Aggregate aggregate) {
+    for (const auto &item : ::make_items()) {
+        aggregate(item);
+    }
+
+    return aggregate.result();
+}
+
+} // namespace
+
+namespace tikpp::tests {
+
+using namespace tikpp::data::aggregates;
+
+TEST(AggregatesTests, CountTest) {
+    EXPECT_EQ(::run(count {}), 10);
+    EXPECT_EQ(count {}.result(), 0);
+}
+
+TEST(AggregatesTests, SumTest) {
+    EXPECT_EQ(::run(make_sum<::test_model>(&::test_model::size)), 55 * 1024);
+    EXPECT_EQ(::run(make_sum<::test_model>(
+                  [](const auto &item) { return item.number.value() * 2; })),
+              2 * (3 + 6 + 9 + 1 + 4 + 7 + 10 + 2 + 5 + 8));
+}
+
+TEST(AggregatesTests, MinMaxTest) {
+    auto min = ::run(make_min<::test_model>(&::test_model::number));
+    auto max = ::run(make_max<::test_model>(&::test_model::number));
+
+    ASSERT_TRUE(min.has_value());
+    ASSERT_TRUE(max.has_value());
+    EXPECT_EQ(*min, 1);
+    EXPECT_EQ(*max, 10);
+
+    EXPECT_FALSE(
+        make_max<::test_model>(&::test_model::number).result().has_value());
+}
+
+TEST(AggregatesTests, GroupByTest) {
+    auto counts = ::run(make_group_by<::test_model>(&::test_model::group));
+
+    ASSERT_EQ(counts.size(), 2);
+    EXPECT_EQ(counts["even"], 5);
+    EXPECT_EQ(counts["odd"], 5);
+
+    auto sums = ::run(make_group_by<::test_model>(
+        &::test_model::group, make_sum<::test_model>(&::test_model::size)));
+
+    ASSERT_EQ(sums.size(), 2);
+    EXPECT_EQ(sums["even"], (2 + 4 + 6 + 8 + 10) * 1024);
+    EXPECT_EQ(sums["odd"], (1 + 3 + 5 + 7 + 9) * 1024);
+}
+
+TEST(AggregatesTests, TopKTest) {
+    auto top = ::run(make_top_k<::test_model>(3, &::test_model::number));
+
+    ASSERT_EQ(top.size(), 3);
+    EXPECT_EQ(top[0].number.value(), 10);
+    EXPECT_EQ(top[1].number.value(), 9);
+    EXPECT_EQ(top[2].number.value(), 8);
+
+    auto bottom = ::run(make_bottom_k<::test_model>(2, &::test_model::number));
+
+    ASSERT_EQ(bottom.size(), 2);
+    EXPECT_EQ(bottom[0].number.value(), 1);
+    EXPECT_EQ(bottom[1].number.value(), 2);
+
+    EXPECT_EQ(::run(make_top_k<::test_model>(20, &::test_model::number)).size(),
+              10);
+    EXPECT_TRUE(
+        ::run(make_top_k<::test_model>(0, &::test_model::number)).empty());
+}
+
+TEST(AggregatesTests, SampleTest) {
+    constexpr auto sample_size = 4;
+
+    auto items = ::run(sample<::test_model> {sample_size, 1234});
+    ASSERT_EQ(items.size(), sample_size);
+
+    for (std::size_t i {0}; i < items.size(); ++i) {
+        for (std::size_t j {i + 1}; j < items.size(); ++j) {
+            EXPECT_NE(items[i].number.value(), items[j].number.value());
+        }
+    }
+
+    EXPECT_EQ(::run(sample<::test_model> {20}).size(), 10);
+}
+
+TEST(AggregatesTests, TakeTest) {
+    take<::test_model> aggregate {3};
+
+    for (const auto &item : ::make_items()) {
+        EXPECT_FALSE(aggregate.is_done());
+        aggregate(item);
+
+        if (aggregate.is_done()) {
+            break;
+        }
+    }
+
+    auto items = aggregate.result();
+
+    ASSERT_EQ(items.size(), 3);
+    EXPECT_EQ(items[0].number.value(), 3);
+    EXPECT_EQ(items[2].number.value(), 9);
+}
+
+} // namespace tikpp::tests
@@ -0,0 +1,175 @@
+#include "tikpp/data/predicate.hpp"
+#include "tikpp/data/query.hpp"
+#include "tikpp/response.hpp"
+#include "tikpp/tests/fakes/model.hpp"
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace tikpp::data::literals;
+
+namespace {
+
+using model_type     = tikpp::tests::fakes::model2;
+using predicate_type = tikpp::data::predicate<model_type>;
+
+auto make_response(int a, const std::string &b) -> tikpp::response {
+    return tikpp::response {std::vector<std::string> {
+        "!re", fmt::format("=a={}", a), fmt::format("=b={}", b)}};
+}
+
+auto is_foo() -> predicate_type {
+    return tikpp::data::make_predicate<model_type>(
+        {"read-write-data"}, [](const model_type &m) {
+            return m.read_write_data.value() == "foo";
+        });
+}
+
+auto make_model(std::string value) -> model_type {
+    model_type ret {};
+    ret.read_write_data = std::move(value);
+    return ret;
+}
+
+} // namespace
+
+namespace tikpp::tests {
+
+TEST(QueryEvaluatorTests, ComparisonTest) {
+    auto resp = ::make_response(10, "text");
+
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?a"}, resp));
+    EXPECT_FALSE(tikpp::detail::evaluate_query({"?c"}, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?-c"}, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?=a=10"}, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?a=10"}, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?<a=9999"}, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?>a=9"}, resp));
+    EXPECT_FALSE(tikpp::detail::evaluate_query({"?>a=10"}, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?>a=-1"}, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?=b=text"}, resp));
+    EXPECT_FALSE(tikpp::detail::evaluate_query({"?=c=text"}, resp));
+}
+
+TEST(QueryEvaluatorTests, OperationsTest) {
+    auto resp = ::make_response(10, "text");
+
+    EXPECT_TRUE(tikpp::detail::evaluate_query({}, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query(("a"_t == 10 && "b"_t == "text").words, resp));
+    EXPECT_FALSE(tikpp::detail::evaluate_query(("a"_t == 10 && "b"_t != "text").words, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query(("a"_t == 11 || "b"_t == "text").words, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query(("a"_t <= 10).words, resp));
+    EXPECT_FALSE(tikpp::detail::evaluate_query((!("a"_t >= 10)).words, resp));
+    EXPECT_TRUE(tikpp::detail::evaluate_query({"?=a=9", "?#!", "?b"}, resp));
+    EXPECT_FALSE(tikpp::detail::evaluate_query({"?=a=9", "?b"}, resp));
+}
+
+TEST(QueryEvaluatorTests, FieldsTest) {
+    auto fields = tikpp::detail::query_fields(
+        ("a"_t == 10 && ("b"_t < 3 || !"c"_t) && "a"_t > 1).words);
+
+    ASSERT_EQ(fields.size(), 3);
+    EXPECT_EQ(fields[0], "a");
+    EXPECT_EQ(fields[1], "b");
+    EXPECT_EQ(fields[2], "c");
+}
+
+TEST(PredicateTests, PushableTest) {
+    predicate_type pred = "a"_t == 10 && "b"_t == "text";
+
+    EXPECT_TRUE(pred.is_pushable());
+    EXPECT_EQ(pred.pushed, ("a"_t == 10 && "b"_t == "text").words);
+
+    auto negated = !pred;
+    EXPECT_TRUE(negated.is_pushable());
+    EXPECT_EQ(negated.pushed.back(), "?#!");
+
+    auto any = pred || predicate_type {"c"_t};
+    EXPECT_TRUE(any.is_pushable());
+    EXPECT_EQ(any.pushed.back(), "?#|");
+}
+
+TEST(PredicateTests, MultiWordPushableTest) {
+    predicate_type pred {
+        tikpp::data::query {std::vector<std::string> {"?a", "?=b=text"}}};
+    auto           other = predicate_type {"c"_t};
+
+    auto any     = pred || other;
+    auto negated = !pred;
+
+    EXPECT_TRUE(any.is_pushable());
+    EXPECT_TRUE(negated.is_pushable());
+
+    for (const auto &resp :
+         {::make_response(10, "text"), ::make_response(10, "other"),
+          tikpp::response {std::vector<std::string> {"!re", "=c=1"}},
+          tikpp::response {std::vector<std::string> {"!re", "=b=text"}}}) {
+        auto lhs = tikpp::detail::evaluate_query(pred.pushed, resp);
+        auto rhs = tikpp::detail::evaluate_query(other.pushed, resp);
+
+        EXPECT_EQ(tikpp::detail::evaluate_query(any.pushed, resp), lhs || rhs);
+        EXPECT_EQ(tikpp::detail::evaluate_query(negated.pushed, resp), !lhs);
+        EXPECT_EQ(tikpp::detail::evaluate_query((!negated).pushed, resp), lhs);
+    }
+}
+
+TEST(PredicateTests, AndPushDownTest) {
+    auto pred = "a"_t == 10 && ::is_foo();
+
+    EXPECT_FALSE(pred.is_pushable());
+    EXPECT_EQ(pred.pushed, ("a"_t == 10).words);
+    ASSERT_EQ(pred.fields.size(), 1);
+    EXPECT_EQ(pred.fields[0], "read-write-data");
+
+    auto resp = ::make_response(10, "text");
+    EXPECT_TRUE(pred(resp, ::make_model("foo")));
+    EXPECT_FALSE(pred(resp, ::make_model("bar")));
+    EXPECT_TRUE(pred.evaluate(resp, ::make_model("foo")));
+    EXPECT_FALSE(pred.evaluate(::make_response(11, "text"), ::make_model("foo")));
+}
+
+TEST(PredicateTests, OrPushDownTest) {
+    auto pred = ("a"_t == 10 && ::is_foo()) || "b"_t == "text";
+
+    EXPECT_FALSE(pred.is_pushable());
+    EXPECT_EQ(pred.pushed, ("a"_t == 10 || "b"_t == "text").words);
+    EXPECT_EQ(pred.fields,
+              (std::vector<std::string> {"a", "read-write-data", "b"}));
+
+    EXPECT_TRUE(pred(::make_response(10, "other"), ::make_model("foo")));
+    EXPECT_FALSE(pred(::make_response(10, "other"), ::make_model("bar")));
+    EXPECT_TRUE(pred(::make_response(10, "text"), ::make_model("bar")));
+    EXPECT_FALSE(pred(::make_response(11, "other"), ::make_model("foo")));
+
+    auto local_only = ::is_foo() || "b"_t == "text";
+    EXPECT_FALSE(local_only.is_pushable());
+    EXPECT_TRUE(local_only.pushed.empty());
+}
+
+TEST(PredicateTests, NotTest) {
+    auto pred = !("a"_t == 10 && ::is_foo());
+
+    EXPECT_FALSE(pred.is_pushable());
+    EXPECT_TRUE(pred.pushed.empty());
+
+    EXPECT_FALSE(pred(::make_response(10, "text"), ::make_model("foo")));
+    EXPECT_TRUE(pred(::make_response(11, "text"), ::make_model("foo")));
+    EXPECT_TRUE(pred(::make_response(10, "text"), ::make_model("bar")));
+}
+
+TEST(PredicateTests, NotEmptyTest) {
+    auto none = !predicate_type {};
+
+    EXPECT_FALSE(none.is_pushable());
+    EXPECT_TRUE(none.pushed.empty());
+    EXPECT_FALSE(none(::make_response(10, "text"), ::make_model("foo")));
+
+    auto all = !none;
+    EXPECT_TRUE(
+        all.evaluate(::make_response(10, "text"), ::make_model("foo")));
+}
+
+} // namespace tikpp::tests
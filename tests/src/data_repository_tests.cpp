@@ -1,6 +1,8 @@
 #include "tikpp/commands/add.hpp"
 #include "tikpp/data/converters/creator.hpp"
 #include "tikpp/data/converters/dissolver.hpp"
+#include "tikpp/data/predicate.hpp"
+#include "tikpp/data/projection.hpp"
 #include "tikpp/data/repository.hpp"
 #include "tikpp/request.hpp"
 #include "tikpp/tests/fakes/model.hpp"
@@ -32,6 +34,8 @@ std::vector<std::uint8_t> make_sentence(Arg &&... args) {
 
 } // namespace
 
+using namespace tikpp::data::literals;
+
 namespace tikpp::tests {
 
 struct RepositoryTests : tikpp::tests::fixtures::ConnectedBasicApiTest {
@@ -123,6 +127,264 @@ TEST_F(RepositoryTests, StreamTest) {
     io.run();
 }
 
+TEST_F(RepositoryTests, LoadPredicateTest) {
+    constexpr auto test_iterations = 10;
+
+    for (std::size_t i {0}; i < test_iterations; ++i) {
+        auto buf = ::make_sentence(
+            "!re", fmt::format("=id=*{:X}", i),
+            fmt::format("=read-only-data=read_only_data_#{}", i),
+            fmt::format("=read-write-data={}", i % 2 == 0 ? "even" : "odd"),
+            "=.tag=0");
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+    }
+
+    boost::asio::write(
+        api->socket().input_pipe(),
+        boost::asio::buffer(::make_sentence("!done", "=.tag=0")));
+
+    auto pred = "read-only-data"_t &&
+                tikpp::data::make_predicate<tikpp::tests::fakes::model2>(
+                    {"read-write-data"}, [](const auto &item) {
+                        return item.read_write_data.value() == "even";
+                    });
+
+    std::vector<std::uint8_t> expected {};
+    tikpp::commands::getall<tikpp::tests::fakes::model2> {
+        api->current_tag(),
+        {"?read-only-data"},
+        {"read-only-data", "read-write-data"}}
+        .encode(expected);
+
+    repo.async_load(
+        pred, tikpp::data::make_projection("read-only-data"),
+        [&](const auto &err, auto &&items) {
+            EXPECT_FALSE(err);
+            ASSERT_EQ(items.size(), test_iterations / 2);
+
+            for (std::size_t i {0}; i < items.size(); ++i) {
+                EXPECT_EQ(i * 2, items[i].id.value());
+                EXPECT_EQ(fmt::format("read_only_data_#{}", i * 2),
+                          items[i].read_only_data.value());
+                EXPECT_FALSE(items[i].sticky_data.has_value());
+            }
+
+            std::vector<std::uint8_t> result {};
+            result.resize(expected.size());
+            boost::asio::read(api->socket().output_pipe(),
+                              boost::asio::buffer(result));
+            EXPECT_EQ(expected, result);
+
+            api->close();
+        });
+
+    io.run();
+}
+
+TEST_F(RepositoryTests, StreamBatchesTest) {
+    constexpr auto test_iterations = 10;
+    constexpr auto batch_size      = 4;
+
+    for (std::size_t i {0}; i < test_iterations; ++i) {
+        auto buf = ::make_sentence(
+            "!re", fmt::format("=id=*{:X}", i),
+            fmt::format("=read-write-data=read_write_data_#{}", i), "=.tag=0");
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+    }
+
+    boost::asio::write(
+        api->socket().input_pipe(),
+        boost::asio::buffer(::make_sentence("!done", "=.tag=0")));
+
+    std::size_t current {0}, batches {0};
+    const void *storage {nullptr};
+
+    repo.async_stream_batches(batch_size, [&](const auto &err, auto &batch) {
+        EXPECT_TRUE(api->is_open());
+
+        if (err == tikpp::error_code::list_end) {
+            EXPECT_TRUE(batch.empty());
+            EXPECT_EQ(current, test_iterations);
+            EXPECT_EQ(batches, 3);
+            api->close();
+            return;
+        }
+
+        EXPECT_FALSE(err);
+        EXPECT_EQ(batch.size(), std::min<std::size_t>(
+                                    batch_size, test_iterations - current));
+
+        if (storage == nullptr) {
+            storage = batch.data();
+        } else {
+            EXPECT_EQ(storage, batch.data());
+        }
+
+        for (const auto &item : batch) {
+            EXPECT_EQ(current, item.id.value());
+            EXPECT_EQ(fmt::format("read_write_data_#{}", current),
+                      item.read_write_data.value());
+            ++current;
+        }
+
+        ++batches;
+    });
+
+    io.run();
+}
+
+TEST_F(RepositoryTests, StreamBatchesErrorTest) {
+    constexpr auto rows       = 6;
+    constexpr auto batch_size = 4;
+
+    for (std::size_t i {0}; i < rows; ++i) {
+        auto buf = ::make_sentence(
+            "!re", fmt::format("=id=*{:X}", i),
+            fmt::format("=read-write-data=read_write_data_#{}", i), "=.tag=0");
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+    }
+
+    boost::asio::write(api->socket().input_pipe(),
+                       boost::asio::buffer(::make_sentence(
+                           "!trap", "=message=failure", "=.tag=0")));
+
+    std::vector<std::size_t> sizes {};
+    bool                     failed {false};
+
+    repo.async_stream_batches(batch_size, [&](const auto &err, auto &batch) {
+        if (err) {
+            EXPECT_EQ(err, tikpp::make_error_code(
+                               tikpp::error_code::unknown_error));
+            EXPECT_TRUE(batch.empty());
+            failed = true;
+            api->close();
+            return;
+        }
+
+        sizes.push_back(batch.size());
+    });
+
+    io.run();
+
+    // The partial batch is not dropped by the trap
+    EXPECT_TRUE(failed);
+    EXPECT_EQ(sizes, (std::vector<std::size_t> {4, 2}));
+}
+
+TEST_F(RepositoryTests, CountTest) {
+    std::vector<std::uint8_t> expected {};
+    tikpp::commands::count<tikpp::tests::fakes::model2> {
+        api->current_tag(), {"?=read-write-data=a"}}
+        .encode(expected);
+
+    boost::asio::write(api->socket().input_pipe(),
+                       boost::asio::buffer(::make_sentence(
+                           "!done", "=ret=1234",
+                           fmt::format("=.tag={}", api->current_tag()))));
+
+    repo.async_count("read-write-data"_t == "a", [&](const auto &err, auto count) {
+        EXPECT_FALSE(err);
+        EXPECT_EQ(count, 1234);
+
+        std::vector<std::uint8_t> result {};
+        result.resize(expected.size());
+        boost::asio::read(api->socket().output_pipe(),
+                          boost::asio::buffer(result));
+        EXPECT_EQ(expected, result);
+
+        api->close();
+    });
+
+    io.run();
+}
+
+TEST_F(RepositoryTests, AggregateTest) {
+    constexpr auto test_iterations = 10;
+
+    for (std::size_t i {0}; i < test_iterations; ++i) {
+        auto buf = ::make_sentence(
+            "!re", fmt::format("=id=*{:X}", i),
+            fmt::format("=read-write-data={}", i % 3 == 0 ? "a" : "b"),
+            "=.tag=0");
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+    }
+
+    boost::asio::write(
+        api->socket().input_pipe(),
+        boost::asio::buffer(::make_sentence("!done", "=.tag=0")));
+
+    using model_type = tikpp::tests::fakes::model2;
+
+    repo.async_aggregate(
+        tikpp::data::aggregates::make_group_by<model_type>(
+            &model_type::read_write_data),
+        [&](const auto &err, auto &&groups) {
+            EXPECT_FALSE(err);
+            ASSERT_EQ(groups.size(), 2);
+            EXPECT_EQ(groups["a"], 4);
+            EXPECT_EQ(groups["b"], 6);
+
+            api->close();
+        });
+
+    io.run();
+}
+
+TEST_F(RepositoryTests, EarlyTerminationTest) {
+    constexpr auto test_iterations = 10;
+    constexpr auto taken_items     = 3;
+
+    for (std::size_t i {0}; i < test_iterations; ++i) {
+        auto buf = ::make_sentence("!re", fmt::format("=id=*{:X}", i),
+                                   "=.tag=0");
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+    }
+
+    auto tag = api->current_tag();
+
+    std::vector<std::uint8_t> expected {};
+    tikpp::commands::getall<tikpp::tests::fakes::model2> {tag}.encode(
+        expected);
+    tikpp::commands::cancel {tag + 1, tag}.encode(expected);
+
+    bool finished {false};
+
+    repo.async_aggregate(
+        tikpp::data::aggregates::take<tikpp::tests::fakes::model2> {
+            taken_items},
+        [&](const auto &err, auto &&items) {
+            EXPECT_FALSE(err);
+            EXPECT_FALSE(finished);
+            ASSERT_EQ(items.size(), taken_items);
+
+            for (std::size_t i {0}; i < items.size(); ++i) {
+                EXPECT_EQ(i, items[i].id.value());
+            }
+
+            finished = true;
+        });
+
+    while (!finished) {
+        io.run_one();
+    }
+
+    io.poll();
+
+    std::vector<std::uint8_t> result {};
+    result.resize(expected.size());
+    boost::asio::read(api->socket().output_pipe(),
+                      boost::asio::buffer(result));
+    EXPECT_EQ(expected, result);
+
+    api->close();
+    io.run();
+}
+
 TEST_F(RepositoryTests, AddTest) {
     constexpr auto test_iterations = 10;
 
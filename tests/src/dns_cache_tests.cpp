@@ -0,0 +1,111 @@
+#include "tikpp/dns_cache.hpp"
+
+#include "gtest/gtest.h"
+#include <boost/asio/error.hpp>
+#include <boost/asio/ip/address.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace {
+
+const auto router_address = boost::asio::ip::make_address("192.0.2.1");
+
+} // namespace
+
+namespace tikpp::tests {
+
+TEST(DnsCacheTest, CacheTest) {
+    tikpp::dns_cache cache {std::chrono::hours {1}};
+    std::size_t      resolved {0};
+
+    tikpp::resolver resolve = [&resolved](const std::string &,
+                                          tikpp::resolve_handler handler) {
+        ++resolved;
+        handler({}, {::router_address});
+    };
+
+    for (int i {0}; i < 3; ++i) {
+        cache.async_resolve("router", resolve,
+                            [](const auto &err, auto addresses) {
+                                EXPECT_FALSE(err);
+                                ASSERT_EQ(addresses.size(), 1);
+                                EXPECT_EQ(addresses[0], ::router_address);
+                            });
+    }
+
+    EXPECT_EQ(resolved, 1);
+    EXPECT_TRUE(cache.lookup("router").has_value());
+    EXPECT_FALSE(cache.lookup("other").has_value());
+
+    cache.clear();
+    EXPECT_FALSE(cache.lookup("router").has_value());
+}
+
+TEST(DnsCacheTest, ExpiryTest) {
+    tikpp::dns_cache cache {std::chrono::milliseconds {0}};
+    std::size_t      resolved {0};
+
+    tikpp::resolver resolve = [&resolved](const std::string &,
+                                          tikpp::resolve_handler handler) {
+        ++resolved;
+        handler({}, {::router_address});
+    };
+
+    cache.async_resolve("router", resolve, [](const auto &, auto) {});
+    cache.async_resolve("router", resolve, [](const auto &, auto) {});
+
+    EXPECT_EQ(resolved, 2);
+    EXPECT_FALSE(cache.lookup("router").has_value());
+}
+
+TEST(DnsCacheTest, JoinTest) {
+    tikpp::dns_cache                    cache {};
+    std::vector<tikpp::resolve_handler> resolving {};
+    std::size_t                         completed {0};
+
+    tikpp::resolver resolve = [&resolving](const std::string &,
+                                           tikpp::resolve_handler handler) {
+        resolving.push_back(std::move(handler));
+    };
+
+    // Lookups of a name which is being resolved wait for that resolution
+    for (int i {0}; i < 3; ++i) {
+        cache.async_resolve("router", resolve,
+                            [&completed](const auto &err, auto addresses) {
+                                EXPECT_FALSE(err);
+                                EXPECT_EQ(addresses.size(), 1);
+                                ++completed;
+                            });
+    }
+
+    ASSERT_EQ(resolving.size(), 1);
+    EXPECT_EQ(completed, 0);
+
+    resolving.front()({}, {::router_address});
+    EXPECT_EQ(completed, 3);
+}
+
+TEST(DnsCacheTest, FailureTest) {
+    tikpp::dns_cache cache {};
+    std::size_t      resolved {0};
+
+    tikpp::resolver resolve = [&resolved](const std::string &,
+                                          tikpp::resolve_handler handler) {
+        ++resolved;
+        handler(boost::asio::error::make_error_code(
+                    boost::asio::error::host_not_found),
+                {});
+    };
+
+    for (int i {0}; i < 2; ++i) {
+        cache.async_resolve("router", resolve,
+                            [](const auto &err, auto) { EXPECT_TRUE(err); });
+    }
+
+    // Failures are not cached
+    EXPECT_EQ(resolved, 2);
+}
+
+} // namespace tikpp::tests
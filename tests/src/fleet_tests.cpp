@@ -0,0 +1,116 @@
+#include "tikpp/fleet.hpp"
+#include "tikpp/tests/fakes/socket.hpp"
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/write.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename... Arg>
+std::vector<std::uint8_t> make_sentence(Arg &&... args) {
+    std::vector<std::uint8_t> buf {};
+
+    (tikpp::detail::encode_word(
+         tikpp::detail::convert_back(std::forward<Arg>(args)), buf),
+     ...);
+
+    tikpp::detail::encode_length(0, buf);
+    return buf;
+}
+
+} // namespace
+
+namespace tikpp::tests {
+
+using fleet_type = tikpp::basic_fleet<tikpp::tests::fakes::socket>;
+
+TEST(FleetTest, ConsistentShardingTest) {
+    constexpr auto routers = 3000;
+
+    fleet_type small {4}, large {5};
+    std::vector<std::size_t> load(small.shards(), 0);
+    std::size_t              moved {0};
+
+    for (std::size_t i {0}; i < routers; ++i) {
+        auto id    = fmt::format("router-{}", i);
+        auto shard = small.shard_of(id);
+
+        EXPECT_EQ(shard, small.shard_of(id));
+        ++load.at(shard);
+
+        if (large.shard_of(id) != shard) {
+            ++moved;
+        }
+    }
+
+    for (auto count : load) {
+        EXPECT_GT(count, routers / small.shards() / 2);
+        EXPECT_LT(count, routers / small.shards() * 3 / 2);
+    }
+
+    // Adding a fifth shard should only move about a fifth of the routers
+    EXPECT_LT(moved, routers * 2 / 5);
+}
+
+TEST(FleetTest, ConcurrencyLimitedOpenTest) {
+    constexpr auto routers = 8;
+
+    fleet_type fleet {2, 1};
+
+    std::mutex              mutex {};
+    std::condition_variable cv {};
+    std::size_t             opened {0};
+
+    for (std::size_t i {0}; i < routers; ++i) {
+        auto id  = fmt::format("router-{}", i);
+        auto api = fleet.add(id);
+        auto buf = ::make_sentence("!done", ".tag=0");
+
+        EXPECT_EQ(api, fleet.get(id));
+        boost::asio::write(api->socket().input_pipe(),
+                           boost::asio::buffer(buf));
+    }
+
+    EXPECT_EQ(fleet.size(), routers);
+    EXPECT_EQ(fleet.get("unknown"), nullptr);
+
+    for (std::size_t i {0}; i < routers; ++i) {
+        fleet.async_open(fmt::format("router-{}", i), "1.2.3.4", 8728, "admin",
+                         "", [&](const auto &err) {
+                             EXPECT_FALSE(err);
+                             EXPECT_LE(fleet.active_opens(), 1);
+
+                             std::lock_guard<std::mutex> lock {mutex};
+                             ++opened;
+                             cv.notify_one();
+                         });
+    }
+
+    EXPECT_EQ(fleet.active_opens(), 1);
+    EXPECT_EQ(fleet.pending_opens(), routers - 1);
+
+    fleet.start();
+
+    {
+        std::unique_lock<std::mutex> lock {mutex};
+        cv.wait(lock, [&opened] { return opened == routers; });
+    }
+
+    fleet.stop();
+
+    for (std::size_t i {0}; i < routers; ++i) {
+        EXPECT_TRUE(fleet.get(fmt::format("router-{}", i))->is_open());
+    }
+
+    EXPECT_EQ(fleet.pending_opens(), 0);
+}
+
+} // namespace tikpp::tests
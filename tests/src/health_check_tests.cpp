@@ -0,0 +1,87 @@
+#include "tikpp/health_check.hpp"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+
+namespace tikpp::tests {
+
+TEST(RttEstimatorTest, SampleTest) {
+    using std::chrono::milliseconds;
+
+    tikpp::rtt_estimator rtt {};
+    EXPECT_EQ(rtt.samples(), 0);
+    EXPECT_EQ(rtt.srtt().count(), 0);
+
+    // The first sample sets the estimate, with half of it as variation
+    rtt.on_sample(milliseconds {100});
+    EXPECT_EQ(rtt.srtt(), milliseconds {100});
+    EXPECT_EQ(rtt.rttvar(), milliseconds {50});
+    EXPECT_EQ(rtt.timeout(), milliseconds {300});
+
+    rtt.on_sample(milliseconds {180});
+    EXPECT_EQ(rtt.srtt(), milliseconds {110});
+    EXPECT_EQ(rtt.rttvar(), std::chrono::microseconds {57500});
+
+    // A steady round trip time has its variation decay
+    for (int i {0}; i < 100; ++i) {
+        rtt.on_sample(milliseconds {20});
+    }
+
+    EXPECT_EQ(rtt.samples(), 102);
+    EXPECT_NEAR(rtt.srtt().count(), 20'000'000, 1000);
+    EXPECT_LT(rtt.rttvar(), std::chrono::microseconds {10});
+}
+
+TEST(CircuitBreakerTest, ThresholdTest) {
+    tikpp::circuit_breaker breaker {3, std::chrono::seconds {10}};
+    EXPECT_EQ(breaker.state(), tikpp::circuit_state::closed);
+
+    EXPECT_FALSE(breaker.on_failure());
+    EXPECT_FALSE(breaker.on_failure());
+
+    // A success resets the failures in a row
+    breaker.on_success();
+    EXPECT_EQ(breaker.failures(), 0);
+
+    EXPECT_FALSE(breaker.on_failure());
+    EXPECT_FALSE(breaker.on_failure());
+    EXPECT_TRUE(breaker.on_failure());
+    EXPECT_EQ(breaker.state(), tikpp::circuit_state::open);
+
+    // Further failures do not open it again
+    EXPECT_FALSE(breaker.on_failure());
+
+    // Nor does a late success close it
+    breaker.on_success();
+    EXPECT_EQ(breaker.state(), tikpp::circuit_state::open);
+}
+
+TEST(CircuitBreakerTest, HalfOpenTest) {
+    using clock = tikpp::circuit_breaker::clock;
+
+    constexpr std::chrono::seconds open_duration {10};
+
+    tikpp::circuit_breaker breaker {1, open_duration};
+    auto                   now = clock::now();
+
+    EXPECT_TRUE(breaker.on_failure(now));
+    EXPECT_EQ(breaker.reopens_at(), now + open_duration);
+
+    EXPECT_FALSE(breaker.try_half_open(now + open_duration / 2));
+    EXPECT_TRUE(breaker.try_half_open(now + open_duration));
+    EXPECT_EQ(breaker.state(), tikpp::circuit_state::half_open);
+
+    // A failed trial opens it for another while
+    now += open_duration;
+    EXPECT_TRUE(breaker.on_failure(now));
+    EXPECT_EQ(breaker.state(), tikpp::circuit_state::open);
+    EXPECT_EQ(breaker.reopens_at(), now + open_duration);
+
+    // And a successful one closes it
+    EXPECT_TRUE(breaker.try_half_open(now + open_duration));
+    breaker.on_success();
+    EXPECT_EQ(breaker.state(), tikpp::circuit_state::closed);
+}
+
+} // namespace tikpp::tests
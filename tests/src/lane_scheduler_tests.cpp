@@ -0,0 +1,87 @@
+#include "tikpp/detail/lane_scheduler.hpp"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace {
+
+template <typename Scheduler>
+auto drain(Scheduler &scheduler) -> std::vector<int> {
+    std::vector<int> order {};
+
+    while (!scheduler.empty()) {
+        order.push_back(scheduler.front());
+        scheduler.pop();
+    }
+
+    return order;
+}
+
+} // namespace
+
+namespace tikpp::tests {
+
+TEST(LaneSchedulerTest, FifoTest) {
+    tikpp::detail::lane_scheduler<int, 1> scheduler {{1}};
+
+    for (int i {0}; i < 10; ++i) {
+        scheduler.push(0, i);
+    }
+
+    EXPECT_EQ(scheduler.size(), 10);
+    EXPECT_EQ(::drain(scheduler),
+              (std::vector<int> {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(LaneSchedulerTest, StrictLaneTest) {
+    tikpp::detail::lane_scheduler<int, 2> scheduler {{0, 1}};
+
+    scheduler.push(1, 10);
+    scheduler.push(1, 11);
+    scheduler.push(0, 0);
+    scheduler.push(0, 1);
+    scheduler.push(0, 2);
+
+    EXPECT_EQ(::drain(scheduler), (std::vector<int> {0, 1, 2, 10, 11}));
+}
+
+TEST(LaneSchedulerTest, WeightTest) {
+    tikpp::detail::lane_scheduler<int, 3> scheduler {{0, 2, 1}};
+
+    for (int i {0}; i < 5; ++i) {
+        scheduler.push(1, 10 + i);
+        scheduler.push(2, 20 + i);
+    }
+
+    // Less urgent lanes get one item in after each run of the more urgent one
+    EXPECT_EQ(::drain(scheduler),
+              (std::vector<int> {10, 11, 20, 12, 13, 21, 14, 22, 23, 24}));
+
+    // The most urgent lane still goes first at the next turn
+    scheduler.push(2, 20);
+    scheduler.push(2, 21);
+    EXPECT_EQ(scheduler.front(), 20);
+    scheduler.pop();
+
+    scheduler.push(0, 0);
+    EXPECT_EQ(::drain(scheduler), (std::vector<int> {0, 21}));
+}
+
+TEST(LaneSchedulerTest, ExtractTest) {
+    tikpp::detail::lane_scheduler<int, 2> scheduler {{0, 1}};
+
+    scheduler.push(0, 0);
+    scheduler.push(1, 10);
+    scheduler.push(1, 11);
+
+    auto item = scheduler.extract_if([](int i) { return i == 10; });
+    ASSERT_TRUE(item.has_value());
+    EXPECT_EQ(*item, 10);
+
+    EXPECT_FALSE(scheduler.extract_if([](int i) { return i == 10; }));
+    EXPECT_EQ(scheduler.size(), 2);
+    EXPECT_EQ(::drain(scheduler), (std::vector<int> {0, 11}));
+}
+
+} // namespace tikpp::tests
@@ -0,0 +1,43 @@
+#include "tikpp/detail/latency_window.hpp"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+
+namespace tikpp::tests {
+
+using std::chrono::milliseconds;
+
+TEST(LatencyWindowTest, QuantileTest) {
+    tikpp::detail::latency_window window {100};
+    EXPECT_EQ(window.quantile(0.95).count(), 0);
+
+    // Added out of order
+    for (int i {0}; i < 100; ++i) {
+        window.add(milliseconds {(i * 37) % 100 + 1});
+    }
+
+    EXPECT_EQ(window.size(), 100);
+    EXPECT_EQ(window.quantile(0.0), milliseconds {1});
+    EXPECT_EQ(window.quantile(0.5), milliseconds {51});
+    EXPECT_EQ(window.quantile(0.95), milliseconds {95});
+    EXPECT_EQ(window.quantile(1.0), milliseconds {100});
+}
+
+TEST(LatencyWindowTest, EvictionTest) {
+    tikpp::detail::latency_window window {10};
+
+    for (int i {0}; i < 10; ++i) {
+        window.add(milliseconds {1000});
+    }
+
+    // Only the latest samples are kept
+    for (int i {0}; i < 10; ++i) {
+        window.add(milliseconds {10});
+    }
+
+    EXPECT_EQ(window.size(), 10);
+    EXPECT_EQ(window.quantile(1.0), milliseconds {10});
+}
+
+} // namespace tikpp::tests
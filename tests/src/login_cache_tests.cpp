@@ -0,0 +1,49 @@
+#include "tikpp/login_cache.hpp"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+namespace tikpp::tests {
+
+TEST(LoginCacheTest, StoreTest) {
+    tikpp::login_cache cache {};
+
+    EXPECT_FALSE(cache.lookup("10.0.0.1:8728").has_value());
+
+    cache.store("10.0.0.1:8728", tikpp::login_protocol::v1);
+    cache.store("10.0.0.2:8728", tikpp::login_protocol::v2);
+    cache.store("10.0.0.1:8728", tikpp::login_protocol::v2);
+
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.lookup("10.0.0.1:8728"), tikpp::login_protocol::v2);
+
+    cache.erase("10.0.0.1:8728");
+    EXPECT_FALSE(cache.lookup("10.0.0.1:8728").has_value());
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(LoginCacheTest, PersistenceTest) {
+    tikpp::login_cache saved {}, loaded {};
+
+    saved.store("router.example.net:8728", tikpp::login_protocol::v1);
+    saved.store("[2001:db8::1]:8729", tikpp::login_protocol::v2);
+
+    std::stringstream ss {};
+    saved.save(ss);
+
+    EXPECT_EQ(loaded.load(ss), 2);
+    EXPECT_EQ(loaded.lookup("router.example.net:8728"),
+              tikpp::login_protocol::v1);
+    EXPECT_EQ(loaded.lookup("[2001:db8::1]:8729"), tikpp::login_protocol::v2);
+
+    std::stringstream malformed {"\nv1\n10.0.0.2 v3\n10.0.0.3:8728 v1\n"};
+
+    EXPECT_EQ(loaded.load(malformed), 1);
+    EXPECT_EQ(loaded.lookup("10.0.0.3:8728"), tikpp::login_protocol::v1);
+    EXPECT_FALSE(loaded.lookup("10.0.0.2").has_value());
+}
+
+} // namespace tikpp::tests
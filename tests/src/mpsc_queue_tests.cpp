@@ -0,0 +1,81 @@
+#include "tikpp/detail/mpsc_queue.hpp"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tikpp::tests {
+
+TEST(MpscQueueTest, PushPopTest) {
+    tikpp::detail::mpsc_queue<std::unique_ptr<int>> queue {};
+    std::unique_ptr<int>                            item {};
+
+    EXPECT_FALSE(queue.pop(item));
+
+    for (int i {0}; i < 10; ++i) {
+        queue.push(std::make_unique<int>(i));
+    }
+
+    for (int i {0}; i < 10; ++i) {
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(*item, i);
+    }
+
+    EXPECT_FALSE(queue.pop(item));
+
+    // Items which were never popped are destroyed with the queue
+    queue.push(std::make_unique<int>(0));
+}
+
+TEST(MpscQueueTest, ConcurrentProducersTest) {
+    constexpr std::uint32_t producers = 4;
+    constexpr std::uint32_t items     = 100000;
+
+    using item_type = std::pair<std::uint32_t, std::uint32_t>;
+
+    tikpp::detail::mpsc_queue<item_type> queue {};
+    std::vector<std::thread>             threads {};
+    std::atomic_bool                     start {false};
+    std::vector<std::uint32_t>           next(producers, 0);
+
+    for (std::uint32_t i {0}; i < producers; ++i) {
+        threads.emplace_back([&queue, &start, i] {
+            while (!start.load()) {
+            }
+
+            for (std::uint32_t j {0}; j < items; ++j) {
+                queue.push(std::make_pair(i, j));
+            }
+        });
+    }
+
+    start.store(true);
+
+    item_type   item {};
+    std::size_t popped {0};
+
+    while (popped < producers * items) {
+        if (!queue.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Items of the same producer are popped in the order they were pushed
+        ASSERT_EQ(item.second, next[item.first]);
+        ++next[item.first];
+        ++popped;
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_FALSE(queue.pop(item));
+}
+
+} // namespace tikpp::tests
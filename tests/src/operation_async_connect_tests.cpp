@@ -1,17 +1,39 @@
 #include "tikpp/detail/operations/async_connect.hpp"
-#include "tikpp/tests/fakes/socket.hpp"
+#include "tikpp/dns_cache.hpp"
 #include "tikpp/io_context.hpp"
+#include "tikpp/tests/fakes/socket.hpp"
 
 #include "gtest/gtest.h"
 #include <boost/asio/async_result.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include <chrono>
+#include <string>
+#include <vector>
+
 namespace {
 
 constexpr auto invalid_ip_address = "Invalid address";
 constexpr auto valid_ip_address   = "127.0.0.1";
 constexpr auto api_port           = 8728;
 
+auto stub_resolver(std::vector<boost::asio::ip::address> addresses,
+                   std::size_t &                         resolved)
+    -> tikpp::resolver {
+    return [addresses, &resolved](const std::string &host,
+                                  tikpp::resolve_handler handler) {
+        ++resolved;
+
+        if (host != "router") {
+            return handler(boost::asio::error::make_error_code(
+                               boost::asio::error::host_not_found),
+                           {});
+        }
+
+        handler({}, addresses);
+    };
+}
+
 } // namespace
 
 namespace tikpp::tests {
@@ -44,4 +66,84 @@ TEST(AsyncConnectTest, ValidityTest) {
     EXPECT_TRUE(sock.is_open());
 }
 
+TEST(AsyncConnectTest, HostNameTest) {
+    tikpp::io_context            io {};
+    tikpp::tests::fakes::socket sock {io};
+
+    std::size_t resolved {0};
+    auto        cache   = tikpp::make_dns_cache(std::chrono::hours {1});
+    auto        resolve = ::stub_resolver(
+        {boost::asio::ip::make_address("192.0.2.1")}, resolved);
+
+    tikpp::detail::operations::async_connect(
+        sock, "unknown", ::api_port, resolve, cache,
+        [](const auto &err) { EXPECT_TRUE(err); });
+    io.run();
+    EXPECT_FALSE(sock.is_open());
+
+    for (int i {0}; i < 2; ++i) {
+        io.restart();
+        tikpp::detail::operations::async_connect(
+            sock, "router", ::api_port, resolve, cache,
+            [](const auto &err) { EXPECT_FALSE(err); });
+        io.run();
+
+        ASSERT_TRUE(sock.is_open());
+        EXPECT_EQ(sock.remote_endpoint(),
+                  boost::asio::ip::tcp::endpoint(
+                      boost::asio::ip::make_address("192.0.2.1"),
+                      ::api_port));
+        sock.close();
+    }
+
+    // The second connection used the cached address
+    EXPECT_EQ(resolved, 2);
+}
+
+TEST(AsyncConnectTest, InterleaveTest) {
+    using boost::asio::ip::make_address;
+
+    auto endpoints = tikpp::detail::operations::interleave(
+        {make_address("2001:db8::1"), make_address("2001:db8::2"),
+         make_address("192.0.2.1"), make_address("192.0.2.2"),
+         make_address("192.0.2.3")},
+        ::api_port);
+
+    std::vector<std::string> order {};
+
+    for (const auto &ep : endpoints) {
+        order.push_back(ep.address().to_string());
+    }
+
+    EXPECT_EQ(order, (std::vector<std::string> {"2001:db8::1", "192.0.2.1",
+                                                "2001:db8::2", "192.0.2.2",
+                                                "192.0.2.3"}));
+}
+
+TEST(AsyncConnectTest, RaceTest) {
+    using boost::asio::ip::make_address;
+    using boost::asio::ip::tcp;
+
+    tikpp::io_context io {};
+    tcp::acceptor     acceptor {io, {make_address("127.0.0.1"), 0}};
+    tcp::socket       sock {io};
+
+    std::size_t resolved {0};
+    auto        port = acceptor.local_endpoint().port();
+
+    // Nothing listens on the first address, so the attempt to the second one
+    // starts as soon as the first one is refused
+    tikpp::detail::operations::async_connect(
+        sock, "router", port,
+        ::stub_resolver({make_address("127.0.0.2"), make_address("127.0.0.1")},
+                        resolved),
+        tikpp::make_dns_cache(),
+        [](const auto &err) { EXPECT_FALSE(err); });
+    io.run();
+
+    ASSERT_TRUE(sock.is_open());
+    EXPECT_EQ(sock.remote_endpoint(), tcp::endpoint(make_address("127.0.0.1"),
+                                                    port));
+}
+
 } // namespace tikpp::tests
@@ -0,0 +1,44 @@
+#include "tikpp/reconnect_policy.hpp"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+
+namespace tikpp::tests {
+
+TEST(ReconnectPolicyTest, DelayBoundTest) {
+    tikpp::reconnect_policy policy {};
+    policy.initial_delay = std::chrono::milliseconds {100};
+    policy.max_delay     = std::chrono::milliseconds {1000};
+    policy.multiplier    = 2.0;
+
+    std::minstd_rand rng {42};
+
+    for (std::size_t attempt {0}; attempt < 10; ++attempt) {
+        auto bound = std::min(std::chrono::milliseconds {100 << attempt},
+                              policy.max_delay);
+        std::chrono::milliseconds longest {0};
+
+        for (std::size_t i {0}; i < 1000; ++i) {
+            auto delay = policy.delay(attempt, rng);
+
+            EXPECT_GE(delay.count(), 0);
+            EXPECT_LE(delay, bound);
+            longest = std::max(longest, delay);
+        }
+
+        // The delays are spread over the whole range
+        EXPECT_GT(longest, bound * 9 / 10);
+    }
+}
+
+TEST(ReconnectPolicyTest, LargeAttemptTest) {
+    tikpp::reconnect_policy policy {};
+    std::minstd_rand        rng {42};
+
+    EXPECT_LE(policy.delay(10000, rng), policy.max_delay);
+}
+
+} // namespace tikpp::tests
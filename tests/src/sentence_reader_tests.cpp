@@ -0,0 +1,117 @@
+#include "tikpp/detail/sentence_reader.hpp"
+#include "tikpp/request.hpp"
+
+#include "gtest/gtest.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+/*!
+ * \brief Copies data into the prepared buffer of a reader, as a read would
+ */
+void feed(tikpp::detail::sentence_reader &reader,
+          const std::uint8_t *            data,
+          std::size_t                     size) {
+    auto buf = reader.prepare();
+    ASSERT_GE(buf.size(), size);
+
+    std::copy(data, data + size, static_cast<std::uint8_t *>(buf.data()));
+    reader.commit(size);
+}
+
+auto make_sentence(const std::vector<std::string> &words)
+    -> std::vector<std::uint8_t> {
+    std::vector<std::uint8_t> buf {};
+
+    for (const auto &word : words) {
+        tikpp::detail::encode_word(word, buf);
+    }
+
+    tikpp::detail::encode_length(0, buf);
+    return buf;
+}
+
+} // namespace
+
+namespace tikpp::tests {
+
+TEST(SentenceReaderTest, ChunksTest) {
+    // Words of each length prefix size, up to 3 bytes
+    const std::vector<std::string> words {
+        "!re", std::string(200, 'a'), std::string(20000, 'b'), ".tag=1"};
+    const auto sentence = ::make_sentence(words);
+
+    for (std::size_t chunk : {std::size_t {1}, std::size_t {7},
+                              std::size_t {4096}, sentence.size()}) {
+        tikpp::detail::sentence_reader reader {chunk};
+        boost::system::error_code      err {};
+        std::vector<std::string>       read {};
+        std::size_t                    size {0};
+
+        for (std::size_t i {0}; i < sentence.size(); i += chunk) {
+            EXPECT_EQ(size, 0);
+
+            ::feed(reader, sentence.data() + i,
+                   std::min(chunk, sentence.size() - i));
+            size = reader.next(read, err);
+            ASSERT_FALSE(err);
+        }
+
+        EXPECT_EQ(size, sentence.size());
+        EXPECT_EQ(read, words);
+        EXPECT_EQ(reader.buffered(), 0);
+    }
+}
+
+TEST(SentenceReaderTest, ManySentencesTest) {
+    tikpp::detail::sentence_reader reader {4096};
+    std::vector<std::uint8_t>      buf {};
+
+    for (std::size_t i {0}; i < 10; ++i) {
+        auto sentence =
+            ::make_sentence({"!re", "=.id=*" + std::to_string(i), ".tag=1"});
+        buf.insert(buf.end(), sentence.begin(), sentence.end());
+    }
+
+    // The last sentence is read partly
+    ::feed(reader, buf.data(), buf.size() - 3);
+
+    boost::system::error_code err {};
+    std::vector<std::string>  words {};
+
+    for (std::size_t i {0}; i < 9; ++i) {
+        EXPECT_GT(reader.next(words, err), 0);
+        EXPECT_EQ(words[1], "=.id=*" + std::to_string(i));
+    }
+
+    EXPECT_EQ(reader.next(words, err), 0);
+    EXPECT_GT(reader.buffered(), 0);
+
+    ::feed(reader, buf.data() + buf.size() - 3, 3);
+    EXPECT_GT(reader.next(words, err), 0);
+    EXPECT_EQ(words[1], "=.id=*9");
+    EXPECT_FALSE(err);
+}
+
+TEST(SentenceReaderTest, InvalidLengthTest) {
+    tikpp::detail::sentence_reader reader {16};
+    const std::uint8_t             data[] {0xF8, 0x00};
+
+    ::feed(reader, data, sizeof(data));
+
+    boost::system::error_code err {};
+    std::vector<std::string>  words {};
+
+    EXPECT_EQ(reader.next(words, err), 0);
+    EXPECT_EQ(err, boost::asio::error::message_size);
+}
+
+} // namespace tikpp::tests
@@ -0,0 +1,205 @@
+#include "tikpp/detail/operations/async_read_response.hpp"
+#include "tikpp/detail/ssl_wrapper.hpp"
+#include "tikpp/io_context.hpp"
+#include "tikpp/request.hpp"
+#include "tikpp/tests/util/tls.hpp"
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/write.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using wrapper = tikpp::detail::ssl_wrapper<boost::asio::ip::tcp::socket>;
+using server_stream = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
+/*!
+ * \brief Accepts one TLS connection, writes the passed data to it after the
+ *        handshake, and reads the passed number of bytes from it
+ */
+struct tls_server {
+    tls_server(tikpp::io_context &       io,
+               std::vector<std::uint8_t> data,
+               std::size_t               expected = 0)
+        : ctx_ {tikpp::tests::util::make_tls_server_context()},
+          acceptor_ {io, {boost::asio::ip::make_address("127.0.0.1"), 0}},
+          data_ {std::move(data)},
+          received_(expected) {
+        acceptor_.async_accept([this](const auto &                   err,
+                                      boost::asio::ip::tcp::socket sock) {
+            ASSERT_FALSE(err);
+
+            stream_ = std::make_unique<server_stream>(std::move(sock), *ctx_);
+            stream_->async_handshake(
+                boost::asio::ssl::stream_base::server, [this](const auto &err) {
+                    ASSERT_FALSE(err);
+                    boost::asio::async_write(*stream_,
+                                             boost::asio::buffer(data_),
+                                             [](const auto &, auto) {});
+
+                    if (!received_.empty()) {
+                        boost::asio::async_read(
+                            *stream_, boost::asio::buffer(received_),
+                            [](const auto &err, auto) { EXPECT_FALSE(err); });
+                    }
+                });
+        });
+    }
+
+    [[nodiscard]] inline auto endpoint() const
+        -> boost::asio::ip::tcp::endpoint {
+        return acceptor_.local_endpoint();
+    }
+
+    [[nodiscard]] inline auto received() const noexcept
+        -> const std::vector<std::uint8_t> & {
+        return received_;
+    }
+
+  private:
+    std::shared_ptr<boost::asio::ssl::context> ctx_;
+    boost::asio::ip::tcp::acceptor             acceptor_;
+    std::unique_ptr<server_stream>             stream_;
+    std::vector<std::uint8_t>                  data_, received_;
+};
+
+/*!
+ * \brief Encodes `!re' responses of growing sizes, which span several TLS
+ *        records
+ */
+auto make_responses(std::size_t count) -> std::vector<std::uint8_t> {
+    std::vector<std::uint8_t> data {};
+
+    for (std::size_t i {0}; i < count; ++i) {
+        tikpp::detail::encode_word("!re", data);
+        tikpp::detail::encode_word("=name=" + std::string(i % 200, 'x'), data);
+        tikpp::detail::encode_word(fmt::format(".tag={}", i), data);
+        tikpp::detail::encode_length(0, data);
+    }
+
+    return data;
+}
+
+/*!
+ * \brief Reads the responses made by \see make_responses from a connected
+ *        stream
+ *
+ * \return The number of read responses
+ */
+auto read_responses(tikpp::io_context &io, wrapper &sock, std::size_t count)
+    -> std::size_t {
+    std::size_t read {0};
+
+    std::function<void(const boost::system::error_code &, tikpp::response &&)>
+        on_response = [&](const auto &err, auto &&resp) {
+            ASSERT_FALSE(err);
+            EXPECT_EQ(resp.tag(), read);
+            EXPECT_EQ(resp["name"].size(), read % 200);
+
+            if (++read < count) {
+                tikpp::detail::operations::async_read_response(sock,
+                                                               on_response);
+            }
+        };
+
+    tikpp::detail::operations::async_read_response(sock, on_response);
+
+    while (read < count && io.run_one() > 0) {
+    }
+
+    return read;
+}
+
+} // namespace
+
+namespace tikpp::tests {
+
+TEST(SslWrapperTest, ReadBufferTest) {
+    constexpr std::size_t count = 500;
+
+    tikpp::io_context io {};
+    tls_server        server {io, ::make_responses(count)};
+    wrapper           sock {io};
+
+    bool connected {false};
+    sock.async_connect(server.endpoint(), [&](const auto &err, auto &&...) {
+        ASSERT_FALSE(err);
+        connected = true;
+    });
+
+    while (!connected && io.run_one() > 0) {
+    }
+
+    EXPECT_EQ(::read_responses(io, sock, count), count);
+
+    // A zero-length read completes at once, even with no buffered data
+    bool completed {false};
+    io.restart();
+
+    sock.async_read_some(boost::asio::mutable_buffer {},
+                         [&completed](const auto &err, auto len) {
+                             EXPECT_FALSE(err);
+                             EXPECT_EQ(len, 0);
+                             completed = true;
+                         });
+
+    while (!completed && io.run_one() > 0) {
+    }
+
+    EXPECT_TRUE(completed);
+
+    sock.close();
+}
+
+TEST(SslWrapperTest, KernelTlsTest) {
+    constexpr std::size_t count = 500;
+
+    std::vector<std::uint8_t> request {};
+    tikpp::detail::encode_word("/system/identity/print", request);
+    tikpp::detail::encode_word(".tag=1", request);
+    tikpp::detail::encode_length(0, request);
+
+    tikpp::io_context io {};
+    tls_server        server {io, ::make_responses(count), request.size()};
+    wrapper           sock {io};
+
+    sock.kernel_tls(true);
+
+#ifdef TIKPP_HAS_KERNEL_TLS
+    EXPECT_TRUE(sock.kernel_tls());
+#else
+    EXPECT_FALSE(sock.kernel_tls());
+#endif
+
+    bool written {false};
+    sock.async_connect(server.endpoint(), [&](const auto &err, auto &&...) {
+        ASSERT_FALSE(err);
+        boost::asio::async_write(sock, boost::asio::buffer(request),
+                                 [&written](const auto &err, auto) {
+                                     EXPECT_FALSE(err);
+                                     written = true;
+                                 });
+    });
+
+    while (!written && io.run_one() > 0) {
+    }
+
+    // Whether the kernel took the encryption over depends on it having the
+    // `tls' module, the connection works the same either way
+    EXPECT_EQ(::read_responses(io, sock, count), count);
+    EXPECT_EQ(server.received(), request);
+
+    sock.close();
+}
+
+} // namespace tikpp::tests
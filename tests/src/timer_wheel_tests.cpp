@@ -0,0 +1,108 @@
+#include "tikpp/detail/timer_wheel.hpp"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace tikpp::tests {
+
+using wheel_type = tikpp::detail::timer_wheel<std::uint64_t>;
+
+TEST(TimerWheelTest, ExpirationTest) {
+    wheel_type                 wheel {};
+    std::vector<std::uint64_t> expired {};
+
+    // One deadline for each level, and one beyond the top level
+    const std::vector<std::uint64_t> deadlines {
+        1, 63, 64, 100, 4095, 4096, 300000, 17000000};
+
+    for (auto deadline : deadlines) {
+        wheel.schedule(deadline, deadline);
+    }
+
+    EXPECT_EQ(wheel.size(), deadlines.size());
+
+    for (std::uint64_t now {1}; now < deadlines.back() + 37; now += 37) {
+        wheel.advance(now, [&expired, now](auto deadline) {
+            EXPECT_LE(deadline, now);
+            EXPECT_GT(deadline + 37, now);
+            expired.push_back(deadline);
+        });
+    }
+
+    EXPECT_EQ(expired, deadlines);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, PassedDeadlineTest) {
+    wheel_type                 wheel {100};
+    std::vector<std::uint64_t> expired {};
+
+    wheel.schedule(50, 50);
+    wheel.advance(100, [&expired](auto value) { expired.push_back(value); });
+    EXPECT_TRUE(expired.empty());
+
+    wheel.advance(101, [&expired](auto value) { expired.push_back(value); });
+    EXPECT_EQ(expired, std::vector<std::uint64_t> {50});
+}
+
+TEST(TimerWheelTest, CancelTest) {
+    wheel_type                 wheel {};
+    std::vector<std::uint64_t> expired {};
+
+    auto first = wheel.schedule(10, 10);
+    wheel.schedule(10, 11);
+    auto far = wheel.schedule(5000, 5000);
+
+    wheel.cancel(first);
+    wheel.cancel(far);
+    EXPECT_EQ(wheel.size(), 1);
+
+    wheel.advance(10000, [&expired](auto value) { expired.push_back(value); });
+    EXPECT_EQ(expired, std::vector<std::uint64_t> {11});
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, CascadedCancelTest) {
+    wheel_type                 wheel {};
+    std::vector<std::uint64_t> expired {};
+
+    // Moved down to level 0 once the wheel reaches tick 4096
+    auto handle = wheel.schedule(4100, 4100);
+
+    wheel.advance(4097, [&expired](auto value) { expired.push_back(value); });
+    wheel.cancel(handle);
+    wheel.advance(5000, [&expired](auto value) { expired.push_back(value); });
+
+    EXPECT_TRUE(expired.empty());
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, ScheduleAfterIdleTest) {
+    // A day of 10 ms ticks
+    constexpr std::uint64_t idle = 8'640'000;
+
+    wheel_type                 wheel {};
+    std::vector<std::uint64_t> expired {};
+
+    // Cancelled, so the owner stops advancing the wheel
+    wheel.cancel(wheel.schedule(5, 5));
+    EXPECT_EQ(wheel.next_tick(), 1);
+
+    wheel.reset(idle);
+    EXPECT_EQ(wheel.next_tick(), idle + 1);
+
+    wheel.schedule(idle + 3, idle + 3);
+
+    const auto collect = [&expired](auto value) { expired.push_back(value); };
+
+    wheel.advance(idle + 2, collect);
+    EXPECT_TRUE(expired.empty());
+    EXPECT_EQ(wheel.next_tick(), idle + 3);
+
+    wheel.advance(idle + 3, collect);
+    EXPECT_EQ(expired, std::vector<std::uint64_t> {idle + 3});
+}
+
+} // namespace tikpp::tests
@@ -0,0 +1,68 @@
+#include "tikpp/detail/ssl_wrapper.hpp"
+#include "tikpp/io_context.hpp"
+#include "tikpp/ssl_context.hpp"
+#include "tikpp/tls_session_cache.hpp"
+
+#include "gtest/gtest.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <openssl/ssl.h>
+
+namespace tikpp::tests {
+
+TEST(TlsSessionCacheTest, StoreTest) {
+    tikpp::tls_session_cache cache {};
+
+    EXPECT_EQ(cache.lookup("10.0.0.1:8729"), nullptr);
+
+    auto *session = ::SSL_SESSION_new();
+    cache.store("10.0.0.1:8729", session);
+
+    EXPECT_EQ(cache.lookup("10.0.0.1:8729").get(), session);
+    EXPECT_EQ(cache.size(), 1);
+
+    // Replacing a session frees the previous one
+    cache.store("10.0.0.1:8729", ::SSL_SESSION_new());
+    EXPECT_NE(cache.lookup("10.0.0.1:8729").get(), session);
+    EXPECT_EQ(cache.size(), 1);
+
+    cache.erase("10.0.0.1:8729");
+    EXPECT_EQ(cache.lookup("10.0.0.1:8729"), nullptr);
+}
+
+TEST(TlsSessionCacheTest, EvictionTest) {
+    tikpp::tls_session_cache cache {2};
+
+    cache.store("10.0.0.1:8729", ::SSL_SESSION_new());
+    cache.store("10.0.0.2:8729", ::SSL_SESSION_new());
+    cache.store("10.0.0.3:8729", ::SSL_SESSION_new());
+
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_NE(cache.lookup("10.0.0.3:8729"), nullptr);
+
+    tikpp::tls_session_cache disabled {0};
+    disabled.store("10.0.0.1:8729", ::SSL_SESSION_new());
+    EXPECT_EQ(disabled.size(), 0);
+}
+
+TEST(TlsSessionCacheTest, SharedContextTest) {
+    using wrapper =
+        tikpp::detail::ssl_wrapper<boost::asio::ip::tcp::socket, false>;
+
+    tikpp::io_context io {};
+    wrapper           first {io}, second {io};
+
+    // Connections share the default context and session cache
+    EXPECT_EQ(first.context(), second.context());
+    EXPECT_EQ(first.context(), tikpp::default_ssl_context(false));
+    EXPECT_EQ(first.session_cache(), tikpp::default_tls_session_cache());
+
+    auto ctx = tikpp::make_ssl_context();
+    first.context(ctx);
+    first.session_cache(nullptr);
+
+    EXPECT_EQ(first.context(), ctx);
+    EXPECT_EQ(first.session_cache(), nullptr);
+    EXPECT_FALSE(first.is_open());
+}
+
+} // namespace tikpp::tests